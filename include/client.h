@@ -11,6 +11,7 @@ typedef struct SwlClientManager SwlClientManager;
 typedef struct SwlCompositor SwlCompositor;
 typedef struct SwlMonitor SwlMonitor;
 struct wlr_surface;
+struct SwlRenderProfile;
 
 typedef struct SwlClientInfo {
     uint32_t id;
@@ -54,15 +55,25 @@ SwlError swl_client_close(SwlClient *client);
 SwlError swl_client_focus(SwlClient *client);
 SwlError swl_client_set_floating(SwlClient *client, bool floating);
 SwlError swl_client_toggle_floating(SwlClient *client);
+SwlError swl_client_set_render_profile(SwlClient *client, const struct SwlRenderProfile *profile);
 SwlError swl_client_set_fullscreen(SwlClient *client, bool fullscreen);
 SwlError swl_client_toggle_fullscreen(SwlClient *client);
 SwlError swl_client_move_to_monitor(SwlClient *client, SwlMonitor *mon);
 SwlError swl_client_resize(SwlClient *client, int x, int y, int w, int h);
+// Position-only update for interactive moves, applied on the next frame
+SwlError swl_client_move(SwlClient *client, int x, int y);
+// Resize for interactive grabs, applied on the next frame the client has
+// caught up with the previous size
+SwlError swl_client_resize_interactive(SwlClient *client, int x, int y, int w, int h);
+void swl_client_manager_flush_interactive(SwlClientManager *mgr);
 SwlError swl_client_set_border_color(SwlClient *client, const float color[4]);
 SwlError swl_client_set_border_width(SwlClient *client, int width);
 SwlError swl_client_set_urgent(SwlClient *client, bool urgent);
 SwlError swl_client_zoom(SwlClientManager *mgr);
 
+// Suspend clients hidden behind an opaque fullscreen client on mon
+void swl_client_update_occlusion(SwlClientManager *mgr, SwlMonitor *mon);
+
 float swl_client_get_scroller_ratio(const SwlClient *client);
 SwlError swl_client_set_scroller_ratio(SwlClient *client, float ratio);
 
@@ -43,5 +43,10 @@ struct wlr_compositor *swl_compositor_get_wlr_compositor(SwlCompositor *comp);
 struct SwlLayerManager *swl_compositor_get_layer_manager(SwlCompositor *comp);
 struct SwlToplevelManager *swl_compositor_get_toplevel_manager(SwlCompositor *comp);
 struct SwlSessionLock *swl_compositor_get_session_lock(SwlCompositor *comp);
+struct SwlProcessTable *swl_compositor_get_processes(SwlCompositor *comp);
+
+// Phase timings of swl_compositor_create/run and the first output commit
+const struct SwlStartupProfile *swl_compositor_get_startup_profile(SwlCompositor *comp);
+void swl_compositor_note_first_frame(SwlCompositor *comp);
 
 #endif /* SWL_COMPOSITOR_H */
@@ -29,6 +29,9 @@ typedef enum {
     SWL_EVENT_SESSION_UNLOCK,
     SWL_EVENT_LID_CLOSE,
     SWL_EVENT_LID_OPEN,
+    SWL_EVENT_MODE_CHANGE,
+    SWL_EVENT_PROCESS_EXIT,
+    SWL_EVENT_TYPE_COUNT,
 } SwlEventType;
 
 typedef struct SwlEvent {
@@ -14,6 +14,7 @@ typedef struct SwlKeyboardConfig {
     const char *xkb_layout;
     const char *xkb_variant;
     const char *xkb_options;
+    bool xkb_persist_cache;  // Keep compiled keymaps in $XDG_CACHE_HOME/swl
     int repeat_rate;
     int repeat_delay;
     bool numlock;
@@ -53,6 +54,8 @@ SwlError swl_input_configure_pointer(SwlInput *input, const SwlPointerConfig *cf
 SwlError swl_input_set_cursor_image(SwlInput *input, const char *name);
 SwlError swl_input_warp_cursor(SwlInput *input, double x, double y);
 void swl_input_get_cursor_position(SwlInput *input, double *x, double *y);
+// Drop cached pointer hit-testing after the scene graph changed
+void swl_input_scene_changed(SwlInput *input);
 
 uint32_t swl_input_get_modifiers(SwlInput *input);
 
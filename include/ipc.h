@@ -12,6 +12,8 @@ typedef struct SwlCompositor SwlCompositor;
 typedef struct SwlIPCResponse {
     bool success;
     char *json;
+    const char *shared_json;  // Borrowed from the IPC's reply writer, used instead of json
+    size_t shared_len;        // Length of shared_json, which is CBOR for binary clients
     char *error;
     bool keep_open;
     uint32_t event_mask;
@@ -0,0 +1,70 @@
+#ifndef SWL_JSON_H
+#define SWL_JSON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Streaming JSON writer over a growable buffer. Commas between members are
+// inserted automatically; strings are escaped. Reset and reuse a writer to
+// keep its buffer instead of allocating per document.
+//
+// The same calls can produce CBOR (RFC 8949), the binary encoding of the
+// JSON data model, so one serializer serves text and binary IPC clients.
+// Containers are written with indefinite lengths; doubles shrink to single
+// precision when that is exact.
+
+#define SWL_JSON_MAX_DEPTH 32
+
+typedef enum {
+    SWL_JSON_TEXT,
+    SWL_JSON_CBOR,
+} SwlJsonEncoding;
+
+typedef struct SwlJsonWriter {
+    char *buf;
+    size_t len;
+    size_t cap;
+    int depth;
+    uint32_t has_items;  // Bit per depth: container already has a member
+    bool after_key;
+    bool failed;         // Allocation failed or nesting too deep
+    SwlJsonEncoding encoding;
+} SwlJsonWriter;
+
+void swl_json_init(SwlJsonWriter *w);
+void swl_json_finish(SwlJsonWriter *w);
+// Drop the contents, keep the buffer and encoding
+void swl_json_reset(SwlJsonWriter *w);
+// Switch encodings; also resets
+void swl_json_set_encoding(SwlJsonWriter *w, SwlJsonEncoding encoding);
+
+// NUL-terminated document, never NULL. Valid until the next write or reset.
+// CBOR may contain NUL bytes, so use swl_json_len() for its size.
+const char *swl_json_cstr(const SwlJsonWriter *w);
+size_t swl_json_len(const SwlJsonWriter *w);
+
+void swl_json_begin_object(SwlJsonWriter *w);
+void swl_json_end_object(SwlJsonWriter *w);
+void swl_json_begin_array(SwlJsonWriter *w);
+void swl_json_end_array(SwlJsonWriter *w);
+void swl_json_key(SwlJsonWriter *w, const char *key);
+
+void swl_json_string(SwlJsonWriter *w, const char *s);  // NULL writes ""
+void swl_json_int(SwlJsonWriter *w, int64_t v);
+void swl_json_uint(SwlJsonWriter *w, uint64_t v);
+void swl_json_double(SwlJsonWriter *w, double v, int decimals);  // Non-finite writes null
+void swl_json_bool(SwlJsonWriter *w, bool v);
+void swl_json_null(SwlJsonWriter *w);
+
+// Object members: key followed by value
+void swl_json_field_string(SwlJsonWriter *w, const char *key, const char *s);
+void swl_json_field_int(SwlJsonWriter *w, const char *key, int64_t v);
+void swl_json_field_uint(SwlJsonWriter *w, const char *key, uint64_t v);
+void swl_json_field_double(SwlJsonWriter *w, const char *key, double v, int decimals);
+void swl_json_field_bool(SwlJsonWriter *w, const char *key, bool v);
+
+// Append bytes as-is, outside the comma bookkeeping (e.g. a trailing newline)
+void swl_json_raw(SwlJsonWriter *w, const char *s, size_t len);
+
+#endif /* SWL_JSON_H */
@@ -10,12 +10,16 @@
 typedef struct SwlCompositor SwlCompositor;
 typedef struct SwlKeybindingManager SwlKeybindingManager;
 typedef struct SwlInput SwlInput;
+struct SwlLayout;
+
+#define SWL_ACTION_MAX_FLOATS 32
 
 typedef struct SwlKeybinding {
     uint32_t modifiers;
     xkb_keysym_t keysym;
     const char *action;
     const char *argument;
+    const char *mode;  // Binding mode, NULL for the default mode
 } SwlKeybinding;
 
 typedef struct SwlButtonBinding {
@@ -25,7 +29,20 @@ typedef struct SwlButtonBinding {
     const char *argument;
 } SwlButtonBinding;
 
-typedef void (*SwlAction)(SwlCompositor *comp, const char *arg);
+// Binding argument, parsed once when bindings are loaded
+typedef struct SwlActionArg {
+    const char *str;  // As written, NULL if none
+    int i;            // Integer, direction (0 up, 1 down, 2 left, 3 right), VT, ...
+    const struct SwlLayout *layout;
+    int float_count;
+    float floats[SWL_ACTION_MAX_FLOATS];
+} SwlActionArg;
+
+typedef void (*SwlAction)(SwlCompositor *comp, const SwlActionArg *arg);
+
+// Fills `out` from the argument string (may be NULL). An error rejects the
+// binding at load time. `out` is zeroed with `str` set before the call.
+typedef SwlError (*SwlActionParser)(SwlCompositor *comp, const char *str, SwlActionArg *out);
 
 SwlKeybindingManager *swl_keybinding_create(SwlInput *input);
 void swl_keybinding_destroy(SwlKeybindingManager *mgr);
@@ -39,7 +56,8 @@ SwlError swl_button_binding_add(SwlKeybindingManager *mgr, const SwlButtonBindin
 SwlError swl_button_binding_remove(SwlKeybindingManager *mgr, uint32_t mod, uint32_t button);
 void swl_button_binding_clear(SwlKeybindingManager *mgr);
 
-SwlError swl_action_register(SwlKeybindingManager *mgr, const char *name, SwlAction action);
+SwlError swl_action_register(SwlKeybindingManager *mgr, const char *name, SwlAction action,
+                             SwlActionParser parser);
 SwlError swl_action_unregister(SwlKeybindingManager *mgr, const char *name);
 void swl_action_register_builtins(SwlKeybindingManager *mgr);
 
@@ -47,6 +65,28 @@ bool swl_keybinding_handle(SwlKeybindingManager *mgr, uint32_t mod, xkb_keysym_t
 bool swl_button_binding_handle(SwlKeybindingManager *mgr, uint32_t mod, uint32_t button);
 void swl_keybinding_reload(SwlKeybindingManager *mgr);
 
+// Rebuild the dispatch tables now rather than at the next key press
+void swl_keybinding_compile(SwlKeybindingManager *mgr);
+SwlCompositor *swl_keybinding_get_compositor(const SwlKeybindingManager *mgr);
+
+// Switch binding mode ("default" leaves any mode); emits SWL_EVENT_MODE_CHANGE
+SwlError swl_keybinding_set_mode(SwlKeybindingManager *mgr, const char *mode);
+const char *swl_keybinding_get_mode(const SwlKeybindingManager *mgr);
+
 SwlError swl_action_dispatch(SwlKeybindingManager *mgr, const char *action, const char *arg);
 
+// Argument parsers of the built-in actions (src/input/actions.c)
+enum { SWL_MOVERESIZE_MOVE, SWL_MOVERESIZE_RESIZE };
+
+SwlError swl_action_parse_required(SwlCompositor *comp, const char *str, SwlActionArg *out);
+SwlError swl_action_parse_direction(SwlCompositor *comp, const char *str, SwlActionArg *out);
+SwlError swl_action_parse_monitor_direction(SwlCompositor *comp, const char *str,
+                                            SwlActionArg *out);
+SwlError swl_action_parse_layout(SwlCompositor *comp, const char *str, SwlActionArg *out);
+SwlError swl_action_parse_moveresize(SwlCompositor *comp, const char *str, SwlActionArg *out);
+SwlError swl_action_parse_ratios(SwlCompositor *comp, const char *str, SwlActionArg *out);
+SwlError swl_action_parse_int_default_one(SwlCompositor *comp, const char *str,
+                                          SwlActionArg *out);
+SwlError swl_action_parse_vt(SwlCompositor *comp, const char *str, SwlActionArg *out);
+
 #endif /* SWL_KEYBINDINGS_H */
@@ -0,0 +1,32 @@
+#ifndef SWL_LATENCY_H
+#define SWL_LATENCY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Input-to-present latency samples, kept per output
+
+#define SWL_LATENCY_WINDOW 512  // Most recent samples percentiles are taken over
+
+typedef struct SwlLatencyStats {
+    int64_t samples[SWL_LATENCY_WINDOW];
+    size_t count;  // Valid samples, at most SWL_LATENCY_WINDOW
+    size_t next;   // Slot the next sample overwrites
+    uint64_t total;  // Samples ever recorded
+} SwlLatencyStats;
+
+typedef struct SwlLatencySummary {
+    size_t samples;
+    uint64_t total;
+    int64_t p50_ns, p95_ns, p99_ns;
+} SwlLatencySummary;
+
+void swl_latency_reset(SwlLatencyStats *stats);
+void swl_latency_add(SwlLatencyStats *stats, int64_t ns);
+SwlLatencySummary swl_latency_summary(const SwlLatencyStats *stats);
+
+// Event timestamps are 32-bit milliseconds on CLOCK_MONOTONIC, rebuild the
+// full time relative to now. Returns now if the timestamp is implausible.
+int64_t swl_latency_event_ns(uint32_t time_msec, int64_t now_ns);
+
+#endif /* SWL_LATENCY_H */
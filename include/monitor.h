@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "error.h"
+#include "latency.h"
 
 typedef struct SwlMonitor SwlMonitor;
 typedef struct SwlOutputManager SwlOutputManager;
@@ -21,6 +22,8 @@ typedef struct SwlMonitorInfo {
     float scale;
     int transform;
     bool enabled;
+    int max_render_time;  // ms, 0 = off, -1 = auto
+    int render_time_us;   // Smoothed render duration of recent frames
 } SwlMonitorInfo;
 
 typedef struct SwlMonitorConfig {
@@ -62,5 +65,13 @@ void swl_monitor_arrange(SwlMonitor *mon);
 void swl_monitor_arrange_all(SwlOutputManager *mgr);
 void swl_monitor_reload_config(SwlOutputManager *mgr);
 void swl_monitor_damage_whole(SwlMonitor *mon);
+// Background or bottom layer content changed, recompute the cached blur
+void swl_monitor_invalidate_blur(SwlMonitor *mon);
+
+// Input-to-present latency: note input events as they arrive and damage
+// from the focused client, the next presented frame closes the sample
+void swl_output_note_input(SwlOutputManager *mgr, uint32_t time_msec);
+void swl_monitor_note_client_damage(SwlMonitor *mon);
+SwlLatencySummary swl_monitor_get_latency(const SwlMonitor *mon);
 
 #endif /* SWL_MONITOR_H */
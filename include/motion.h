@@ -0,0 +1,45 @@
+#ifndef SWL_MOTION_H
+#define SWL_MOTION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Pointer motion bookkeeping kept free of wlroots so the hot path can be
+// replayed outside the compositor (see tests/bench/bench_motion.c)
+
+typedef struct SwlMotionBox {
+    int x, y;
+    int width, height;
+} SwlMotionBox;
+
+typedef struct SwlMotionState {
+    bool pending;             // Motion received but not yet processed
+    uint32_t time_msec;       // Timestamp of the newest pending motion
+    uint32_t coalesced;       // Events merged into the pending one
+
+    bool hit_valid;
+    SwlMotionBox hit_box;     // Layout area where the cached hit can't change
+
+    int64_t idle_interval_ns; // Minimum gap between idle notifications
+    int64_t last_idle_ns;
+} SwlMotionState;
+
+void swl_motion_init(SwlMotionState *m, int64_t idle_interval_ns);
+
+// Record a motion event, returns true if it is the first since the last take
+bool swl_motion_push(SwlMotionState *m, uint32_t time_msec);
+// Consume the pending motion, returns false if there was none
+bool swl_motion_take(SwlMotionState *m, uint32_t *time_msec);
+
+bool swl_motion_should_notify_idle(SwlMotionState *m, int64_t now_ns);
+
+bool swl_motion_box_contains(const SwlMotionBox *box, double x, double y);
+// Shrink box so it no longer overlaps above, keeping the largest part that
+// still contains (x, y). Returns false if nothing is left.
+bool swl_motion_box_exclude(SwlMotionBox *box, const SwlMotionBox *above, double x, double y);
+
+bool swl_motion_hit_cached(const SwlMotionState *m, double x, double y);
+void swl_motion_set_hit(SwlMotionState *m, const SwlMotionBox *box);
+void swl_motion_invalidate(SwlMotionState *m);
+
+#endif /* SWL_MOTION_H */
@@ -0,0 +1,70 @@
+#ifndef SWL_OUTQUEUE_H
+#define SWL_OUTQUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "json.h"
+
+// Outbound message queue for a non-blocking stream socket. Messages are
+// reference counted so one broadcast can sit in many queues, and are only
+// ever written whole, in order, so the NDJSON framing survives partial
+// writes. Once more than high_water bytes are waiting the overflow policy
+// decides what gives.
+//
+// The gap marker is written in the queue's encoding: a text line, or for
+// SWL_JSON_CBOR a document behind a 4-byte big-endian length like every
+// other binary frame.
+
+typedef enum {
+    SWL_OVERFLOW_DROP_OLDEST,  // Drop unsent messages, then send a gap marker
+    SWL_OVERFLOW_COALESCE,     // Replace the queued message of the same type
+                               // and key, dropping the oldest if that isn't
+                               // enough
+    SWL_OVERFLOW_DISCONNECT,   // Give up on the reader
+} SwlOverflowPolicy;
+
+// Type of replies and handshakes: the reader asked for them, so they are
+// never dropped or coalesced away
+#define SWL_OUTMSG_REPLY (UINT32_MAX - 1)
+
+typedef struct SwlOutMsg {
+    int refs;
+    uint32_t type;
+    uint64_t key;  // Object the message is about, 0 by default
+    size_t len;
+    char data[];
+} SwlOutMsg;
+
+typedef struct SwlOutQueue {
+    SwlOutMsg **ring;
+    size_t head, count, cap;
+    size_t offset;      // Bytes of the head message already written
+    size_t bytes;       // Unwritten bytes queued
+    size_t high_water;
+    SwlOverflowPolicy policy;
+    SwlJsonEncoding encoding;  // Of the queued messages, SWL_JSON_TEXT by default
+    uint64_t dropped;        // Dropped since the last gap marker
+    uint64_t dropped_total;
+} SwlOutQueue;
+
+SwlOutMsg *swl_outmsg_create(uint32_t type, const char *data, size_t len);
+void swl_outmsg_unref(SwlOutMsg *msg);
+
+void swl_outqueue_init(SwlOutQueue *q, size_t high_water, SwlOverflowPolicy policy);
+void swl_outqueue_finish(SwlOutQueue *q);
+bool swl_outqueue_empty(const SwlOutQueue *q);
+
+// Queue a message (takes a new reference). Returns false when the reader
+// should be disconnected: policy is DISCONNECT and the mark was exceeded,
+// or memory ran out.
+bool swl_outqueue_push(SwlOutQueue *q, SwlOutMsg *msg);
+
+// Write as much as the fd accepts. Returns 1 when drained, 0 when the fd
+// would block with data left, -1 on a write error.
+int swl_outqueue_flush(SwlOutQueue *q, int fd);
+
+// Parse "drop_oldest", "coalesce" or "disconnect"
+bool swl_overflow_policy_from_string(const char *name, SwlOverflowPolicy *out);
+
+#endif /* SWL_OUTQUEUE_H */
@@ -0,0 +1,46 @@
+#ifndef SWL_PROCESS_H
+#define SWL_PROCESS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include "error.h"
+#include "events.h"
+
+// Children spawned by the compositor. Exits are collected on the event loop
+// (SIGCHLD is delivered through a signalfd) and reported on the event bus.
+
+#define SWL_MAX_PROCESSES 64
+#define SWL_PROCESS_CMD_MAX 256
+
+typedef struct SwlProcessTable SwlProcessTable;
+
+// Data for SWL_EVENT_PROCESS_EXIT
+typedef struct SwlProcessExit {
+    pid_t pid;
+    int exit_code;  // -1 if killed by a signal
+    int signal;     // 0 unless killed by a signal
+    const char *command;
+} SwlProcessExit;
+
+SwlProcessTable *swl_process_table_create(SwlEventBus *bus);
+void swl_process_table_destroy(SwlProcessTable *table);
+
+SwlError swl_process_track(SwlProcessTable *table, pid_t pid, const char *command);
+bool swl_process_is_tracked(const SwlProcessTable *table, pid_t pid);
+const char *swl_process_get_command(const SwlProcessTable *table, pid_t pid);
+size_t swl_process_count(const SwlProcessTable *table);
+
+// Collect every exited child without blocking. Tracked children are removed
+// from the table and reported. Returns the number of children reaped.
+size_t swl_process_reap(SwlProcessTable *table);
+
+// Run argv (searched in PATH) via posix_spawn with default signal state and
+// only stdio inherited, optionally in its own session. The child is tracked
+// if table is non-NULL. Returns the pid, or -1 if it could not be executed.
+pid_t swl_process_spawn(SwlProcessTable *table, char *const argv[], bool new_session);
+
+// Run command through /bin/sh -c in its own session
+pid_t swl_process_spawn_shell(SwlProcessTable *table, const char *command);
+
+#endif /* SWL_PROCESS_H */
@@ -0,0 +1,41 @@
+#ifndef SWL_PROFILE_H
+#define SWL_PROFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Startup phase timings on CLOCK_MONOTONIC. Phases are recorded back to
+// back: each one runs from the previous mark to the current one.
+
+#define SWL_PROFILE_MAX_PHASES 48
+
+typedef struct SwlProfilePhase {
+    const char *name;  // Static string
+    int64_t start_ns;  // Relative to the profile origin
+    int64_t duration_ns;
+} SwlProfilePhase;
+
+typedef struct SwlStartupProfile {
+    int64_t origin_ns;
+    int64_t mark_ns;
+    SwlProfilePhase phases[SWL_PROFILE_MAX_PHASES];
+    size_t count;
+    int64_t first_frame_ns;  // Relative to origin, 0 until the first commit
+} SwlStartupProfile;
+
+int64_t swl_profile_now(void);
+
+void swl_profile_begin(SwlStartupProfile *profile, int64_t now_ns);
+// Record a phase ending at now_ns, named by a string with static lifetime
+void swl_profile_mark(SwlStartupProfile *profile, const char *name, int64_t now_ns);
+// Returns true only for the first call
+bool swl_profile_first_frame(SwlStartupProfile *profile, int64_t now_ns);
+
+// Time from the origin to the last mark
+int64_t swl_profile_total(const SwlStartupProfile *profile);
+
+// Human-readable, one phase per line. Returns the length like snprintf.
+int swl_profile_format(const SwlStartupProfile *profile, char *buf, size_t size);
+
+#endif /* SWL_PROFILE_H */
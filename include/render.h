@@ -2,13 +2,16 @@
 #define SWL_RENDER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "error.h"
 
 typedef struct SwlRenderer SwlRenderer;
 typedef struct SwlCompositor SwlCompositor;
 typedef struct SwlClient SwlClient;
+typedef struct SwlMonitor SwlMonitor;
 
 typedef struct SwlRenderConfig {
+    bool blur_enabled;
     int blur_radius;
     int blur_passes;
     bool blur_optimize;
@@ -25,6 +28,9 @@ typedef struct SwlRenderConfig {
     float opacity_active;
     float opacity_inactive;
 
+    int throttle_divisor;  // Unfocused clients get every Nth frame callback
+    int throttle_hz;       // Or a fixed rate; takes precedence when > 0
+
     bool animations_enabled;
     int animation_duration_ms;
 
@@ -34,6 +40,38 @@ typedef struct SwlRenderConfig {
     float border_color_urgent[4];
 } SwlRenderConfig;
 
+#define SWL_PROFILE_BLUR             (1u << 0)
+#define SWL_PROFILE_SHADOW           (1u << 1)
+#define SWL_PROFILE_CORNER_RADIUS    (1u << 2)
+#define SWL_PROFILE_OPACITY_ACTIVE   (1u << 3)
+#define SWL_PROFILE_OPACITY_INACTIVE (1u << 4)
+#define SWL_PROFILE_SUSPEND          (1u << 5)
+#define SWL_PROFILE_THROTTLE         (1u << 6)
+
+// Per-client overrides of the global effect settings. Only fields whose
+// SWL_PROFILE_* bit is in `set` override, the rest follow the config.
+typedef struct SwlRenderProfile {
+    uint32_t set;
+    bool blur;
+    bool shadow;
+    int corner_radius;
+    float opacity_active;
+    float opacity_inactive;
+    bool suspend;  // May be suspended while behind a fullscreen client
+    int throttle_divisor;  // Frame callback rate while unfocused, see SwlRenderConfig
+    int throttle_hz;
+} SwlRenderProfile;
+
+// Effect quality as currently applied by the governor
+typedef struct SwlRenderQuality {
+    bool governor_enabled;
+    int level;  // 0 = full quality, higher = more degraded
+    int max_level;
+    int blur_passes;
+    int blur_radius;
+    bool unfocused_shadows;
+} SwlRenderQuality;
+
 SwlRenderer *swl_renderer_create(SwlCompositor *comp);
 void swl_renderer_destroy(SwlRenderer *r);
 
@@ -51,6 +89,29 @@ bool swl_renderer_get_client_blur(const SwlRenderer *r, const SwlClient *c);
 bool swl_renderer_get_client_shadow(const SwlRenderer *r, const SwlClient *c);
 int swl_renderer_get_client_corner_radius(const SwlRenderer *r, const SwlClient *c);
 
+SwlError swl_renderer_set_client_profile(SwlRenderer *r, SwlClient *c, const SwlRenderProfile *profile);
+SwlRenderProfile swl_renderer_get_client_profile(const SwlRenderer *r, const SwlClient *c);
+
+// Whether a client with pending frame callbacks should get them now. When
+// not, *next_ns is set to the earliest time they may go out. All calls with
+// the same `now_ns` return the same answer for a client. refresh_ns is the
+// output's refresh period, 0 if unknown.
+bool swl_renderer_should_send_frame(SwlRenderer *r, SwlClient *c, int64_t now_ns,
+                                    int64_t refresh_ns, int64_t *next_ns);
+
+// Whether the throttle is holding a client's callbacks back. A client already
+// decided on at `now_ns` counts, so all its buffers get the same answer.
+bool swl_renderer_frame_withheld(const SwlRenderer *r, const SwlClient *c, int64_t now_ns);
+
 void swl_renderer_damage_whole(SwlRenderer *r);
 
+// Re-apply effects for the client's focus state, overrides and the current quality
+void swl_renderer_update_client(SwlRenderer *r, SwlClient *c);
+
+// Governor input: render duration of one frame on mon
+void swl_renderer_report_frame(SwlRenderer *r, SwlMonitor *mon,
+                               int64_t render_ns, int64_t refresh_ns);
+void swl_renderer_forget_output(SwlRenderer *r, SwlMonitor *mon);
+SwlRenderQuality swl_renderer_get_quality(const SwlRenderer *r);
+
 #endif /* SWL_RENDER_H */
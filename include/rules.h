@@ -5,12 +5,14 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "error.h"
+#include "render.h"
 
 typedef struct SwlRule {
     const char *app_id_pattern;
     const char *title_pattern;
     bool floating;
     int monitor;
+    SwlRenderProfile profile;  // Effect overrides, see SWL_PROFILE_*
 } SwlRule;
 
 typedef struct SwlRuleEngine SwlRuleEngine;
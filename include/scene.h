@@ -12,6 +12,7 @@ typedef struct SwlMonitor SwlMonitor;
 typedef enum {
     SWL_LAYER_BACKGROUND,
     SWL_LAYER_BOTTOM,
+    SWL_LAYER_BLUR,  // Cached blur of background/bottom, sampled by clients
     SWL_LAYER_TILES,
     SWL_LAYER_FLOAT,
     SWL_LAYER_TOP,
@@ -45,7 +46,9 @@ void swl_scene_client_clear_clip(SwlClient *client);
 
 // Scenefx effects
 void swl_scene_client_set_shadow(SwlClient *client, bool enabled, int blur_sigma, const float color[4]);
+void swl_scene_client_set_blur(SwlClient *client, bool enabled, bool optimized, bool ignore_transparent);
 void swl_scene_client_set_corner_radius(SwlClient *client, int radius);
 void swl_scene_client_set_opacity(SwlClient *client, float opacity);
+float swl_scene_client_get_opacity(SwlClient *client);
 
 #endif /* SWL_SCENE_H */
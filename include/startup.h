@@ -0,0 +1,20 @@
+#ifndef SWL_STARTUP_H
+#define SWL_STARTUP_H
+
+#include <stdbool.h>
+
+// Session startup helpers, run in order from the event loop:
+// environment import into D-Bus/systemd, swl-session.target, startup_cmd.
+// Each step waits for the previous one to exit, or for a timeout.
+
+typedef struct SwlStartup SwlStartup;
+struct SwlCompositor;
+
+SwlStartup *swl_startup_create(struct SwlCompositor *comp, const char *startup_cmd);
+void swl_startup_destroy(SwlStartup *startup);
+
+// Start the sequence; returns immediately
+void swl_startup_begin(SwlStartup *startup);
+bool swl_startup_is_done(const SwlStartup *startup);
+
+#endif /* SWL_STARTUP_H */
@@ -13,6 +13,9 @@ typedef struct SwlClient SwlClient;
 SwlXWayland *swl_xwayland_create(SwlCompositor *comp);
 void swl_xwayland_destroy(SwlXWayland *xwl);
 
+// True once the server is running and the window manager is connected.
+// In lazy mode that is only after the first X client has connected, while
+// the display name is valid (and exported as DISPLAY) from the start.
 bool swl_xwayland_is_ready(SwlXWayland *xwl);
 const char *swl_xwayland_get_display(SwlXWayland *xwl);
 
@@ -2,6 +2,7 @@
 #include "client_internal.h"
 #include "compositor.h"
 #include "config.h"
+#include "input.h"
 #include "monitor.h"
 #include "session_lock.h"
 #include <limits.h>
@@ -10,6 +11,7 @@
 #include <string.h>
 #include <wayland-server-core.h>
 #include <scenefx/types/wlr_scene.h>
+#include <wlr/types/wlr_compositor.h>
 #include <wlr/types/wlr_seat.h>
 #include <wlr/types/wlr_output.h>
 #include <wlr/types/wlr_xdg_shell.h>
@@ -46,6 +48,7 @@ static void client_handle_commit(struct wl_listener *listener, void *data);
 static void client_handle_request_fullscreen(struct wl_listener *listener, void *data);
 static void client_handle_set_title(struct wl_listener *listener, void *data);
 static void client_handle_set_app_id(struct wl_listener *listener, void *data);
+static bool surface_fully_opaque(struct wlr_surface *surface);
 
 SwlClientManager *swl_client_manager_create(SwlCompositor *comp)
 {
@@ -126,6 +129,18 @@ SwlClient *swl_client_create_xdg(SwlClientManager *mgr, struct wlr_xdg_toplevel
     return c;
 }
 
+// Node moves, restacks and visibility changes the pointer's cached hit
+// can't see coming
+static void scene_changed(SwlClientManager *mgr)
+{
+    swl_input_scene_changed(swl_compositor_get_input(mgr->comp));
+}
+
+static bool scene_visible(const SwlClient *c)
+{
+    return c->scene_data && c->scene_data->tree && c->scene_data->tree->node.enabled;
+}
+
 static void focus_client_internal(SwlClient *c)
 {
     if (!c || !c->mgr)
@@ -161,8 +176,10 @@ static void focus_client_internal(SwlClient *c)
     if (c->scene_data && c->scene_data->tree) {
         SwlConfig *cfg = swl_compositor_get_config(comp);
         bool raise = swl_config_get_bool(cfg, "general.raise_on_focus", true);
-        if (raise)
+        if (raise) {
             wlr_scene_node_raise_to_top(&c->scene_data->tree->node);
+            scene_changed(c->mgr);
+        }
     }
 }
 
@@ -224,7 +241,10 @@ static void client_handle_map(struct wl_listener *listener, void *data)
         }
     }
 
-    // Apply window rules (may override auto-float)
+    swl_scene_client_create(c->mgr->scene_mgr, c);
+
+    // Apply window rules (may override auto-float); after scene creation
+    // so render profiles have somewhere to live
     if (c->mgr->rules)
         swl_rule_engine_apply(c->mgr->rules, c);
 
@@ -234,8 +254,6 @@ static void client_handle_map(struct wl_listener *listener, void *data)
         wlr_xdg_toplevel_set_tiled(c->xdg, edges);
     }
 
-    swl_scene_client_create(c->mgr->scene_mgr, c);
-
     // Place floating clients on the float layer and center on monitor
     if (c->floating && c->mgr->scene_mgr)
         swl_scene_client_set_layer(c->mgr->scene_mgr, c, SWL_LAYER_FLOAT);
@@ -270,6 +288,7 @@ static void client_handle_map(struct wl_listener *listener, void *data)
     // Apply corner radius to surface buffers
     if (cfg.corner_radius > 0)
         swl_scene_client_set_corner_radius(c, cfg.corner_radius);
+    swl_renderer_update_client(renderer, c);
 
     swl_client_focus(c);
 
@@ -294,6 +313,7 @@ static void client_handle_unmap(struct wl_listener *listener, void *data)
     (void)data;
 
     c->mapped = false;
+    c->occluded = false;
 
     if (c->mgr->focused == c) {
         c->mgr->focused = NULL;
@@ -367,6 +387,25 @@ static void client_handle_commit(struct wl_listener *listener, void *data)
     if (!c->mapped)
         return;
 
+    // The focused client reacting to input, its next frame is what the
+    // latency statistics measure
+    struct wlr_surface *surface = c->xdg->base->surface;
+    if (c->focused && c->mon && pixman_region32_not_empty(&surface->buffer_damage))
+        swl_monitor_note_client_damage(c->mon);
+
+    // A fullscreen client switching between opaque and alpha content
+    // changes what it hides
+    bool opaque = surface_fully_opaque(surface);
+    if (opaque != c->surface_opaque) {
+        c->surface_opaque = opaque;
+        if (c->fullscreen && c->mon)
+            swl_client_update_occlusion(c->mgr, c->mon);
+    }
+
+    // An interactive resize may have been waiting for this ack
+    if (c->resize_pending && c->mon)
+        wlr_output_schedule_frame(swl_monitor_get_wlr_output(c->mon));
+
     // Re-apply resize on every commit, like swl_mac does
     // This ensures the client receives the configure and resizes properly
     int bw = c->border_width;
@@ -764,7 +803,7 @@ SwlError swl_client_focus(SwlClient *client)
         unfocus_client_internal(old);
 
         swl_scene_update_borders(old, cfg.border_width, cfg.border_color_unfocused);
-        swl_scene_client_set_opacity(old, cfg.opacity_inactive);
+        swl_renderer_update_client(renderer, old);
 
         SwlEventBus *bus = swl_compositor_get_event_bus(client->mgr->comp);
         swl_event_bus_emit_simple(bus, SWL_EVENT_CLIENT_UNFOCUS, old);
@@ -783,7 +822,7 @@ SwlError swl_client_focus(SwlClient *client)
     focus_client_internal(client);
 
     swl_scene_update_borders(client, cfg.border_width, cfg.border_color_focused);
-    swl_scene_client_set_opacity(client, cfg.opacity_active);
+    swl_renderer_update_client(renderer, client);
 
     SwlEventBus *bus = swl_compositor_get_event_bus(client->mgr->comp);
     swl_event_bus_emit_simple(bus, SWL_EVENT_CLIENT_FOCUS, client);
@@ -808,6 +847,7 @@ SwlError swl_client_set_floating(SwlClient *client, bool floating)
     if (client->mgr->scene_mgr) {
         SwlSceneLayer layer = floating ? SWL_LAYER_FLOAT : SWL_LAYER_TILES;
         swl_scene_client_set_layer(client->mgr->scene_mgr, client, layer);
+        scene_changed(client->mgr);
     }
 
     SwlEventBus *bus = swl_compositor_get_event_bus(client->mgr->comp);
@@ -827,16 +867,48 @@ SwlError swl_client_toggle_floating(SwlClient *client)
     return swl_client_set_floating(client, !client->floating);
 }
 
+SwlError swl_client_set_render_profile(SwlClient *client, const SwlRenderProfile *profile)
+{
+    if (!client || !profile)
+        return SWL_ERR_INVALID_ARG;
+
+    SwlRenderer *renderer = swl_compositor_get_renderer(client->mgr->comp);
+    SwlError err = swl_renderer_set_client_profile(renderer, client, profile);
+    if (err != SWL_OK)
+        return err;
+
+    // Suspend policy may have changed
+    if (client->mon)
+        swl_client_update_occlusion(client->mgr, client->mon);
+    return SWL_OK;
+}
+
 SwlError swl_client_set_fullscreen(SwlClient *client, bool fullscreen)
 {
     if (!client)
         return SWL_ERR_INVALID_ARG;
 
-    if (fullscreen)
+    if (client->fullscreen == fullscreen)
+        return SWL_OK;
+
+    if (fullscreen) {
         swl_client_unlink_column(client);
 
+        client->saved_x = client->x;
+        client->saved_y = client->y;
+        client->saved_width = client->width;
+        client->saved_height = client->height;
+    }
+
     client->fullscreen = fullscreen;
 
+    // Floating clients don't get placed by the layout, put them back by hand
+    if (!fullscreen && client->floating && client->saved_width > 0) {
+        int bw = client->border_width;
+        swl_client_resize(client, client->saved_x, client->saved_y,
+            client->saved_width + 2 * bw, client->saved_height + 2 * bw);
+    }
+
     if (client->xdg && client->xdg->base && client->xdg->base->initialized)
         wlr_xdg_toplevel_set_fullscreen(client->xdg, fullscreen);
 
@@ -844,6 +916,7 @@ SwlError swl_client_set_fullscreen(SwlClient *client, bool fullscreen)
         SwlSceneLayer layer = fullscreen ? SWL_LAYER_FULLSCREEN :
             (client->floating ? SWL_LAYER_FLOAT : SWL_LAYER_TILES);
         swl_scene_client_set_layer(client->mgr->scene_mgr, client, layer);
+        scene_changed(client->mgr);
     }
 
     SwlEventBus *bus = swl_compositor_get_event_bus(client->mgr->comp);
@@ -896,38 +969,30 @@ SwlError swl_client_move_to_monitor(SwlClient *client, SwlMonitor *mon)
     return SWL_OK;
 }
 
-SwlError swl_client_resize(SwlClient *client, int x, int y, int w, int h)
+// Apply clipping/visibility based on monitor boundaries
+static void update_clip(SwlClient *client)
 {
-    if (!client)
-        return SWL_ERR_INVALID_ARG;
-
-    // w and h are TOTAL geometry (including borders), like swl_mac
-    // Calculate content size by subtracting borders
-    int bw = client->border_width;
-    int content_w = w - 2 * bw;
-    int content_h = h - 2 * bw;
-
-    client->x = x;
-    client->y = y;
-    client->width = content_w;
-    client->height = content_h;
-
-    swl_scene_client_set_position(client, x, y);
-    swl_scene_client_set_size(client, content_w, content_h);
-
-#ifdef SWL_XWAYLAND
-    // Configure XWayland surface with its position and size
-    if (client->is_x11 && client->xwayland) {
-        wlr_xwayland_surface_configure(client->xwayland,
-            x + bw, y + bw, content_w, content_h);
-    }
-#endif
-
-    // Apply clipping/visibility based on monitor boundaries
-    // Note: w and h are total geometry including borders
-    if (client->mon) {
+    // Total geometry including borders
+    int x = client->x;
+    int y = client->y;
+    int w = client->width + 2 * client->border_width;
+    int h = client->height + 2 * client->border_width;
+
+    if (client->occluded) {
+        // Nothing on this monitor can be seen under the fullscreen client
+        swl_scene_client_set_visible(client, false);
+    } else if (client->mon) {
         int mx, my, mw, mh;
-        swl_monitor_get_usable_area(client->mon, &mx, &my, &mw, &mh);
+        if (client->fullscreen) {
+            // Fullscreen covers layer-shell exclusive zones too
+            SwlMonitorInfo minfo = swl_monitor_get_info(client->mon);
+            mx = minfo.x;
+            my = minfo.y;
+            mw = minfo.width;
+            mh = minfo.height;
+        } else {
+            swl_monitor_get_usable_area(client->mon, &mx, &my, &mw, &mh);
+        }
 
         int client_left = x;
         int client_top = y;
@@ -961,6 +1026,44 @@ SwlError swl_client_resize(SwlClient *client, int x, int y, int w, int h)
             swl_scene_client_clear_clip(client);
         }
     }
+}
+
+SwlError swl_client_resize(SwlClient *client, int x, int y, int w, int h)
+{
+    if (!client)
+        return SWL_ERR_INVALID_ARG;
+
+    // w and h are TOTAL geometry (including borders), like swl_mac
+    // Calculate content size by subtracting borders
+    int bw = client->border_width;
+    int content_w = w - 2 * bw;
+    int content_h = h - 2 * bw;
+
+    // Commits re-apply the same geometry, only real changes affect hit-testing
+    bool changed = client->move_pending || x != client->x || y != client->y ||
+                   content_w != client->width || content_h != client->height;
+    bool was_visible = scene_visible(client);
+
+    client->x = x;
+    client->y = y;
+    client->width = content_w;
+    client->height = content_h;
+
+    swl_scene_client_set_position(client, x, y);
+    swl_scene_client_set_size(client, content_w, content_h);
+
+#ifdef SWL_XWAYLAND
+    // Configure XWayland surface with its position and size
+    if (client->is_x11 && client->xwayland) {
+        wlr_xwayland_surface_configure(client->xwayland,
+            x + bw, y + bw, content_w, content_h);
+    }
+#endif
+
+    update_clip(client);
+    client->move_pending = false;
+    if (changed || scene_visible(client) != was_visible)
+        scene_changed(client->mgr);
 
     SwlEventBus *bus = swl_compositor_get_event_bus(client->mgr->comp);
     swl_event_bus_emit_simple(bus, SWL_EVENT_CLIENT_RESIZE, client);
@@ -968,6 +1071,103 @@ SwlError swl_client_resize(SwlClient *client, int x, int y, int w, int h)
     return SWL_OK;
 }
 
+// Interactive moves only translate the window. The scene node, X11
+// position and clip are brought up to date once per output frame by
+// swl_client_manager_flush_interactive(), however many motion events came in.
+SwlError swl_client_move(SwlClient *client, int x, int y)
+{
+    if (!client)
+        return SWL_ERR_INVALID_ARG;
+
+    if (client->x == x && client->y == y)
+        return SWL_OK;
+
+    client->x = x;
+    client->y = y;
+    client->move_pending = true;
+    client->mgr->interactive_pending = true;
+
+    if (client->mon)
+        wlr_output_schedule_frame(swl_monitor_get_wlr_output(client->mon));
+
+    return SWL_OK;
+}
+
+// Interactive resizes keep at most one configure in flight: the newest
+// size waits until the client acked the previous one, then goes out with
+// the next frame. Sizes in between are never sent.
+SwlError swl_client_resize_interactive(SwlClient *client, int x, int y, int w, int h)
+{
+    if (!client)
+        return SWL_ERR_INVALID_ARG;
+
+    client->resize_pending = true;
+    client->pending_x = x;
+    client->pending_y = y;
+    client->pending_w = w;
+    client->pending_h = h;
+    client->mgr->interactive_pending = true;
+
+    if (client->mon)
+        wlr_output_schedule_frame(swl_monitor_get_wlr_output(client->mon));
+
+    return SWL_OK;
+}
+
+static bool resize_acked(const SwlClient *c)
+{
+    if (c->resize_serial == 0 || !c->xdg || !c->xdg->base)
+        return true;
+
+    // Serials wrap, compare the difference
+    return (int32_t)(c->xdg->base->current.configure_serial - c->resize_serial) >= 0;
+}
+
+void swl_client_manager_flush_interactive(SwlClientManager *mgr)
+{
+    if (!mgr || !mgr->interactive_pending)
+        return;
+
+    mgr->interactive_pending = false;
+    SwlEventBus *bus = swl_compositor_get_event_bus(mgr->comp);
+
+    SwlClient *c;
+    wl_list_for_each(c, &mgr->clients, link) {
+        if (c->resize_pending) {
+            if (!resize_acked(c)) {
+                // Check again once the client commits
+                mgr->interactive_pending = true;
+                continue;
+            }
+
+            c->resize_pending = false;
+            swl_client_resize(c, c->pending_x, c->pending_y, c->pending_w, c->pending_h);
+            c->resize_serial = (c->xdg && c->xdg->base->initialized)
+                ? c->xdg->base->scheduled_serial : 0;
+            continue;
+        }
+
+        if (!c->move_pending)
+            continue;
+        c->move_pending = false;
+
+        swl_scene_client_set_position(c, c->x, c->y);
+
+#ifdef SWL_XWAYLAND
+        // Size is unchanged, X11 clients only learn the new position
+        if (c->is_x11 && c->xwayland) {
+            int bw = c->border_width;
+            wlr_xwayland_surface_configure(c->xwayland,
+                c->x + bw, c->y + bw, c->width, c->height);
+        }
+#endif
+
+        update_clip(c);
+        scene_changed(mgr);
+        swl_event_bus_emit_simple(bus, SWL_EVENT_CLIENT_RESIZE, c);
+    }
+}
+
 SwlError swl_client_set_border_color(SwlClient *client, const float color[4])
 {
     if (!client || !color)
@@ -1047,6 +1247,91 @@ SwlError swl_client_zoom(SwlClientManager *mgr)
     return SWL_OK;
 }
 
+// True when the client promises every pixel is opaque. wlroots fills the
+// opaque region for buffers without alpha, so an alpha buffer (translucent
+// terminal, video overlay) only counts if it says so itself.
+static bool surface_fully_opaque(struct wlr_surface *surface)
+{
+    if (!surface || surface->current.width <= 0 || surface->current.height <= 0)
+        return false;
+
+    pixman_box32_t box = {
+        .x1 = 0,
+        .y1 = 0,
+        .x2 = surface->current.width,
+        .y2 = surface->current.height,
+    };
+    return pixman_region32_contains_rectangle(&surface->opaque_region, &box) ==
+           PIXMAN_REGION_IN;
+}
+
+static bool is_opaque_fullscreen(SwlClient *c)
+{
+    if (!c->mapped || !c->fullscreen || !c->mon)
+        return false;
+
+    // Translucent fullscreen clients (e.g. inactive opacity or an alpha
+    // buffer) still show what's underneath, so they can't occlude anything
+    if (swl_scene_client_get_opacity(c) < 1.0f)
+        return false;
+    if (!surface_fully_opaque(swl_client_get_surface(c)))
+        return false;
+
+    SwlMonitorInfo m = swl_monitor_get_info(c->mon);
+    int bw = c->border_width;
+    return c->x + bw <= m.x && c->y + bw <= m.y &&
+           c->x + bw + c->width >= m.x + m.width &&
+           c->y + bw + c->height >= m.y + m.height;
+}
+
+static bool may_suspend(SwlClient *c)
+{
+    const SwlRenderProfile *p = c->scene_data ? &c->scene_data->profile : NULL;
+    return !p || !(p->set & SWL_PROFILE_SUSPEND) || p->suspend;
+}
+
+static void set_occluded(SwlClient *c, bool occluded)
+{
+    if (c->occluded == occluded)
+        return;
+
+    c->occluded = occluded;
+
+    // Suspended clients may stop rendering; disabled scene nodes get no
+    // frame callbacks and skip blur/shadow passes entirely
+    if (c->xdg && c->xdg->base && c->xdg->base->initialized)
+        wlr_xdg_toplevel_set_suspended(c->xdg, occluded);
+
+    // Re-run resize so visibility and clipping are recomputed either way
+    int bw = c->border_width;
+    swl_client_resize(c, c->x, c->y, c->width + 2 * bw, c->height + 2 * bw);
+}
+
+void swl_client_update_occlusion(SwlClientManager *mgr, SwlMonitor *mon)
+{
+    if (!mgr || !mon)
+        return;
+
+    // Most recently focused fullscreen client wins if there are several
+    SwlClient *fs = NULL;
+    SwlClient *c;
+    wl_list_for_each(c, &mgr->focus_stack, flink) {
+        if (c->mon == mon && is_opaque_fullscreen(c)) {
+            fs = c;
+            break;
+        }
+    }
+
+    wl_list_for_each(c, &mgr->clients, link) {
+        if (!c->mapped || c->mon != mon || c == fs)
+            continue;
+        set_occluded(c, fs != NULL && may_suspend(c));
+    }
+
+    if (fs)
+        set_occluded(fs, false);
+}
+
 SwlClient *swl_client_in_direction(SwlClientManager *mgr, SwlClient *from, int direction)
 {
     if (!mgr || !from)
@@ -1135,7 +1420,7 @@ SwlError swl_client_manager_load_rules(SwlClientManager *mgr)
     // Enumerate rule indices (rules.0, rules.1, etc.)
     // Find the highest index by checking for rules.N.app_id or rules.N.title
     for (int i = 0; i < 128; i++) {
-        char key_app_id[64], key_title[64], key_floating[64], key_monitor[64];
+        char key_app_id[64], key_title[64], key_floating[64], key_monitor[64], key[64];
         snprintf(key_app_id, sizeof(key_app_id), "rules.%d.app_id", i);
         snprintf(key_title, sizeof(key_title), "rules.%d.title", i);
         snprintf(key_floating, sizeof(key_floating), "rules.%d.floating", i);
@@ -1151,6 +1436,48 @@ SwlError swl_client_manager_load_rules(SwlClientManager *mgr)
         rule.floating = swl_config_get_bool(cfg, key_floating, false);
         rule.monitor = swl_config_get_int(cfg, key_monitor, -1);
 
+        // Effect overrides only apply when present, otherwise follow [scenefx]
+        snprintf(key, sizeof(key), "rules.%d.blur", i);
+        if (swl_config_has_key(cfg, key)) {
+            rule.profile.set |= SWL_PROFILE_BLUR;
+            rule.profile.blur = swl_config_get_bool(cfg, key, false);
+        }
+        snprintf(key, sizeof(key), "rules.%d.shadow", i);
+        if (swl_config_has_key(cfg, key)) {
+            rule.profile.set |= SWL_PROFILE_SHADOW;
+            rule.profile.shadow = swl_config_get_bool(cfg, key, false);
+        }
+        snprintf(key, sizeof(key), "rules.%d.corner_radius", i);
+        if (swl_config_has_key(cfg, key)) {
+            rule.profile.set |= SWL_PROFILE_CORNER_RADIUS;
+            rule.profile.corner_radius = swl_config_get_int(cfg, key, 0);
+        }
+        snprintf(key, sizeof(key), "rules.%d.opacity_active", i);
+        if (swl_config_has_key(cfg, key)) {
+            rule.profile.set |= SWL_PROFILE_OPACITY_ACTIVE;
+            rule.profile.opacity_active = swl_config_get_float(cfg, key, 1.0f);
+        }
+        snprintf(key, sizeof(key), "rules.%d.opacity_inactive", i);
+        if (swl_config_has_key(cfg, key)) {
+            rule.profile.set |= SWL_PROFILE_OPACITY_INACTIVE;
+            rule.profile.opacity_inactive = swl_config_get_float(cfg, key, 1.0f);
+        }
+        snprintf(key, sizeof(key), "rules.%d.suspend", i);
+        if (swl_config_has_key(cfg, key)) {
+            rule.profile.set |= SWL_PROFILE_SUSPEND;
+            rule.profile.suspend = swl_config_get_bool(cfg, key, true);
+        }
+        snprintf(key, sizeof(key), "rules.%d.throttle_divisor", i);
+        if (swl_config_has_key(cfg, key)) {
+            rule.profile.set |= SWL_PROFILE_THROTTLE;
+            rule.profile.throttle_divisor = swl_config_get_int(cfg, key, 1);
+        }
+        snprintf(key, sizeof(key), "rules.%d.throttle_hz", i);
+        if (swl_config_has_key(cfg, key)) {
+            rule.profile.set |= SWL_PROFILE_THROTTLE;
+            rule.profile.throttle_hz = swl_config_get_int(cfg, key, 0);
+        }
+
         swl_rule_engine_add(mgr->rules, &rule);
     }
 
@@ -6,19 +6,13 @@
 #include "scene.h"
 #include "render.h"
 #include "events.h"
+#include "../render/scene_internal.h"
 #include <wayland-server-core.h>
 #include <wlr/types/wlr_xdg_shell.h>
 #ifdef SWL_XWAYLAND
 #include <wlr/xwayland.h>
 #endif
 
-typedef struct {
-    struct wlr_scene_tree *tree;
-    struct wlr_scene_tree *surface_tree;
-    struct wlr_scene_rect *border[4];
-    int border_width;
-} ClientSceneData;
-
 #define SWL_CLIENT_MAGIC 0xDEADC0DE
 
 struct SwlClient {
@@ -41,6 +35,17 @@ struct SwlClient {
     bool urgent;
     bool focused;
     bool mapped;
+    bool occluded;  // Hidden behind an opaque fullscreen client on the same monitor
+    bool surface_opaque;  // Opaque region covered the whole surface at the last commit
+    bool move_pending;  // Moved by swl_client_move(), scene not updated yet
+
+    // Interactive resize, see swl_client_resize_interactive()
+    bool resize_pending;
+    int pending_x, pending_y, pending_w, pending_h;  // Total geometry
+    uint32_t resize_serial;  // Configure the client has yet to ack, 0 = none
+
+    // Floating geometry saved when entering fullscreen, restored on exit
+    int saved_x, saved_y, saved_width, saved_height;
 
     float scroller_ratio;  // Per-client scroller column ratio (0.0 = use default)
 
@@ -74,11 +79,10 @@ struct SwlClientManager {
     uint32_t next_id;
     SwlSceneManager *scene_mgr;
     SwlRuleEngine *rules;
+    bool interactive_pending;  // Some client has a move or resize pending
 };
 
 /* Accessors used by client_x11.c */
-ClientSceneData *swl_client_get_scene_data(SwlClient *client);
-void swl_client_set_scene_data(SwlClient *client, ClientSceneData *data);
 struct wlr_xdg_toplevel *swl_client_get_xdg_toplevel(SwlClient *client);
 
 #ifdef SWL_XWAYLAND
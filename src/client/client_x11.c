@@ -126,6 +126,8 @@ static void x11_handle_map(struct wl_listener *listener, void *data)
         }
     }
 
+    swl_scene_client_create(c->mgr->scene_mgr, c);
+
     // Apply window rules
     if (c->mgr->rules)
         swl_rule_engine_apply(c->mgr->rules, c);
@@ -142,8 +144,6 @@ static void x11_handle_map(struct wl_listener *listener, void *data)
         }
     }
 
-    swl_scene_client_create(c->mgr->scene_mgr, c);
-
     SwlRenderer *renderer = swl_compositor_get_renderer(c->mgr->comp);
     SwlRenderConfig cfg = swl_renderer_get_config(renderer);
     c->border_width = cfg.border_width;  // Sync with config
@@ -152,6 +152,7 @@ static void x11_handle_map(struct wl_listener *listener, void *data)
     // Apply corner radius to surface buffers
     if (cfg.corner_radius > 0)
         swl_scene_client_set_corner_radius(c, cfg.corner_radius);
+    swl_renderer_update_client(renderer, c);
 
     swl_client_focus(c);
 
@@ -176,6 +177,7 @@ static void x11_handle_unmap(struct wl_listener *listener, void *data)
     (void)data;
 
     c->mapped = false;
+    c->occluded = false;
 
     if (c->mgr->focused == c) {
         c->mgr->focused = NULL;
@@ -155,6 +155,8 @@ void swl_rule_engine_apply(SwlRuleEngine *engine, SwlClient *client)
         if (match) {
             if (engine->rules[i].floating)
                 swl_client_set_floating(client, true);
+            if (engine->rules[i].profile.set)
+                swl_client_set_render_profile(client, &engine->rules[i].profile);
             break;
         }
     }
@@ -7,15 +7,18 @@
 #include "layer.h"
 #include "layout.h"
 #include "monitor.h"
+#include "profile.h"
+#include "process.h"
 #include "render.h"
 #include "session_lock.h"
+#include "startup.h"
 #include "toplevel.h"
 #include "xwayland.h"
 #include "../protocols/decoration.h"
 #include "../protocols/xdg_shell.h"
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/wait.h>
 #include <time.h>
 #include <unistd.h>
 #include <wayland-server-core.h>
@@ -47,9 +50,8 @@
 #include <scenefx/render/fx_renderer/fx_renderer.h>
 #include <scenefx/types/wlr_scene.h>
 
-extern void swl_signal_init(void);
-extern int swl_signal_should_quit(void);
-extern void swl_signal_request_quit(void);
+extern void swl_signal_init(SwlCompositor *comp, struct wl_event_loop *loop);
+extern void swl_signal_finish(void);
 
 struct SwlCompositor {
     struct wl_display *display;
@@ -79,6 +81,7 @@ struct SwlCompositor {
     SwlLayerManager *layer_mgr;
     SwlToplevelManager *toplevel_mgr;
     SwlSessionLock *session_lock;
+    SwlProcessTable *processes;
 
 #ifdef SWL_XWAYLAND
     SwlXWayland *xwayland;
@@ -93,9 +96,11 @@ struct SwlCompositor {
     struct wl_listener set_output_power_mode;
     struct wl_listener cursor_shape_request;
 
-    char *startup_cmd;
+    SwlStartup *startup;
     char *config_path;
     bool running;
+
+    SwlStartupProfile profile;
 };
 
 static void handle_new_xdg_toplevel(struct wl_listener *listener, void *data)
@@ -162,16 +167,24 @@ static void handle_set_output_power_mode(struct wl_listener *listener, void *dat
     wlr_output_state_finish(&state);
 }
 
+// Close the current startup phase, see swl_compositor_get_startup_profile()
+static void phase_done(SwlCompositor *comp, const char *name)
+{
+    swl_profile_mark(&comp->profile, name, swl_profile_now());
+}
+
 SwlError swl_compositor_create(SwlCompositor **out, const SwlCompositorConfig *cfg)
 {
     if (!out)
         return SWL_ERR_INVALID_ARG;
 
+    int64_t start_ns = swl_profile_now();
+
     SwlCompositor *comp = calloc(1, sizeof(*comp));
     if (!comp)
         return SWL_ERR_NOMEM;
 
-    swl_signal_init();
+    swl_profile_begin(&comp->profile, start_ns);
 
     // Event bus
     comp->event_bus = swl_event_bus_create();
@@ -179,6 +192,7 @@ SwlError swl_compositor_create(SwlCompositor **out, const SwlCompositorConfig *c
         free(comp);
         return SWL_ERR_NOMEM;
     }
+    phase_done(comp, "event bus");
 
     // Wayland display
     comp->display = wl_display_create();
@@ -189,6 +203,7 @@ SwlError swl_compositor_create(SwlCompositor **out, const SwlCompositorConfig *c
     }
 
     comp->event_loop = wl_display_get_event_loop(comp->display);
+    phase_done(comp, "display");
 
     // Backend
     comp->backend = wlr_backend_autocreate(comp->event_loop, &comp->session);
@@ -198,6 +213,7 @@ SwlError swl_compositor_create(SwlCompositor **out, const SwlCompositorConfig *c
         free(comp);
         return SWL_ERR_BACKEND;
     }
+    phase_done(comp, "backend");
 
     // Renderer (scenefx)
     comp->renderer = fx_renderer_create(comp->backend);
@@ -210,6 +226,7 @@ SwlError swl_compositor_create(SwlCompositor **out, const SwlCompositorConfig *c
     }
 
     wlr_renderer_init_wl_display(comp->renderer, comp->display);
+    phase_done(comp, "renderer");
 
     // Allocator
     comp->allocator = wlr_allocator_autocreate(comp->backend, comp->renderer);
@@ -221,6 +238,7 @@ SwlError swl_compositor_create(SwlCompositor **out, const SwlCompositorConfig *c
         free(comp);
         return SWL_ERR_BACKEND;
     }
+    phase_done(comp, "allocator");
 
     // Core Wayland protocols
     comp->wlr_compositor = wlr_compositor_create(comp->display, 6, comp->renderer);
@@ -230,11 +248,13 @@ SwlError swl_compositor_create(SwlCompositor **out, const SwlCompositorConfig *c
     wlr_viewporter_create(comp->display);
     wlr_single_pixel_buffer_manager_v1_create(comp->display);
     wlr_fractional_scale_manager_v1_create(comp->display, 1);
+    phase_done(comp, "core protocols");
 
     // Output layout and scene
     comp->output_layout = wlr_output_layout_create(comp->display);
     comp->scene = wlr_scene_create();
     wlr_scene_attach_output_layout(comp->scene, comp->output_layout);
+    phase_done(comp, "scene");
 
     // Extra protocols
     wlr_xdg_output_manager_v1_create(comp->display, comp->output_layout);
@@ -249,6 +269,7 @@ SwlError swl_compositor_create(SwlCompositor **out, const SwlCompositorConfig *c
                   &comp->cursor_shape_request);
 
     comp->idle_notifier = wlr_idle_notifier_v1_create(comp->display);
+    phase_done(comp, "extra protocols");
 
     // XDG shell
     comp->xdg_shell = wlr_xdg_shell_create(comp->display, 6);
@@ -256,6 +277,7 @@ SwlError swl_compositor_create(SwlCompositor **out, const SwlCompositorConfig *c
     wl_signal_add(&comp->xdg_shell->events.new_toplevel, &comp->new_xdg_toplevel);
     comp->new_xdg_popup.notify = handle_new_xdg_popup;
     wl_signal_add(&comp->xdg_shell->events.new_popup, &comp->new_xdg_popup);
+    phase_done(comp, "xdg shell");
 
     // Server decoration (older KDE protocol - used by Firefox, etc.)
     wlr_server_decoration_manager_set_default_mode(
@@ -267,6 +289,7 @@ SwlError swl_compositor_create(SwlCompositor **out, const SwlCompositorConfig *c
     comp->new_xdg_decoration.notify = handle_new_xdg_decoration;
     wl_signal_add(&comp->xdg_decoration_mgr->events.new_toplevel_decoration,
         &comp->new_xdg_decoration);
+    phase_done(comp, "decorations");
 
     // XDG activation (for urgency hints and focus requests)
     comp->activation = wlr_xdg_activation_v1_create(comp->display);
@@ -277,9 +300,16 @@ SwlError swl_compositor_create(SwlCompositor **out, const SwlCompositorConfig *c
     comp->output_power_mgr = wlr_output_power_manager_v1_create(comp->display);
     comp->set_output_power_mode.notify = handle_set_output_power_mode;
     wl_signal_add(&comp->output_power_mgr->events.set_mode, &comp->set_output_power_mode);
+    phase_done(comp, "activation, power");
 
     // Seat
     comp->seat = wlr_seat_create(comp->display, "seat0");
+    phase_done(comp, "seat");
+
+    // Spawned children, reaped from the event loop on SIGCHLD
+    comp->processes = swl_process_table_create(comp->event_bus);
+    swl_signal_init(comp, comp->event_loop);
+    phase_done(comp, "signals");
 
     // Configuration
     comp->config = swl_config_create();
@@ -289,48 +319,54 @@ SwlError swl_compositor_create(SwlCompositor **out, const SwlCompositorConfig *c
     } else {
         swl_config_load_default(comp->config);
     }
+    phase_done(comp, "config");
 
     // Layout registry
     comp->layouts = swl_layout_registry_create();
     swl_layout_register_builtins(comp->layouts);
+    phase_done(comp, "layouts");
 
     // Client manager
     comp->clients = swl_client_manager_create(comp);
+    phase_done(comp, "clients");
 
     // Output manager
     comp->output = swl_output_create(comp);
+    phase_done(comp, "outputs");
 
     // Input
     comp->input = swl_input_create(comp);
+    phase_done(comp, "input");
 
-    // Renderer
+    // Renderer (also pushes scenefx blur settings to the scene)
     comp->swl_renderer = swl_renderer_create(comp);
-
-    // Configure scenefx blur
-    SwlRenderConfig rcfg = swl_renderer_get_config(comp->swl_renderer);
-    wlr_scene_set_blur_data(comp->scene, rcfg.blur_passes, rcfg.blur_radius,
-        0.0f, 1.0f, 1.0f, 1.0f);  // noise, brightness, contrast, saturation
+    phase_done(comp, "effects renderer");
 
     // IPC
     comp->ipc = swl_ipc_create(comp);
     swl_ipc_register_builtins(comp->ipc);
+    phase_done(comp, "ipc");
 
     // Layer shell
     comp->layer_mgr = swl_layer_manager_create(comp);
+    phase_done(comp, "layer shell");
 
     // Foreign toplevel manager
     comp->toplevel_mgr = swl_toplevel_manager_create(comp);
+    phase_done(comp, "foreign toplevel");
 
     // Session lock
     comp->session_lock = swl_session_lock_create(comp);
+    phase_done(comp, "session lock");
 
 #ifdef SWL_XWAYLAND
     if (!cfg || cfg->enable_xwayland)
         comp->xwayland = swl_xwayland_create(comp);
+    phase_done(comp, "xwayland");
 #endif
 
-    if (cfg && cfg->startup_cmd)
-        comp->startup_cmd = strdup(cfg->startup_cmd);
+    comp->startup = swl_startup_create(comp, cfg ? cfg->startup_cmd : NULL);
+    phase_done(comp, "session startup");
 
     *out = comp;
     return SWL_OK;
@@ -356,7 +392,7 @@ void swl_compositor_destroy(SwlCompositor *comp)
     swl_layout_registry_destroy(comp->layouts);
     swl_config_destroy(comp->config);
 
-    free(comp->startup_cmd);
+    swl_startup_destroy(comp->startup);
     free(comp->config_path);
 
     wl_list_remove(&comp->new_xdg_toplevel.link);
@@ -369,7 +405,9 @@ void swl_compositor_destroy(SwlCompositor *comp)
     wlr_allocator_destroy(comp->allocator);
     wlr_renderer_destroy(comp->renderer);
     wlr_backend_destroy(comp->backend);
+    swl_signal_finish();
     wl_display_destroy(comp->display);
+    swl_process_table_destroy(comp->processes);
     swl_event_bus_destroy(comp->event_bus);
     free(comp);
 }
@@ -382,9 +420,11 @@ SwlError swl_compositor_run(SwlCompositor *comp)
     const char *socket = wl_display_add_socket_auto(comp->display);
     if (!socket)
         return SWL_ERR_WAYLAND;
+    phase_done(comp, "socket");
 
     if (!wlr_backend_start(comp->backend))
         return SWL_ERR_BACKEND;
+    phase_done(comp, "backend start");
 
     setenv("WAYLAND_DISPLAY", socket, 1);
     setenv("XDG_CURRENT_DESKTOP", "wlroots", 1);
@@ -397,38 +437,9 @@ SwlError swl_compositor_run(SwlCompositor *comp)
     }
 #endif
 
-    // Import environment variables into D-Bus and systemd user session.
-    // This must complete before starting the session target so that services
-    // like waybar can see WAYLAND_DISPLAY.
-    pid_t dbus_pid = fork();
-    if (dbus_pid == 0) {
-#ifdef SWL_XWAYLAND
-        execlp("dbus-update-activation-environment", "dbus-update-activation-environment",
-            "--systemd", "WAYLAND_DISPLAY", "XDG_CURRENT_DESKTOP", "PATH", "SWL_SOCKET",
-            "DISPLAY", NULL);
-#else
-        execlp("dbus-update-activation-environment", "dbus-update-activation-environment",
-            "--systemd", "WAYLAND_DISPLAY", "XDG_CURRENT_DESKTOP", "PATH", "SWL_SOCKET",
-            NULL);
-#endif
-        _exit(1);
-    }
-    if (dbus_pid > 0)
-        waitpid(dbus_pid, NULL, 0);
-
-    // Start the systemd user session target after environment is imported
-    if (fork() == 0) {
-        execlp("systemctl", "systemctl", "--user", "start", "swl-session.target", NULL);
-        _exit(1);
-    }
-
-    if (comp->startup_cmd) {
-        if (fork() == 0) {
-            setsid();
-            execl("/bin/sh", "/bin/sh", "-c", comp->startup_cmd, NULL);
-            _exit(1);
-        }
-    }
+    // Environment import, session target and startup command run in order
+    // from the event loop, so a slow D-Bus doesn't delay the first frame
+    swl_startup_begin(comp->startup);
 
     comp->running = true;
     wl_display_run(comp->display);
@@ -442,13 +453,10 @@ void swl_compositor_quit(SwlCompositor *comp)
         return;
 
     // Stop the systemd user session target
-    if (fork() == 0) {
-        execlp("systemctl", "systemctl", "--user", "stop", "swl-session.target", NULL);
-        _exit(1);
-    }
+    char *stop_argv[] = { "systemctl", "--user", "stop", "swl-session.target", NULL };
+    swl_process_spawn(comp->processes, stop_argv, false);
 
     comp->running = false;
-    swl_signal_request_quit();
     wl_display_terminate(comp->display);
 }
 
@@ -556,3 +564,25 @@ SwlSessionLock *swl_compositor_get_session_lock(SwlCompositor *comp)
 {
     return comp ? comp->session_lock : NULL;
 }
+
+SwlProcessTable *swl_compositor_get_processes(SwlCompositor *comp)
+{
+    return comp ? comp->processes : NULL;
+}
+
+const SwlStartupProfile *swl_compositor_get_startup_profile(SwlCompositor *comp)
+{
+    return comp ? &comp->profile : NULL;
+}
+
+void swl_compositor_note_first_frame(SwlCompositor *comp)
+{
+    if (!comp || !swl_profile_first_frame(&comp->profile, swl_profile_now()))
+        return;
+
+    if (swl_config_get_bool(comp->config, "general.startup_profile", false)) {
+        char buf[4096];
+        swl_profile_format(&comp->profile, buf, sizeof(buf));
+        fprintf(stderr, "swl: startup profile\n%s", buf);
+    }
+}
@@ -0,0 +1,66 @@
+#include "latency.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define EVENT_MAX_AGE_MS 1000  // Older timestamps come from another clock
+
+void swl_latency_reset(SwlLatencyStats *stats)
+{
+    if (stats)
+        memset(stats, 0, sizeof(*stats));
+}
+
+void swl_latency_add(SwlLatencyStats *stats, int64_t ns)
+{
+    if (!stats || ns < 0)
+        return;
+
+    stats->samples[stats->next] = ns;
+    stats->next = (stats->next + 1) % SWL_LATENCY_WINDOW;
+    if (stats->count < SWL_LATENCY_WINDOW)
+        stats->count++;
+    stats->total++;
+}
+
+static int compare_ns(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a;
+    int64_t y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of a sorted array
+static int64_t percentile(const int64_t *sorted, size_t n, int pct)
+{
+    size_t rank = (n * (size_t)pct + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+SwlLatencySummary swl_latency_summary(const SwlLatencyStats *stats)
+{
+    SwlLatencySummary sum = {0};
+    if (!stats || stats->count == 0)
+        return sum;
+
+    int64_t sorted[SWL_LATENCY_WINDOW];
+    memcpy(sorted, stats->samples, stats->count * sizeof(sorted[0]));
+    qsort(sorted, stats->count, sizeof(sorted[0]), compare_ns);
+
+    sum.samples = stats->count;
+    sum.total = stats->total;
+    sum.p50_ns = percentile(sorted, stats->count, 50);
+    sum.p95_ns = percentile(sorted, stats->count, 95);
+    sum.p99_ns = percentile(sorted, stats->count, 99);
+    return sum;
+}
+
+int64_t swl_latency_event_ns(uint32_t time_msec, int64_t now_ns)
+{
+    uint32_t now_ms = (uint32_t)(now_ns / 1000000);
+    uint32_t age_ms = now_ms - time_msec;  // Wraps correctly
+
+    if (age_ms > EVENT_MAX_AGE_MS)
+        return now_ns;
+
+    return now_ns - (int64_t)age_ms * 1000000;
+}
@@ -0,0 +1,201 @@
+#define _GNU_SOURCE  // POSIX_SPAWN_SETSID, posix_spawn_file_actions_addclosefrom_np
+#include "process.h"
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+typedef struct SwlProcess {
+    pid_t pid;
+    char command[SWL_PROCESS_CMD_MAX];
+} SwlProcess;
+
+struct SwlProcessTable {
+    SwlEventBus *bus;
+    SwlProcess procs[SWL_MAX_PROCESSES];
+    size_t count;
+};
+
+SwlProcessTable *swl_process_table_create(SwlEventBus *bus)
+{
+    SwlProcessTable *table = calloc(1, sizeof(*table));
+    if (!table)
+        return NULL;
+
+    table->bus = bus;
+    return table;
+}
+
+void swl_process_table_destroy(SwlProcessTable *table)
+{
+    free(table);
+}
+
+static SwlProcess *find_process(const SwlProcessTable *table, pid_t pid)
+{
+    for (size_t i = 0; i < table->count; i++) {
+        if (table->procs[i].pid == pid)
+            return (SwlProcess *)&table->procs[i];
+    }
+    return NULL;
+}
+
+SwlError swl_process_track(SwlProcessTable *table, pid_t pid, const char *command)
+{
+    if (!table || pid <= 0)
+        return SWL_ERR_INVALID_ARG;
+
+    if (find_process(table, pid))
+        return SWL_ERR_ALREADY_EXISTS;
+
+    if (table->count >= SWL_MAX_PROCESSES)
+        return SWL_ERR_NOMEM;
+
+    SwlProcess *proc = &table->procs[table->count++];
+    proc->pid = pid;
+    snprintf(proc->command, sizeof(proc->command), "%s", command ? command : "");
+    return SWL_OK;
+}
+
+bool swl_process_is_tracked(const SwlProcessTable *table, pid_t pid)
+{
+    return table && find_process(table, pid) != NULL;
+}
+
+const char *swl_process_get_command(const SwlProcessTable *table, pid_t pid)
+{
+    if (!table)
+        return NULL;
+
+    SwlProcess *proc = find_process(table, pid);
+    return proc ? proc->command : NULL;
+}
+
+size_t swl_process_count(const SwlProcessTable *table)
+{
+    return table ? table->count : 0;
+}
+
+static void report_exit(SwlProcessTable *table, SwlProcess *proc, int status)
+{
+    SwlProcessExit info = {
+        .pid = proc->pid,
+        .exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1,
+        .signal = WIFSIGNALED(status) ? WTERMSIG(status) : 0,
+        .command = proc->command,
+    };
+    swl_event_bus_emit_simple(table->bus, SWL_EVENT_PROCESS_EXIT, &info);
+}
+
+size_t swl_process_reap(SwlProcessTable *table)
+{
+    size_t reaped = 0;
+    int status;
+    pid_t pid;
+
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        reaped++;
+        if (!table)
+            continue;
+
+        SwlProcess *proc = find_process(table, pid);
+        if (!proc)
+            continue;
+
+        report_exit(table, proc, status);
+
+        // Swap-remove; order of the table is not meaningful
+        *proc = table->procs[--table->count];
+    }
+
+    return reaped;
+}
+
+// Undo what the compositor did to its own signal state (blocked for the
+// event loop's signalfd, SIGPIPE ignored) so the new program starts with
+// defaults
+static void init_spawn_attr(posix_spawnattr_t *attr, bool new_session)
+{
+    sigset_t mask, defaults;
+    sigemptyset(&mask);
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    sigaddset(&defaults, SIGCHLD);
+    sigaddset(&defaults, SIGINT);
+    sigaddset(&defaults, SIGTERM);
+
+    short flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+    if (new_session) {
+#ifdef POSIX_SPAWN_SETSID
+        flags |= POSIX_SPAWN_SETSID;
+#else
+        flags |= POSIX_SPAWN_SETPGROUP;
+        posix_spawnattr_setpgroup(attr, 0);
+#endif
+    }
+
+    posix_spawnattr_setsigmask(attr, &mask);
+    posix_spawnattr_setsigdefault(attr, &defaults);
+    posix_spawnattr_setflags(attr, flags);
+}
+
+// Our descriptors are close-on-exec, this also catches ones opened by
+// libraries that forgot to set it
+static void init_file_actions(posix_spawn_file_actions_t *actions)
+{
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 34)
+    posix_spawn_file_actions_addclosefrom_np(actions, STDERR_FILENO + 1);
+#endif
+#endif
+    (void)actions;
+}
+
+pid_t swl_process_spawn(SwlProcessTable *table, char *const argv[], bool new_session)
+{
+    if (!argv || !argv[0])
+        return -1;
+
+    posix_spawnattr_t attr;
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_init(&attr);
+    posix_spawn_file_actions_init(&actions);
+    init_spawn_attr(&attr, new_session);
+    init_file_actions(&actions);
+
+    // posix_spawn uses CLONE_VFORK, so unlike fork() the cost does not grow
+    // with the compositor's GPU and scene mappings. environ is read here so
+    // variables set after startup (WAYLAND_DISPLAY, DISPLAY) are inherited.
+    pid_t pid;
+    int err = posix_spawnp(&pid, argv[0], &actions, &attr, argv, environ);
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+
+    if (err != 0) {
+        fprintf(stderr, "process: failed to spawn %s: %s\n", argv[0], strerror(err));
+        return -1;
+    }
+
+    if (table && swl_process_track(table, pid, argv[0]) != SWL_OK)
+        fprintf(stderr, "process: not tracking pid %d (%s)\n", (int)pid, argv[0]);
+
+    return pid;
+}
+
+pid_t swl_process_spawn_shell(SwlProcessTable *table, const char *command)
+{
+    if (!command || command[0] == '\0')
+        return -1;
+
+    char *argv[] = { "/bin/sh", "-c", (char *)command, NULL };
+    pid_t pid = swl_process_spawn(NULL, argv, true);
+
+    if (pid > 0 && table && swl_process_track(table, pid, command) != SWL_OK)
+        fprintf(stderr, "process: not tracking pid %d (%s)\n", (int)pid, command);
+
+    return pid;
+}
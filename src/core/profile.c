@@ -0,0 +1,88 @@
+#define _POSIX_C_SOURCE 200809L
+#include "profile.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+int64_t swl_profile_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void swl_profile_begin(SwlStartupProfile *profile, int64_t now_ns)
+{
+    if (!profile)
+        return;
+
+    memset(profile, 0, sizeof(*profile));
+    profile->origin_ns = now_ns;
+    profile->mark_ns = now_ns;
+}
+
+void swl_profile_mark(SwlStartupProfile *profile, const char *name, int64_t now_ns)
+{
+    if (!profile || !name)
+        return;
+
+    // Keep the timeline continuous even if the table is full
+    if (profile->count < SWL_PROFILE_MAX_PHASES) {
+        SwlProfilePhase *phase = &profile->phases[profile->count++];
+        phase->name = name;
+        phase->start_ns = profile->mark_ns - profile->origin_ns;
+        phase->duration_ns = now_ns - profile->mark_ns;
+    }
+    profile->mark_ns = now_ns;
+}
+
+bool swl_profile_first_frame(SwlStartupProfile *profile, int64_t now_ns)
+{
+    if (!profile || profile->first_frame_ns > 0)
+        return false;
+
+    profile->first_frame_ns = now_ns - profile->origin_ns;
+    if (profile->first_frame_ns <= 0)
+        profile->first_frame_ns = 1;
+    return true;
+}
+
+int64_t swl_profile_total(const SwlStartupProfile *profile)
+{
+    return profile ? profile->mark_ns - profile->origin_ns : 0;
+}
+
+int swl_profile_format(const SwlStartupProfile *profile, char *buf, size_t size)
+{
+    if (!profile || !buf || size == 0)
+        return 0;
+
+    size_t offset = 0;
+    int n;
+    for (size_t i = 0; i < profile->count; i++) {
+        const SwlProfilePhase *phase = &profile->phases[i];
+        n = snprintf(buf + offset, size - offset, "  %-24s %8.2f ms\n",
+                     phase->name, (double)phase->duration_ns / 1e6);
+        if (n < 0)
+            return n;
+        offset += (size_t)n;
+        if (offset >= size)
+            return (int)offset;
+    }
+
+    n = snprintf(buf + offset, size - offset, "  %-24s %8.2f ms\n",
+                 "total", (double)swl_profile_total(profile) / 1e6);
+    if (n < 0)
+        return n;
+    offset += (size_t)n;
+    if (offset >= size)
+        return (int)offset;
+
+    if (profile->first_frame_ns > 0)
+        n = snprintf(buf + offset, size - offset, "  %-24s %8.2f ms\n",
+                     "first frame", (double)profile->first_frame_ns / 1e6);
+    else
+        n = snprintf(buf + offset, size - offset, "  %-24s %8s\n",
+                     "first frame", "pending");
+    return n < 0 ? n : (int)(offset + (size_t)n);
+}
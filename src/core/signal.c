@@ -1,47 +1,57 @@
 #define _POSIX_C_SOURCE 200809L
+#include "compositor.h"
+#include "process.h"
 #include <signal.h>
-#include <stdlib.h>
-#include <sys/wait.h>
-#include <unistd.h>
+#include <stdio.h>
+#include <wayland-server-core.h>
 
-static volatile sig_atomic_t should_quit = 0;
+// SIGCHLD, SIGINT and SIGTERM are delivered through the event loop (libwayland
+// blocks them and reads a signalfd), so their handlers run between dispatches
+// like any other event instead of interrupting the compositor.
 
-static void handle_signal(int sig)
+static struct wl_event_source *sigchld_source;
+static struct wl_event_source *sigint_source;
+static struct wl_event_source *sigterm_source;
+
+static int handle_sigchld(int signal_number, void *data)
 {
-    switch (sig) {
-    case SIGCHLD:
-        while (waitpid(-1, NULL, WNOHANG) > 0)
-            ;
-        break;
-    case SIGINT:
-    case SIGTERM:
-        should_quit = 1;
-        break;
-    case SIGPIPE:
-        break;
-    }
+    (void)signal_number;
+    SwlCompositor *comp = data;
+    swl_process_reap(swl_compositor_get_processes(comp));
+    return 0;
 }
 
-void swl_signal_init(void)
+static int handle_quit_signal(int signal_number, void *data)
 {
-    struct sigaction sa = {
-        .sa_handler = handle_signal,
-        .sa_flags = SA_RESTART,
-    };
-    sigemptyset(&sa.sa_mask);
-
-    sigaction(SIGCHLD, &sa, NULL);
-    sigaction(SIGINT, &sa, NULL);
-    sigaction(SIGTERM, &sa, NULL);
-    sigaction(SIGPIPE, &sa, NULL);
+    SwlCompositor *comp = data;
+    fprintf(stderr, "swl: received signal %d, exiting\n", signal_number);
+    swl_compositor_quit(comp);
+    return 0;
 }
 
-int swl_signal_should_quit(void)
+void swl_signal_init(SwlCompositor *comp, struct wl_event_loop *loop)
 {
-    return should_quit;
+    // Writes to disconnected IPC clients must fail with EPIPE, not kill us
+    signal(SIGPIPE, SIG_IGN);
+
+    sigchld_source = wl_event_loop_add_signal(loop, SIGCHLD, handle_sigchld, comp);
+    sigint_source = wl_event_loop_add_signal(loop, SIGINT, handle_quit_signal, comp);
+    sigterm_source = wl_event_loop_add_signal(loop, SIGTERM, handle_quit_signal, comp);
+
+    if (!sigchld_source || !sigint_source || !sigterm_source)
+        fprintf(stderr, "swl: failed to add signal sources to the event loop\n");
+
+    // Children that exited before the loop existed
+    swl_process_reap(swl_compositor_get_processes(comp));
 }
 
-void swl_signal_request_quit(void)
+void swl_signal_finish(void)
 {
-    should_quit = 1;
+    if (sigchld_source)
+        wl_event_source_remove(sigchld_source);
+    if (sigint_source)
+        wl_event_source_remove(sigint_source);
+    if (sigterm_source)
+        wl_event_source_remove(sigterm_source);
+    sigchld_source = sigint_source = sigterm_source = NULL;
 }
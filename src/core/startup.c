@@ -0,0 +1,166 @@
+#define _POSIX_C_SOURCE 200809L
+#include "startup.h"
+#include "compositor.h"
+#include "config.h"
+#include "events.h"
+#include "process.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wayland-server-core.h>
+
+#define DEFAULT_STEP_TIMEOUT_MS 5000
+
+typedef enum {
+    STEP_IDLE,
+    STEP_ENV_IMPORT,
+    STEP_SESSION_TARGET,
+    STEP_STARTUP_CMD,
+    STEP_DONE,
+} StartupStep;
+
+static const char *step_names[] = {
+    [STEP_IDLE] = "idle",
+    [STEP_ENV_IMPORT] = "dbus-update-activation-environment",
+    [STEP_SESSION_TARGET] = "swl-session.target",
+    [STEP_STARTUP_CMD] = "startup command",
+    [STEP_DONE] = "done",
+};
+
+struct SwlStartup {
+    SwlCompositor *comp;
+    char *startup_cmd;
+    StartupStep step;
+    pid_t pid;  // Child the current step waits for, 0 if none
+    int timeout_ms;
+    int exit_sub;
+    struct wl_event_source *timer;
+};
+
+// Returns the child to wait for, or 0 to move straight on
+static pid_t run_step(SwlStartup *startup)
+{
+    SwlProcessTable *procs = swl_compositor_get_processes(startup->comp);
+
+    switch (startup->step) {
+    case STEP_ENV_IMPORT: {
+        // Services started by the target (waybar etc.) need WAYLAND_DISPLAY
+        char *argv[] = {
+            "dbus-update-activation-environment", "--systemd",
+            "WAYLAND_DISPLAY", "XDG_CURRENT_DESKTOP", "PATH", "SWL_SOCKET",
+#ifdef SWL_XWAYLAND
+            "DISPLAY",
+#endif
+            NULL,
+        };
+        return swl_process_spawn(procs, argv, false);
+    }
+    case STEP_SESSION_TARGET: {
+        char *argv[] = { "systemctl", "--user", "start", "swl-session.target", NULL };
+        return swl_process_spawn(procs, argv, false);
+    }
+    case STEP_STARTUP_CMD:
+        // Usually long-running, nothing waits on it
+        if (startup->startup_cmd)
+            swl_process_spawn_shell(procs, startup->startup_cmd);
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+static void advance(SwlStartup *startup)
+{
+    while (startup->step != STEP_DONE) {
+        startup->step++;
+        startup->pid = run_step(startup);
+        if (startup->pid > 0)
+            break;
+    }
+
+    if (startup->timer)
+        wl_event_source_timer_update(startup->timer,
+                                     startup->pid > 0 ? startup->timeout_ms : 0);
+}
+
+static void handle_process_exit(void *ctx, const SwlEvent *event)
+{
+    SwlStartup *startup = ctx;
+    const SwlProcessExit *info = event->data;
+    if (!info || startup->pid <= 0 || info->pid != startup->pid)
+        return;
+
+    if (info->exit_code != 0)
+        fprintf(stderr, "startup: %s failed (exit %d, signal %d)\n",
+                step_names[startup->step], info->exit_code, info->signal);
+
+    advance(startup);
+}
+
+static int handle_timeout(void *data)
+{
+    SwlStartup *startup = data;
+    if (startup->pid <= 0)
+        return 0;
+
+    // Leave it running, but don't hold the rest of the session hostage
+    fprintf(stderr, "startup: %s did not finish within %d ms, continuing\n",
+            step_names[startup->step], startup->timeout_ms);
+    advance(startup);
+    return 0;
+}
+
+SwlStartup *swl_startup_create(SwlCompositor *comp, const char *startup_cmd)
+{
+    SwlStartup *startup = calloc(1, sizeof(*startup));
+    if (!startup)
+        return NULL;
+
+    startup->comp = comp;
+    startup->step = STEP_IDLE;
+    startup->exit_sub = -1;
+    if (startup_cmd)
+        startup->startup_cmd = strdup(startup_cmd);
+
+    SwlConfig *cfg = swl_compositor_get_config(comp);
+    startup->timeout_ms = swl_config_get_int(cfg, "general.startup_timeout",
+                                             DEFAULT_STEP_TIMEOUT_MS);
+    if (startup->timeout_ms <= 0)
+        startup->timeout_ms = DEFAULT_STEP_TIMEOUT_MS;
+
+    struct wl_display *display = swl_compositor_get_wl_display(comp);
+    startup->timer = wl_event_loop_add_timer(wl_display_get_event_loop(display),
+                                             handle_timeout, startup);
+
+    startup->exit_sub = swl_event_bus_subscribe(swl_compositor_get_event_bus(comp),
+        SWL_EVENT_PROCESS_EXIT, handle_process_exit, startup);
+
+    return startup;
+}
+
+void swl_startup_destroy(SwlStartup *startup)
+{
+    if (!startup)
+        return;
+
+    if (startup->exit_sub >= 0)
+        swl_event_bus_unsubscribe(swl_compositor_get_event_bus(startup->comp),
+                                  startup->exit_sub);
+    if (startup->timer)
+        wl_event_source_remove(startup->timer);
+    free(startup->startup_cmd);
+    free(startup);
+}
+
+void swl_startup_begin(SwlStartup *startup)
+{
+    if (!startup || startup->step != STEP_IDLE)
+        return;
+
+    advance(startup);
+}
+
+bool swl_startup_is_done(const SwlStartup *startup)
+{
+    return !startup || startup->step == STEP_DONE;
+}
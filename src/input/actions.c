@@ -0,0 +1,654 @@
+#define _POSIX_C_SOURCE 200809L
+#include "keybindings.h"
+#include "compositor.h"
+#include "client.h"
+#include "config.h"
+#include "events.h"
+#include "input.h"
+#include "layout.h"
+#include "monitor.h"
+#include "process.h"
+#include "render.h"
+#include <ctype.h>
+#include <linux/input-event-codes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <wlr/backend/session.h>
+#include <wlr/types/wlr_keyboard.h>
+#include <xkbcommon/xkbcommon.h>
+
+static void action_quit(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    (void)arg;
+    swl_compositor_quit(comp);
+}
+
+static void action_spawn(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    swl_process_spawn_shell(swl_compositor_get_processes(comp), arg->str);
+}
+
+static void action_close(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    (void)arg;
+    SwlClientManager *clients = swl_compositor_get_clients(comp);
+    SwlClient *focused = swl_client_focused(clients);
+    if (focused)
+        swl_client_close(focused);
+}
+
+static bool focus_first_client(SwlClient *client, void *data)
+{
+    SwlClient **first = data;
+    if (!*first) {
+        *first = client;
+        return false;  // Stop iteration
+    }
+    return true;
+}
+
+static void action_focus_next(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    (void)arg;
+    SwlClientManager *clients = swl_compositor_get_clients(comp);
+    SwlClient *focused = swl_client_focused(clients);
+
+    if (!focused) {
+        SwlOutputManager *output = swl_compositor_get_output(comp);
+        SwlMonitor *mon = swl_monitor_get_focused(output);
+        SwlClient *first = NULL;
+        swl_client_foreach_visible(clients, mon, focus_first_client, &first);
+        if (first)
+            swl_client_focus(first);
+        return;
+    }
+
+    // TODO: implement proper focus cycling
+}
+
+static void action_focus_prev(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    (void)arg;
+    (void)comp;
+    // TODO: implement
+}
+
+static void action_toggle_floating(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    (void)arg;
+    SwlClientManager *clients = swl_compositor_get_clients(comp);
+    SwlClient *focused = swl_client_focused(clients);
+    if (focused)
+        swl_client_toggle_floating(focused);
+}
+
+static void action_toggle_fullscreen(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    (void)arg;
+    SwlClientManager *clients = swl_compositor_get_clients(comp);
+    SwlClient *focused = swl_client_focused(clients);
+    if (focused)
+        swl_client_toggle_fullscreen(focused);
+}
+
+static void action_set_layout(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    SwlOutputManager *output = swl_compositor_get_output(comp);
+    SwlMonitor *mon = swl_monitor_get_focused(output);
+    if (mon) {
+        swl_monitor_set_layout(mon, arg->layout);
+        swl_monitor_arrange(mon);
+    }
+}
+
+static void action_focus_monitor(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    SwlOutputManager *output = swl_compositor_get_output(comp);
+    SwlMonitor *mon = swl_monitor_get_focused(output);
+    if (!mon)
+        return;
+
+    SwlMonitor *next = swl_monitor_in_direction(output, mon, arg->i);
+    if (!next)
+        return;
+
+    swl_monitor_focus(next);
+
+    SwlClientManager *clients = swl_compositor_get_clients(comp);
+    SwlClient *c = swl_client_focus_top_on_monitor(clients, next);
+    if (c)
+        swl_client_focus(c);
+}
+
+static void action_send_monitor(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    SwlClientManager *clients = swl_compositor_get_clients(comp);
+    SwlClient *focused = swl_client_focused(clients);
+    if (!focused)
+        return;
+
+    SwlOutputManager *output = swl_compositor_get_output(comp);
+    SwlMonitor *mon = swl_client_get_monitor(focused);
+    if (!mon)
+        mon = swl_monitor_get_focused(output);
+    if (!mon)
+        return;
+
+    SwlMonitor *next = swl_monitor_in_direction(output, mon, arg->i);
+    if (next)
+        swl_client_move_to_monitor(focused, next);
+}
+
+static void action_reload_config(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    (void)arg;
+    SwlConfig *config = swl_compositor_get_config(comp);
+    if (!config || swl_config_reload(config) != SWL_OK)
+        return;
+
+    // Reload renderer settings (borders, colors, blur, shadows, opacity)
+    SwlRenderer *renderer = swl_compositor_get_renderer(comp);
+    if (renderer) {
+        swl_renderer_reload_config(renderer);
+        swl_renderer_damage_whole(renderer);
+    }
+
+    // Reload input settings (keyboard, pointer) and re-apply to devices
+    SwlInput *input = swl_compositor_get_input(comp);
+    if (input) {
+        swl_input_reload_config(input);
+
+        // Reload keybindings and button bindings
+        SwlKeybindingManager *kb = swl_input_get_keybindings(input);
+        if (kb)
+            swl_keybinding_reload(kb);
+    }
+
+    // Reload window rules
+    SwlClientManager *clients = swl_compositor_get_clients(comp);
+    if (clients)
+        swl_client_manager_load_rules(clients);
+
+    // Re-apply monitor rules and re-arrange
+    SwlOutputManager *output = swl_compositor_get_output(comp);
+    if (output)
+        swl_monitor_reload_config(output);
+
+    SwlEventBus *bus = swl_compositor_get_event_bus(comp);
+    swl_event_bus_emit_simple(bus, SWL_EVENT_CONFIG_RELOAD, NULL);
+}
+
+static void action_zoom(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    (void)arg;
+    SwlClientManager *clients = swl_compositor_get_clients(comp);
+    swl_client_zoom(clients);
+}
+
+static void action_focusdir(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    SwlClientManager *clients = swl_compositor_get_clients(comp);
+    SwlClient *focused = swl_client_focused(clients);
+    if (!focused)
+        return;
+
+    SwlClient *next = swl_client_in_direction(clients, focused, arg->i);
+    if (next)
+        swl_client_focus(next);
+}
+
+static void action_moveresize(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    SwlInput *input = swl_compositor_get_input(comp);
+    if (!input)
+        return;
+
+    if (arg->i == SWL_MOVERESIZE_MOVE)
+        swl_input_start_move(input);
+    else
+        swl_input_start_resize(input);
+}
+
+static void action_cycle_ratio(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    SwlClientManager *clients = swl_compositor_get_clients(comp);
+    SwlClient *focused = swl_client_focused(clients);
+    if (!focused)
+        return;
+
+    const float *ratios = arg->floats;
+    int count = arg->float_count;
+
+    // Get the client's current ratio; 0.0 means "default"
+    float current = swl_client_get_scroller_ratio(focused);
+
+    // Get the monitor's default scroller_ratio for matching 0.0
+    SwlMonitor *mon = swl_client_get_monitor(focused);
+    if (!mon) {
+        SwlOutputManager *output = swl_compositor_get_output(comp);
+        mon = swl_monitor_get_focused(output);
+    }
+    float default_ratio = mon ? swl_monitor_get_scroller_ratio(mon) : 0.8f;
+    float effective = (current > 0.0f) ? current : default_ratio;
+
+    // Find the closest match in the list
+    int best = 0;
+    float best_diff = 2.0f;
+    for (int i = 0; i < count; i++) {
+        float diff = (ratios[i] - effective > 0) ? (ratios[i] - effective) : (effective - ratios[i]);
+        if (diff < best_diff) {
+            best_diff = diff;
+            best = i;
+        }
+    }
+
+    // Advance to next (wrap)
+    int next = (best + 1) % count;
+    swl_client_set_scroller_ratio(focused, ratios[next]);
+
+    // Re-arrange the monitor
+    if (mon)
+        swl_monitor_arrange(mon);
+}
+
+static void action_consume_or_expel(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    SwlClientManager *clients = swl_compositor_get_clients(comp);
+    SwlClient *focused = swl_client_focused(clients);
+    if (!focused)
+        return;
+
+    SwlClientInfo info = swl_client_get_info(focused);
+    if (info.floating || info.fullscreen)
+        return;
+
+    // Only meaningful in scroller layout
+    SwlMonitor *mon = swl_client_get_monitor(focused);
+    if (!mon) {
+        SwlOutputManager *output = swl_compositor_get_output(comp);
+        mon = swl_monitor_get_focused(output);
+    }
+    if (!mon)
+        return;
+
+    const SwlLayout *layout = swl_monitor_get_layout(mon);
+    if (!layout || !layout->name || strcmp(layout->name, "scroller") != 0)
+        return;
+
+    swl_client_consume_or_expel(clients, focused, arg->i);
+}
+
+static void action_chvt(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    struct wlr_session *session = swl_compositor_get_session(comp);
+    if (session)
+        wlr_session_change_vt(session, arg->i);
+}
+
+// Parse modifier string like "mod+shift+ctrl" and return modifier mask
+static uint32_t parse_modifiers(const char *str, uint32_t modkey)
+{
+    if (!str) return 0;
+
+    uint32_t mods = 0;
+    char *copy = strdup(str);
+    if (!copy) return 0;
+
+    char *token = strtok(copy, "+");
+    while (token) {
+        // Trim whitespace
+        while (*token && isspace(*token)) token++;
+        char *end = token + strlen(token) - 1;
+        while (end > token && isspace(*end)) *end-- = '\0';
+
+        // Convert to lowercase
+        for (char *p = token; *p; p++) *p = tolower(*p);
+
+        if (strcmp(token, "mod") == 0) {
+            mods |= modkey;
+        } else if (strcmp(token, "super") == 0 || strcmp(token, "logo") == 0 ||
+                   strcmp(token, "mod4") == 0 || strcmp(token, "win") == 0) {
+            mods |= WLR_MODIFIER_LOGO;
+        } else if (strcmp(token, "shift") == 0) {
+            mods |= WLR_MODIFIER_SHIFT;
+        } else if (strcmp(token, "ctrl") == 0 || strcmp(token, "control") == 0) {
+            mods |= WLR_MODIFIER_CTRL;
+        } else if (strcmp(token, "alt") == 0 || strcmp(token, "mod1") == 0) {
+            mods |= WLR_MODIFIER_ALT;
+        }
+        // Unrecognized tokens are assumed to be the key name
+
+        token = strtok(NULL, "+");
+    }
+
+    free(copy);
+    return mods;
+}
+
+// Extract the key name from a binding string like "mod+shift+Return"
+static const char *extract_keyname(const char *str)
+{
+    if (!str) return NULL;
+
+    // Find the last '+' - everything after is the key name
+    const char *last_plus = strrchr(str, '+');
+    if (last_plus)
+        return last_plus + 1;
+    return str;
+}
+
+// Parse a keysym from a string
+static xkb_keysym_t parse_keysym(const char *str)
+{
+    if (!str) return XKB_KEY_NoSymbol;
+
+    // Try XKB lookup
+    xkb_keysym_t sym = xkb_keysym_from_name(str, XKB_KEYSYM_CASE_INSENSITIVE);
+    if (sym != XKB_KEY_NoSymbol) return sym;
+
+    // Handle common aliases
+    if (strcasecmp(str, "enter") == 0) return XKB_KEY_Return;
+    if (strcasecmp(str, "esc") == 0) return XKB_KEY_Escape;
+    if (strcasecmp(str, "del") == 0) return XKB_KEY_Delete;
+    if (strcasecmp(str, "backspace") == 0) return XKB_KEY_BackSpace;
+
+    return XKB_KEY_NoSymbol;
+}
+
+// Parse a button name
+static uint32_t parse_button(const char *str)
+{
+    if (!str) return 0;
+
+    if (strcasecmp(str, "left") == 0) return BTN_LEFT;
+    if (strcasecmp(str, "middle") == 0) return BTN_MIDDLE;
+    if (strcasecmp(str, "right") == 0) return BTN_RIGHT;
+    if (strcasecmp(str, "side") == 0) return BTN_SIDE;
+    if (strcasecmp(str, "extra") == 0) return BTN_EXTRA;
+
+    return 0;
+}
+
+// Add one binding from config
+// Format: "mod+key" = "action" or "action:argument"
+static void add_config_keybinding(SwlKeybindingManager *mgr, const char *binding_key,
+                                  const char *value, const char *mode, uint32_t modkey)
+{
+    // Parse action and argument from value
+    char *action = strdup(value);
+    if (!action)
+        return;
+
+    char *arg_str = NULL;
+    char *colon = strchr(action, ':');
+    if (colon) {
+        *colon = '\0';
+        arg_str = colon + 1;
+    }
+
+    // Parse modifiers and keysym
+    uint32_t mods = parse_modifiers(binding_key, modkey);
+    const char *keyname = extract_keyname(binding_key);
+    xkb_keysym_t keysym = parse_keysym(keyname);
+
+    if (keysym != XKB_KEY_NoSymbol) {
+        SwlKeybinding binding = {
+            .modifiers = mods,
+            .keysym = keysym,
+            .action = action,
+            .argument = arg_str,
+            .mode = mode,
+        };
+        SwlError err = swl_keybinding_add(mgr, &binding);
+        if (err != SWL_OK)
+            fprintf(stderr, "keybindings: %s: cannot bind %s%s%s (%s)\n", binding_key, action,
+                    arg_str ? ":" : "", arg_str ? arg_str : "", swl_error_string(err));
+    } else {
+        fprintf(stderr, "keybindings: %s: unknown key\n", binding_key);
+    }
+    free(action);
+}
+
+// Load keybindings from config
+// Format: keybindings."mod+key" = "action" or "action:argument"
+// Modes: modes.<name>."key" = "action:argument", entered with "mode:<name>"
+static void load_keybindings_from_config(SwlKeybindingManager *mgr)
+{
+    SwlConfig *cfg = swl_compositor_get_config(swl_keybinding_get_compositor(mgr));
+    if (!cfg)
+        return;
+
+    // Get modkey setting
+    const char *modkey_str = swl_config_get_string(cfg, "general.modkey", "alt");
+    uint32_t modkey = WLR_MODIFIER_ALT;
+    if (strcasecmp(modkey_str, "super") == 0 || strcasecmp(modkey_str, "logo") == 0)
+        modkey = WLR_MODIFIER_LOGO;
+    else if (strcasecmp(modkey_str, "ctrl") == 0)
+        modkey = WLR_MODIFIER_CTRL;
+
+    // Get all keybinding keys
+    size_t count = 0;
+    const char **keys = swl_config_keys(cfg, "keybindings.", &count);
+    if (keys) {
+        for (size_t i = 0; i < count; i++) {
+            // Extract binding key from config key (e.g., "mod+p" from "keybindings.mod+p")
+            const char *binding_key = keys[i] + strlen("keybindings.");
+            const char *value = swl_config_get_string(cfg, keys[i], NULL);
+            if (value)
+                add_config_keybinding(mgr, binding_key, value, NULL, modkey);
+        }
+        swl_config_keys_free(keys, count);
+    }
+
+    keys = swl_config_keys(cfg, "modes.", &count);
+    if (!keys)
+        return;
+
+    for (size_t i = 0; i < count; i++) {
+        // "modes.resize.Left" -> mode "resize", binding "Left"
+        const char *mode_name = keys[i] + strlen("modes.");
+        const char *dot = strchr(mode_name, '.');
+        const char *value = swl_config_get_string(cfg, keys[i], NULL);
+        if (!dot || dot == mode_name || !value)
+            continue;
+
+        char *mode = strndup(mode_name, (size_t)(dot - mode_name));
+        if (!mode)
+            continue;
+        add_config_keybinding(mgr, dot + 1, value, mode, modkey);
+        free(mode);
+    }
+
+    swl_config_keys_free(keys, count);
+}
+
+// Load button bindings from config
+// Format: buttons."mod+button" = "action" or "action:argument"
+static void load_buttons_from_config(SwlKeybindingManager *mgr)
+{
+    SwlConfig *cfg = swl_compositor_get_config(swl_keybinding_get_compositor(mgr));
+    if (!cfg)
+        return;
+
+    // Get modkey setting
+    const char *modkey_str = swl_config_get_string(cfg, "general.modkey", "alt");
+    uint32_t modkey = WLR_MODIFIER_ALT;
+    if (strcasecmp(modkey_str, "super") == 0 || strcasecmp(modkey_str, "logo") == 0)
+        modkey = WLR_MODIFIER_LOGO;
+    else if (strcasecmp(modkey_str, "ctrl") == 0)
+        modkey = WLR_MODIFIER_CTRL;
+
+    // Get all button binding keys
+    size_t count = 0;
+    const char **keys = swl_config_keys(cfg, "buttons.", &count);
+    if (!keys || count == 0)
+        return;
+
+    for (size_t i = 0; i < count; i++) {
+        const char *key = keys[i];
+
+        const char *binding_key = key + strlen("buttons.");
+
+        const char *value = swl_config_get_string(cfg, key, NULL);
+        if (!value)
+            continue;
+
+        char *action = strdup(value);
+        if (!action)
+            continue;
+
+        char *arg_str = NULL;
+        char *colon = strchr(action, ':');
+        if (colon) {
+            *colon = '\0';
+            arg_str = colon + 1;
+        }
+
+        uint32_t mods = parse_modifiers(binding_key, modkey);
+        const char *buttonname = extract_keyname(binding_key);
+        uint32_t button = parse_button(buttonname);
+
+        if (button != 0) {
+            SwlButtonBinding binding = {
+                .modifiers = mods,
+                .button = button,
+                .action = action,
+                .argument = arg_str,
+            };
+            SwlError err = swl_button_binding_add(mgr, &binding);
+            if (err != SWL_OK)
+                fprintf(stderr, "buttons: %s: cannot bind %s%s%s (%s)\n", binding_key, action,
+                        arg_str ? ":" : "", arg_str ? arg_str : "", swl_error_string(err));
+        } else {
+            fprintf(stderr, "buttons: %s: unknown button\n", binding_key);
+        }
+        free(action);
+    }
+
+    swl_config_keys_free(keys, count);
+}
+
+void swl_keybinding_reload(SwlKeybindingManager *mgr)
+{
+    if (!mgr)
+        return;
+
+    swl_keybinding_clear(mgr);
+    swl_button_binding_clear(mgr);
+    load_keybindings_from_config(mgr);
+    load_buttons_from_config(mgr);
+    swl_keybinding_compile(mgr);
+}
+
+void swl_action_register_builtins(SwlKeybindingManager *mgr)
+{
+    // Register all action handlers
+    swl_action_register(mgr, "quit", action_quit, NULL);
+    swl_action_register(mgr, "spawn", action_spawn, swl_action_parse_required);
+    swl_action_register(mgr, "close", action_close, NULL);
+    swl_action_register(mgr, "killclient", action_close, NULL);  // Alias
+    swl_action_register(mgr, "focus-next", action_focus_next, NULL);
+    swl_action_register(mgr, "focus-prev", action_focus_prev, NULL);
+    swl_action_register(mgr, "focusstack", action_focus_next, NULL);  // Alias with direction
+    swl_action_register(mgr, "toggle-floating", action_toggle_floating, NULL);
+    swl_action_register(mgr, "togglefloating", action_toggle_floating, NULL);  // Alias
+    swl_action_register(mgr, "toggle-fullscreen", action_toggle_fullscreen, NULL);
+    swl_action_register(mgr, "togglefullscreen", action_toggle_fullscreen, NULL);  // Alias
+    swl_action_register(mgr, "setlayout", action_set_layout, swl_action_parse_layout);
+    swl_action_register(mgr, "set-layout", action_set_layout, swl_action_parse_layout);
+    swl_action_register(mgr, "focus-monitor", action_focus_monitor, swl_action_parse_monitor_direction);
+    swl_action_register(mgr, "focusmon", action_focus_monitor, swl_action_parse_monitor_direction);  // Alias
+    swl_action_register(mgr, "send-monitor", action_send_monitor, swl_action_parse_monitor_direction);
+    swl_action_register(mgr, "sendmon", action_send_monitor, swl_action_parse_monitor_direction);  // Alias
+    swl_action_register(mgr, "tag-monitor", action_send_monitor, swl_action_parse_monitor_direction);  // Compat alias
+    swl_action_register(mgr, "tagmon", action_send_monitor, swl_action_parse_monitor_direction);  // Compat alias
+    swl_action_register(mgr, "reload-config", action_reload_config, NULL);
+    swl_action_register(mgr, "reload_config", action_reload_config, NULL);  // Alias
+    swl_action_register(mgr, "zoom", action_zoom, NULL);
+    swl_action_register(mgr, "focusdir", action_focusdir, swl_action_parse_direction);
+    swl_action_register(mgr, "moveresize", action_moveresize, swl_action_parse_moveresize);
+    swl_action_register(mgr, "cycle-ratio", action_cycle_ratio, swl_action_parse_ratios);
+    swl_action_register(mgr, "consume_or_expel", action_consume_or_expel, swl_action_parse_int_default_one);
+    swl_action_register(mgr, "consume-or-expel", action_consume_or_expel, swl_action_parse_int_default_one);
+    swl_action_register(mgr, "chvt", action_chvt, swl_action_parse_vt);
+
+    // Try to load keybindings from config
+    SwlConfig *cfg = swl_compositor_get_config(swl_keybinding_get_compositor(mgr));
+    bool has_config_keybindings = false;
+
+    if (cfg) {
+        size_t count = 0;
+        const char **keys = swl_config_keys(cfg, "keybindings.", &count);
+        if (keys && count > 0) {
+            has_config_keybindings = true;
+            swl_config_keys_free(keys, count);
+        }
+    }
+
+    if (has_config_keybindings) {
+        // Load keybindings from config
+        load_keybindings_from_config(mgr);
+        load_buttons_from_config(mgr);
+        goto hardcoded_chvt;
+    }
+
+    // Default keybindings (Mod = Alt)
+    #define MOD WLR_MODIFIER_ALT
+    #define SHIFT WLR_MODIFIER_SHIFT
+
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD | SHIFT, XKB_KEY_q, "quit", NULL, NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD | SHIFT, XKB_KEY_Return, "spawn", "foot", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_Return, "spawn", "foot", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD | SHIFT, XKB_KEY_c, "close", NULL, NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_j, "focus-next", NULL, NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_k, "focus-prev", NULL, NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_space, "toggle-floating", NULL, NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_f, "toggle-fullscreen", NULL, NULL});
+    // Layout keybindings
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_s, "set-layout", "scroller", NULL});
+
+    // Zoom (swap with master)
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_z, "zoom", NULL, NULL});
+
+    // Monitor focus/move (left = -1, right = 1)
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_comma, "focus-monitor", "-1", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_period, "focus-monitor", "1", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD | SHIFT, XKB_KEY_comma, "send-monitor", "-1", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD | SHIFT, XKB_KEY_period, "send-monitor", "1", NULL});
+
+    // Directional focus (arrow keys)
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_Up, "focusdir", "up", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_Down, "focusdir", "down", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_Left, "focusdir", "left", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_Right, "focusdir", "right", NULL});
+
+    // Default button bindings (Mod+click = move/resize)
+    swl_button_binding_add(mgr, &(SwlButtonBinding){MOD, BTN_LEFT, "moveresize", "move"});
+    swl_button_binding_add(mgr, &(SwlButtonBinding){MOD, BTN_MIDDLE, "toggle-floating", NULL});
+    swl_button_binding_add(mgr, &(SwlButtonBinding){MOD, BTN_RIGHT, "moveresize", "resize"});
+
+    #undef MOD
+    #undef SHIFT
+
+hardcoded_chvt:
+    // Hardcoded VT switching keybindings (Ctrl+Alt+F1-F12)
+    // These are always registered regardless of config
+    #define CHVT_MODS (WLR_MODIFIER_CTRL | WLR_MODIFIER_ALT)
+    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_1, "chvt", "1", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_2, "chvt", "2", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_3, "chvt", "3", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_4, "chvt", "4", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_5, "chvt", "5", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_6, "chvt", "6", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_7, "chvt", "7", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_8, "chvt", "8", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_9, "chvt", "9", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_10, "chvt", "10", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_11, "chvt", "11", NULL});
+    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_12, "chvt", "12", NULL});
+    #undef CHVT_MODS
+
+    swl_keybinding_compile(mgr);
+}
@@ -35,6 +35,10 @@ static void handle_client_focus(void *ctx, const SwlEvent *event)
 {
     SwlInput *input = ctx;
     SwlClient *client = event->data;
+
+    // Locks and confinements end when their surface loses keyboard focus
+    swl_pointer_update_constraint(input);
+
     if (!client)
         return;
 
@@ -80,6 +84,7 @@ SwlInput *swl_input_create(SwlCompositor *comp)
     input->kb_config.xkb_model = swl_config_get_string(cfg, "keyboard.xkb.model", NULL);
     input->kb_config.xkb_variant = swl_config_get_string(cfg, "keyboard.xkb.variant", NULL);
     input->kb_config.xkb_options = swl_config_get_string(cfg, "keyboard.xkb.options", NULL);
+    input->kb_config.xkb_persist_cache = swl_config_get_bool(cfg, "keyboard.xkb.persist_cache", false);
 
     // Load pointer config from config file
     input->ptr_config.tap_to_click = swl_config_get_bool(cfg, "pointer.tap_to_click", true);
@@ -300,6 +305,7 @@ SwlError swl_input_reload_config(SwlInput *input)
     input->kb_config.xkb_model = swl_config_get_string(cfg, "keyboard.xkb.model", NULL);
     input->kb_config.xkb_variant = swl_config_get_string(cfg, "keyboard.xkb.variant", NULL);
     input->kb_config.xkb_options = swl_config_get_string(cfg, "keyboard.xkb.options", NULL);
+    input->kb_config.xkb_persist_cache = swl_config_get_bool(cfg, "keyboard.xkb.persist_cache", false);
 
     configure_keyboard(input, &input->kb_group->keyboard);
     wlr_keyboard_set_repeat_info(&input->kb_group->keyboard,
@@ -378,6 +384,14 @@ SwlError swl_input_warp_cursor(SwlInput *input, double x, double y)
     return SWL_OK;
 }
 
+void swl_input_scene_changed(SwlInput *input)
+{
+    if (!input)
+        return;
+
+    swl_motion_invalidate(&input->motion);
+}
+
 void swl_input_get_cursor_position(SwlInput *input, double *x, double *y)
 {
     if (!input)
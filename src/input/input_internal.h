@@ -3,6 +3,7 @@
 
 #include "input.h"
 #include "keybindings.h"
+#include "motion.h"
 #include <wayland-server-core.h>
 #include <wlr/types/wlr_cursor.h>
 #include <wlr/types/wlr_seat.h>
@@ -12,6 +13,15 @@
 
 typedef struct SwlClient SwlClient;
 
+#define MAX_CACHED_KEYMAPS 4
+
+// Compiled keymap for one set of RMLVO names
+typedef struct {
+    char *key;  // Names joined, see keymap_key()
+    struct xkb_keymap *keymap;
+    uint64_t last_used;
+} SwlKeymapCacheEntry;
+
 enum SwlCursorMode {
     SWL_CURSOR_NORMAL,
     SWL_CURSOR_MOVE,
@@ -52,8 +62,28 @@ struct SwlInput {
     uint32_t locked_mods;
     uint32_t modifiers;
 
+    // Shared by every keymap compile, cache survives config reloads
+    struct xkb_context *xkb_ctx;
+    SwlKeymapCacheEntry keymaps[MAX_CACHED_KEYMAPS];
+    uint64_t keymap_clock;
+
     struct wl_list pointer_devices; // SwlPointerDevice.link
 
+    // Motion coalescing and cached hit-testing
+    SwlMotionState motion;
+    struct wl_event_source *motion_idle;
+    struct wlr_scene_node *hit_node;
+    struct wl_listener hit_destroy;
+    int hit_lx, hit_ly;
+    struct wl_listener new_surface;
+    struct wl_list hit_surfaces; // SwlHitSurface.link
+
+    // Pointer lock/confine and raw relative motion for games
+    struct wlr_relative_pointer_manager_v1 *relative_pointer_mgr;
+    struct wlr_pointer_constraints_v1 *pointer_constraints;
+    struct wlr_pointer_constraint_v1 *active_constraint;
+    struct wl_listener new_constraint;
+
     // Move/resize state
     enum SwlCursorMode cursor_mode;
     SwlClient *grabbed_client;
@@ -75,6 +105,25 @@ struct SwlPointerDevice {
     struct wl_list link;
 };
 
+// Watches a surface for changes that move what the pointer can hit
+struct SwlHitSurface {
+    SwlInput *input;
+    struct wlr_surface *surface;
+    int width, height;
+    struct wl_listener map;
+    struct wl_listener unmap;
+    struct wl_listener commit;
+    struct wl_listener destroy;
+    struct wl_list link;
+};
+
+struct SwlPointerConstraint {
+    SwlInput *input;
+    struct wlr_pointer_constraint_v1 *constraint;
+    struct wl_listener set_region;
+    struct wl_listener destroy;
+};
+
 void swl_pointer_setup(SwlInput *input);
 void swl_pointer_cleanup(SwlInput *input);
 void configure_pointer(SwlInput *input, struct wlr_pointer *ptr);
@@ -91,6 +140,7 @@ void handle_request_set_primary_selection(struct wl_listener *listener, void *da
 void handle_request_start_drag(struct wl_listener *listener, void *data);
 void handle_start_drag(struct wl_listener *listener, void *data);
 SwlClient *client_at_cursor(SwlInput *input);
+void swl_pointer_update_constraint(SwlInput *input);
 
 /* switch.c */
 void swl_switch_setup(SwlInput *input, struct wlr_switch *sw);
@@ -1,32 +1,42 @@
 #define _POSIX_C_SOURCE 200809L
 #include "keybindings.h"
 #include "compositor.h"
-#include "client.h"
 #include "config.h"
 #include "events.h"
 #include "input.h"
 #include "layout.h"
-#include "monitor.h"
-#include "render.h"
-#include <ctype.h>
-#include <linux/input-event-codes.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <strings.h>
-#include <unistd.h>
-#include <wlr/backend/session.h>
-#include <wlr/types/wlr_keyboard.h>
 #include <xkbcommon/xkbcommon.h>
 
-#define MAX_KEYBINDINGS 256
+#define MAX_KEYBINDINGS 512
 #define MAX_BUTTON_BINDINGS 32
 #define MAX_ACTIONS 128
+#define MAX_MODES 16
+#define DEFAULT_MODE "default"
+
+// Open-addressed dispatch tables, at most half full
+#define KEY_TABLE_SIZE 1024
+#define BUTTON_TABLE_SIZE 64
 
 typedef struct {
     char *name;
     SwlAction action;
+    SwlActionParser parser;
 } ActionEntry;
 
+// A binding with its action looked up, keyed by (mode, modifiers, keysym/button)
+typedef struct {
+    uint32_t mode;
+    uint32_t modifiers;
+    uint32_t code;
+    SwlAction action;  // NULL marks an empty slot
+    const SwlActionArg *arg;
+} CompiledBinding;
+
 struct SwlKeybindingManager {
     SwlInput *input;
     SwlCompositor *comp;
@@ -39,8 +49,24 @@ struct SwlKeybindingManager {
 
     ActionEntry actions[MAX_ACTIONS];
     size_t action_count;
+
+    // Rebuilt from keys/buttons/actions whenever any of them change
+    SwlActionArg key_args[MAX_KEYBINDINGS];
+    SwlActionArg button_args[MAX_BUTTON_BINDINGS];
+    CompiledBinding key_table[KEY_TABLE_SIZE];
+    CompiledBinding button_table[BUTTON_TABLE_SIZE];
+    bool dirty;
+
+    // Binding modes; names are borrowed from keys[], modes[0] is the default
+    const char *modes[MAX_MODES];
+    size_t mode_count;
+    size_t current_mode;
+    char *current_mode_name;  // Outlives the bindings, NULL in the default mode
 };
 
+static SwlError validate_binding(SwlKeybindingManager *mgr, const char *action, const char *arg);
+static void action_mode(SwlCompositor *comp, const SwlActionArg *arg);
+
 SwlKeybindingManager *swl_keybinding_create(SwlInput *input)
 {
     SwlKeybindingManager *mgr = calloc(1, sizeof(*mgr));
@@ -49,6 +75,9 @@ SwlKeybindingManager *swl_keybinding_create(SwlInput *input)
 
     mgr->input = input;
     mgr->comp = swl_input_get_compositor(input);
+
+    // Modes belong to the manager, so switching between them always works
+    swl_action_register(mgr, "mode", action_mode, swl_action_parse_required);
     return mgr;
 }
 
@@ -60,6 +89,7 @@ void swl_keybinding_destroy(SwlKeybindingManager *mgr)
     for (size_t i = 0; i < mgr->key_count; i++) {
         free((void *)mgr->keys[i].action);
         free((void *)mgr->keys[i].argument);
+        free((void *)mgr->keys[i].mode);
     }
 
     for (size_t i = 0; i < mgr->button_count; i++) {
@@ -71,6 +101,7 @@ void swl_keybinding_destroy(SwlKeybindingManager *mgr)
         free(mgr->actions[i].name);
     }
 
+    free(mgr->current_mode_name);
     free(mgr);
 }
 
@@ -82,13 +113,20 @@ SwlError swl_keybinding_add(SwlKeybindingManager *mgr, const SwlKeybinding *bind
     if (mgr->key_count >= MAX_KEYBINDINGS)
         return SWL_ERR_NOMEM;
 
+    SwlError err = validate_binding(mgr, binding->action, binding->argument);
+    if (err != SWL_OK)
+        return err;
+
     SwlKeybinding *k = &mgr->keys[mgr->key_count];
     k->modifiers = binding->modifiers;
     k->keysym = binding->keysym;
     k->action = strdup(binding->action);
     k->argument = binding->argument ? strdup(binding->argument) : NULL;
+    k->mode = binding->mode && strcmp(binding->mode, DEFAULT_MODE) != 0 ?
+        strdup(binding->mode) : NULL;
 
     mgr->key_count++;
+    mgr->dirty = true;
     return SWL_OK;
 }
 
@@ -98,13 +136,15 @@ SwlError swl_keybinding_remove(SwlKeybindingManager *mgr, uint32_t mod, xkb_keys
         return SWL_ERR_INVALID_ARG;
 
     for (size_t i = 0; i < mgr->key_count; i++) {
-        if (mgr->keys[i].modifiers == mod && mgr->keys[i].keysym == key) {
+        if (mgr->keys[i].modifiers == mod && mgr->keys[i].keysym == key && !mgr->keys[i].mode) {
             free((void *)mgr->keys[i].action);
             free((void *)mgr->keys[i].argument);
+            free((void *)mgr->keys[i].mode);
 
             memmove(&mgr->keys[i], &mgr->keys[i + 1],
                     (mgr->key_count - i - 1) * sizeof(SwlKeybinding));
             mgr->key_count--;
+            mgr->dirty = true;
             return SWL_OK;
         }
     }
@@ -120,9 +160,11 @@ void swl_keybinding_clear(SwlKeybindingManager *mgr)
     for (size_t i = 0; i < mgr->key_count; i++) {
         free((void *)mgr->keys[i].action);
         free((void *)mgr->keys[i].argument);
+        free((void *)mgr->keys[i].mode);
     }
 
     mgr->key_count = 0;
+    mgr->dirty = true;
 }
 
 size_t swl_keybinding_count(const SwlKeybindingManager *mgr)
@@ -138,6 +180,10 @@ SwlError swl_button_binding_add(SwlKeybindingManager *mgr, const SwlButtonBindin
     if (mgr->button_count >= MAX_BUTTON_BINDINGS)
         return SWL_ERR_NOMEM;
 
+    SwlError err = validate_binding(mgr, binding->action, binding->argument);
+    if (err != SWL_OK)
+        return err;
+
     SwlButtonBinding *b = &mgr->buttons[mgr->button_count];
     b->modifiers = binding->modifiers;
     b->button = binding->button;
@@ -145,6 +191,7 @@ SwlError swl_button_binding_add(SwlKeybindingManager *mgr, const SwlButtonBindin
     b->argument = binding->argument ? strdup(binding->argument) : NULL;
 
     mgr->button_count++;
+    mgr->dirty = true;
     return SWL_OK;
 }
 
@@ -161,6 +208,7 @@ SwlError swl_button_binding_remove(SwlKeybindingManager *mgr, uint32_t mod, uint
             memmove(&mgr->buttons[i], &mgr->buttons[i + 1],
                     (mgr->button_count - i - 1) * sizeof(SwlButtonBinding));
             mgr->button_count--;
+            mgr->dirty = true;
             return SWL_OK;
         }
     }
@@ -179,9 +227,11 @@ void swl_button_binding_clear(SwlKeybindingManager *mgr)
     }
 
     mgr->button_count = 0;
+    mgr->dirty = true;
 }
 
-SwlError swl_action_register(SwlKeybindingManager *mgr, const char *name, SwlAction action)
+SwlError swl_action_register(SwlKeybindingManager *mgr, const char *name, SwlAction action,
+                             SwlActionParser parser)
 {
     if (!mgr || !name || !action)
         return SWL_ERR_INVALID_ARG;
@@ -196,7 +246,9 @@ SwlError swl_action_register(SwlKeybindingManager *mgr, const char *name, SwlAct
 
     mgr->actions[mgr->action_count].name = strdup(name);
     mgr->actions[mgr->action_count].action = action;
+    mgr->actions[mgr->action_count].parser = parser;
     mgr->action_count++;
+    mgr->dirty = true;
 
     return SWL_OK;
 }
@@ -212,6 +264,7 @@ SwlError swl_action_unregister(SwlKeybindingManager *mgr, const char *name)
             memmove(&mgr->actions[i], &mgr->actions[i + 1],
                     (mgr->action_count - i - 1) * sizeof(ActionEntry));
             mgr->action_count--;
+            mgr->dirty = true;
             return SWL_OK;
         }
     }
@@ -219,756 +272,390 @@ SwlError swl_action_unregister(SwlKeybindingManager *mgr, const char *name)
     return SWL_ERR_NOT_FOUND;
 }
 
-static SwlAction find_action(SwlKeybindingManager *mgr, const char *name)
+static const ActionEntry *find_action(SwlKeybindingManager *mgr, const char *name)
 {
     for (size_t i = 0; i < mgr->action_count; i++) {
         if (strcmp(mgr->actions[i].name, name) == 0)
-            return mgr->actions[i].action;
+            return &mgr->actions[i];
     }
     return NULL;
 }
 
-SwlError swl_action_dispatch(SwlKeybindingManager *mgr, const char *action, const char *arg)
+static SwlError parse_arg(SwlKeybindingManager *mgr, const ActionEntry *entry,
+                          const char *str, SwlActionArg *out)
 {
-    if (!mgr || !action)
-        return SWL_ERR_INVALID_ARG;
-
-    SwlAction fn = find_action(mgr, action);
-    if (!fn)
-        return SWL_ERR_NOT_FOUND;
-
-    fn(mgr->comp, arg);
-    return SWL_OK;
+    memset(out, 0, sizeof(*out));
+    out->str = str;
+    return entry->parser ? entry->parser(mgr->comp, str, out) : SWL_OK;
 }
 
-bool swl_keybinding_handle(SwlKeybindingManager *mgr, uint32_t mod, xkb_keysym_t key)
+// Reject bindings whose argument the action can't use; actions that aren't
+// registered yet are checked when the bindings are compiled
+static SwlError validate_binding(SwlKeybindingManager *mgr, const char *action, const char *arg)
 {
-    if (!mgr)
-        return false;
-
-    // Normalize keysym to lowercase for comparison
-    // (Shift+q gives XKB_KEY_Q, but bindings use XKB_KEY_q)
-    xkb_keysym_t key_lower = xkb_keysym_to_lower(key);
+    const ActionEntry *entry = find_action(mgr, action);
+    if (!entry || !entry->parser)
+        return SWL_OK;
 
-    for (size_t i = 0; i < mgr->key_count; i++) {
-        if (mgr->keys[i].modifiers == mod && mgr->keys[i].keysym == key_lower) {
-            SwlAction action = find_action(mgr, mgr->keys[i].action);
-            if (action) {
-                action(mgr->comp, mgr->keys[i].argument);
-                return true;
-            }
-        }
-    }
-
-    return false;
+    SwlActionArg parsed;
+    return parse_arg(mgr, entry, arg, &parsed);
 }
 
-bool swl_button_binding_handle(SwlKeybindingManager *mgr, uint32_t mod, uint32_t button)
+SwlError swl_action_dispatch(SwlKeybindingManager *mgr, const char *action, const char *arg)
 {
-    if (!mgr)
-        return false;
+    if (!mgr || !action)
+        return SWL_ERR_INVALID_ARG;
 
-    for (size_t i = 0; i < mgr->button_count; i++) {
-        if (mgr->buttons[i].modifiers == mod && mgr->buttons[i].button == button) {
-            SwlAction action = find_action(mgr, mgr->buttons[i].action);
-            if (action) {
-                action(mgr->comp, mgr->buttons[i].argument);
-                return true;
-            }
-        }
-    }
+    const ActionEntry *entry = find_action(mgr, action);
+    if (!entry)
+        return SWL_ERR_NOT_FOUND;
 
-    return false;
+    SwlActionArg parsed;
+    if (parse_arg(mgr, entry, arg, &parsed) != SWL_OK)
+        return SWL_ERR_INVALID_ARG;
+
+    entry->action(mgr->comp, &parsed);
+    return SWL_OK;
 }
 
-static void action_quit(SwlCompositor *comp, const char *arg)
+static uint32_t binding_hash(uint32_t mode, uint32_t mods, uint32_t code)
 {
-    (void)arg;
-    swl_compositor_quit(comp);
+    return (mode * 0xc2b2ae35u) ^ (mods * 0x9e3779b1u) ^ (code * 0x85ebca6bu);
 }
 
-static void action_spawn(SwlCompositor *comp, const char *arg)
+static CompiledBinding *table_find(CompiledBinding *table, size_t size, uint32_t mode,
+                                   uint32_t mods, uint32_t code)
 {
-    (void)comp;
-    if (!arg)
-        return;
-
-    if (fork() == 0) {
-        setsid();
-        execl("/bin/sh", "/bin/sh", "-c", arg, NULL);
-        _exit(1);
+    for (size_t i = binding_hash(mode, mods, code) & (size - 1);; i = (i + 1) & (size - 1)) {
+        CompiledBinding *slot = &table[i];
+        if (!slot->action ||
+            (slot->mode == mode && slot->modifiers == mods && slot->code == code))
+            return slot;
     }
 }
 
-static void action_close(SwlCompositor *comp, const char *arg)
+static void table_insert(CompiledBinding *table, size_t size, uint32_t mode, uint32_t mods,
+                         uint32_t code, SwlAction action, const SwlActionArg *arg)
 {
-    (void)arg;
-    SwlClientManager *clients = swl_compositor_get_clients(comp);
-    SwlClient *focused = swl_client_focused(clients);
-    if (focused)
-        swl_client_close(focused);
-}
+    // First binding with a registered action wins, as the old linear scan did
+    CompiledBinding *slot = table_find(table, size, mode, mods, code);
+    if (slot->action)
+        return;
 
-static bool focus_first_client(SwlClient *client, void *data)
-{
-    SwlClient **first = data;
-    if (!*first) {
-        *first = client;
-        return false;  // Stop iteration
-    }
-    return true;
+    slot->mode = mode;
+    slot->modifiers = mods;
+    slot->code = code;
+    slot->action = action;
+    slot->arg = arg;
 }
 
-static void action_focus_next(SwlCompositor *comp, const char *arg)
+static int find_mode(const SwlKeybindingManager *mgr, const char *name)
 {
-    (void)arg;
-    SwlClientManager *clients = swl_compositor_get_clients(comp);
-    SwlClient *focused = swl_client_focused(clients);
+    if (!name)
+        return 0;
 
-    if (!focused) {
-        SwlOutputManager *output = swl_compositor_get_output(comp);
-        SwlMonitor *mon = swl_monitor_get_focused(output);
-        SwlClient *first = NULL;
-        swl_client_foreach_visible(clients, mon, focus_first_client, &first);
-        if (first)
-            swl_client_focus(first);
-        return;
+    for (size_t i = 0; i < mgr->mode_count; i++) {
+        if (strcmp(mgr->modes[i], name) == 0)
+            return (int)i;
     }
-
-    // TODO: implement proper focus cycling
+    return -1;
 }
 
-static void action_focus_prev(SwlCompositor *comp, const char *arg)
+static void action_mode(SwlCompositor *comp, const SwlActionArg *arg)
 {
-    (void)arg;
-    (void)comp;
-    // TODO: implement
+    SwlInput *input = swl_compositor_get_input(comp);
+    SwlKeybindingManager *kb = input ? swl_input_get_keybindings(input) : NULL;
+    swl_keybinding_set_mode(kb, arg->str);
 }
 
-static void action_toggle_floating(SwlCompositor *comp, const char *arg)
+static void compile_bindings(SwlKeybindingManager *mgr)
 {
-    (void)arg;
-    SwlClientManager *clients = swl_compositor_get_clients(comp);
-    SwlClient *focused = swl_client_focused(clients);
-    if (focused)
-        swl_client_toggle_floating(focused);
-}
+    memset(mgr->key_table, 0, sizeof(mgr->key_table));
+    memset(mgr->button_table, 0, sizeof(mgr->button_table));
 
-static void action_toggle_fullscreen(SwlCompositor *comp, const char *arg)
-{
-    (void)arg;
-    SwlClientManager *clients = swl_compositor_get_clients(comp);
-    SwlClient *focused = swl_client_focused(clients);
-    if (focused)
-        swl_client_toggle_fullscreen(focused);
-}
+    // Mode names may have been freed along with their bindings, so the
+    // mode list is rebuilt and the active mode found again by name
+    mgr->modes[0] = DEFAULT_MODE;
+    mgr->mode_count = 1;
+    mgr->current_mode = 0;
 
-static void action_set_layout(SwlCompositor *comp, const char *arg)
-{
-    if (!arg)
-        return;
+    for (size_t i = 0; i < mgr->key_count; i++) {
+        const SwlKeybinding *k = &mgr->keys[i];
+        int mode = find_mode(mgr, k->mode);
+        if (mode < 0) {
+            if (mgr->mode_count >= MAX_MODES) {
+                fprintf(stderr, "keybindings: too many modes, ignoring %s\n", k->mode);
+                continue;
+            }
+            mode = (int)mgr->mode_count;
+            mgr->modes[mgr->mode_count++] = k->mode;
+        }
 
-    SwlLayoutRegistry *layouts = swl_compositor_get_layouts(comp);
-    const SwlLayout *layout = swl_layout_get(layouts, arg);
-    if (!layout)
-        return;
+        const ActionEntry *entry = find_action(mgr, k->action);
+        if (!entry)
+            continue;
+        if (parse_arg(mgr, entry, k->argument, &mgr->key_args[i]) != SWL_OK) {
+            char name[64];
+            if (xkb_keysym_get_name(k->keysym, name, sizeof(name)) < 0)
+                snprintf(name, sizeof(name), "0x%" PRIx32, k->keysym);
+            fprintf(stderr, "keybindings: %s: cannot bind %s:%s (invalid argument)\n", name,
+                    k->action, k->argument ? k->argument : "");
+            continue;
+        }
+        table_insert(mgr->key_table, KEY_TABLE_SIZE, (uint32_t)mode, k->modifiers, k->keysym,
+                     entry->action, &mgr->key_args[i]);
+    }
 
-    SwlOutputManager *output = swl_compositor_get_output(comp);
-    SwlMonitor *mon = swl_monitor_get_focused(output);
-    if (mon) {
-        swl_monitor_set_layout(mon, layout);
-        swl_monitor_arrange(mon);
+    // Mode switches are resolved by name when pressed, catch typos now
+    for (size_t i = 0; i < mgr->key_count; i++) {
+        const ActionEntry *entry = find_action(mgr, mgr->keys[i].action);
+        if (entry && entry->action == action_mode && find_mode(mgr, mgr->keys[i].argument) < 0)
+            fprintf(stderr, "keybindings: unknown mode %s\n", mgr->keys[i].argument);
     }
-}
 
-// Parse a monitor direction argument: "left"/"right" strings or numeric -1/+1
-static int parse_monitor_direction(const char *arg)
-{
-    if (strcmp(arg, "right") == 0)
-        return 3;
-    if (strcmp(arg, "left") == 0)
-        return 2;
-    if (strcmp(arg, "down") == 0)
-        return 1;
-    if (strcmp(arg, "up") == 0)
-        return 0;
-    // Numeric: positive = right, negative/zero = left
-    int dir = atoi(arg);
-    return dir > 0 ? 3 : 2;
+    for (size_t i = 0; i < mgr->button_count; i++) {
+        const SwlButtonBinding *b = &mgr->buttons[i];
+        const ActionEntry *entry = find_action(mgr, b->action);
+        if (!entry)
+            continue;
+        if (parse_arg(mgr, entry, b->argument, &mgr->button_args[i]) != SWL_OK) {
+            fprintf(stderr, "buttons: %" PRIu32 ": cannot bind %s:%s (invalid argument)\n",
+                    b->button, b->action, b->argument ? b->argument : "");
+            continue;
+        }
+        table_insert(mgr->button_table, BUTTON_TABLE_SIZE, 0, b->modifiers, b->button,
+                     entry->action, &mgr->button_args[i]);
+    }
+
+    mgr->dirty = false;
+
+    // Stay in the active mode if it still has bindings, else tell
+    // subscribers we are back in the default one
+    int mode = find_mode(mgr, mgr->current_mode_name);
+    if (mode >= 0) {
+        mgr->current_mode = (size_t)mode;
+    } else {
+        free(mgr->current_mode_name);
+        mgr->current_mode_name = NULL;
+        SwlEventBus *bus = swl_compositor_get_event_bus(mgr->comp);
+        swl_event_bus_emit_simple(bus, SWL_EVENT_MODE_CHANGE, (void *)DEFAULT_MODE);
+    }
 }
 
-static void action_focus_monitor(SwlCompositor *comp, const char *arg)
+void swl_keybinding_compile(SwlKeybindingManager *mgr)
 {
-    if (!arg)
-        return;
-
-    int dir = parse_monitor_direction(arg);
-    SwlOutputManager *output = swl_compositor_get_output(comp);
-    SwlMonitor *mon = swl_monitor_get_focused(output);
-    if (!mon)
-        return;
-
-    SwlMonitor *next = swl_monitor_in_direction(output, mon, dir);
-    if (!next)
-        return;
-
-    swl_monitor_focus(next);
-
-    SwlClientManager *clients = swl_compositor_get_clients(comp);
-    SwlClient *c = swl_client_focus_top_on_monitor(clients, next);
-    if (c)
-        swl_client_focus(c);
+    if (mgr)
+        compile_bindings(mgr);
 }
 
-static void action_send_monitor(SwlCompositor *comp, const char *arg)
+SwlCompositor *swl_keybinding_get_compositor(const SwlKeybindingManager *mgr)
 {
-    if (!arg)
-        return;
-
-    int dir = parse_monitor_direction(arg);
-    SwlClientManager *clients = swl_compositor_get_clients(comp);
-    SwlClient *focused = swl_client_focused(clients);
-    if (!focused)
-        return;
-
-    SwlOutputManager *output = swl_compositor_get_output(comp);
-    SwlMonitor *mon = swl_client_get_monitor(focused);
-    if (!mon)
-        mon = swl_monitor_get_focused(output);
-    if (!mon)
-        return;
-
-    SwlMonitor *next = swl_monitor_in_direction(output, mon, dir);
-    if (next)
-        swl_client_move_to_monitor(focused, next);
+    return mgr ? mgr->comp : NULL;
 }
 
-static void action_reload_config(SwlCompositor *comp, const char *arg)
+bool swl_keybinding_handle(SwlKeybindingManager *mgr, uint32_t mod, xkb_keysym_t key)
 {
-    (void)arg;
-    SwlConfig *config = swl_compositor_get_config(comp);
-    if (!config || swl_config_reload(config) != SWL_OK)
-        return;
+    if (!mgr)
+        return false;
 
-    // Reload renderer settings (borders, colors, blur, shadows, opacity)
-    SwlRenderer *renderer = swl_compositor_get_renderer(comp);
-    if (renderer) {
-        swl_renderer_reload_config(renderer);
-        swl_renderer_damage_whole(renderer);
-    }
+    if (mgr->dirty)
+        compile_bindings(mgr);
 
-    // Reload input settings (keyboard, pointer) and re-apply to devices
-    SwlInput *input = swl_compositor_get_input(comp);
-    if (input) {
-        swl_input_reload_config(input);
+    // Normalize keysym to lowercase for comparison
+    // (Shift+q gives XKB_KEY_Q, but bindings use XKB_KEY_q)
+    xkb_keysym_t key_lower = xkb_keysym_to_lower(key);
 
-        // Reload keybindings and button bindings
-        SwlKeybindingManager *kb = swl_input_get_keybindings(input);
-        if (kb)
-            swl_keybinding_reload(kb);
+    CompiledBinding *b = table_find(mgr->key_table, KEY_TABLE_SIZE,
+                                    (uint32_t)mgr->current_mode, mod, key_lower);
+    if (!b->action) {
+        // Escape leaves any mode that doesn't bind it itself
+        if (mgr->current_mode != 0 && key_lower == XKB_KEY_Escape) {
+            swl_keybinding_set_mode(mgr, DEFAULT_MODE);
+            return true;
+        }
+        return false;
     }
 
-    // Reload window rules
-    SwlClientManager *clients = swl_compositor_get_clients(comp);
-    if (clients)
-        swl_client_manager_load_rules(clients);
-
-    // Re-apply monitor rules and re-arrange
-    SwlOutputManager *output = swl_compositor_get_output(comp);
-    if (output)
-        swl_monitor_reload_config(output);
-
-    SwlEventBus *bus = swl_compositor_get_event_bus(comp);
-    swl_event_bus_emit_simple(bus, SWL_EVENT_CONFIG_RELOAD, NULL);
-}
-
-static void action_zoom(SwlCompositor *comp, const char *arg)
-{
-    (void)arg;
-    SwlClientManager *clients = swl_compositor_get_clients(comp);
-    swl_client_zoom(clients);
+    b->action(mgr->comp, b->arg);
+    return true;
 }
 
-static void action_focusdir(SwlCompositor *comp, const char *arg)
+bool swl_button_binding_handle(SwlKeybindingManager *mgr, uint32_t mod, uint32_t button)
 {
-    if (!arg)
-        return;
+    if (!mgr)
+        return false;
 
-    int dir;
-    if (strcmp(arg, "up") == 0)
-        dir = 0;
-    else if (strcmp(arg, "down") == 0)
-        dir = 1;
-    else if (strcmp(arg, "left") == 0)
-        dir = 2;
-    else if (strcmp(arg, "right") == 0)
-        dir = 3;
-    else
-        dir = atoi(arg);
+    if (mgr->dirty)
+        compile_bindings(mgr);
 
-    SwlClientManager *clients = swl_compositor_get_clients(comp);
-    SwlClient *focused = swl_client_focused(clients);
-    if (!focused)
-        return;
+    // Button bindings apply in every mode
+    CompiledBinding *b = table_find(mgr->button_table, BUTTON_TABLE_SIZE, 0, mod, button);
+    if (!b->action)
+        return false;
 
-    SwlClient *next = swl_client_in_direction(clients, focused, dir);
-    if (next)
-        swl_client_focus(next);
+    b->action(mgr->comp, b->arg);
+    return true;
 }
 
-static void action_moveresize(SwlCompositor *comp, const char *arg)
+// Strict integer parse, the whole string must be a number
+static bool parse_int(const char *str, int *out)
 {
-    if (!arg)
-        return;
+    if (!str || !*str)
+        return false;
 
-    SwlInput *input = swl_compositor_get_input(comp);
-    if (!input)
-        return;
+    char *end;
+    long v = strtol(str, &end, 10);
+    if (*end != '\0' || v < INT_MIN || v > INT_MAX)
+        return false;
 
-    if (strcmp(arg, "move") == 0) {
-        swl_input_start_move(input);
-    } else if (strcmp(arg, "resize") == 0) {
-        swl_input_start_resize(input);
-    }
+    *out = (int)v;
+    return true;
 }
 
-static void action_cycle_ratio(SwlCompositor *comp, const char *arg)
+SwlError swl_keybinding_set_mode(SwlKeybindingManager *mgr, const char *mode)
 {
-    (void)arg;
-    SwlClientManager *clients = swl_compositor_get_clients(comp);
-    SwlClient *focused = swl_client_focused(clients);
-    if (!focused)
-        return;
-
-    SwlConfig *cfg = swl_compositor_get_config(comp);
-    const char *ratios_str = swl_config_get_string(cfg, "appearance.scroller_ratios",
-                                                    "0.4,0.6,0.8,1.0");
-
-    // Parse comma-separated float list
-    float ratios[32];
-    int count = 0;
-    char *copy = strdup(ratios_str);
-    if (!copy)
-        return;
+    if (!mgr || !mode)
+        return SWL_ERR_INVALID_ARG;
 
-    char *saveptr = NULL;
-    char *token = strtok_r(copy, ",", &saveptr);
-    while (token && count < 32) {
-        while (*token == ' ') token++;
-        ratios[count] = strtof(token, NULL);
-        if (ratios[count] > 0.0f && ratios[count] <= 1.0f)
-            count++;
-        token = strtok_r(NULL, ",", &saveptr);
-    }
-    free(copy);
+    if (mgr->dirty)
+        compile_bindings(mgr);
 
-    if (count == 0)
-        return;
+    int index = find_mode(mgr, mode);
+    if (index < 0)
+        return SWL_ERR_NOT_FOUND;
 
-    // Get the client's current ratio; 0.0 means "default"
-    float current = swl_client_get_scroller_ratio(focused);
+    if ((size_t)index == mgr->current_mode)
+        return SWL_OK;
 
-    // Get the monitor's default scroller_ratio for matching 0.0
-    SwlMonitor *mon = swl_client_get_monitor(focused);
-    if (!mon) {
-        SwlOutputManager *output = swl_compositor_get_output(comp);
-        mon = swl_monitor_get_focused(output);
-    }
-    float default_ratio = mon ? swl_monitor_get_scroller_ratio(mon) : 0.8f;
-    float effective = (current > 0.0f) ? current : default_ratio;
-
-    // Find the closest match in the list
-    int best = 0;
-    float best_diff = 2.0f;
-    for (int i = 0; i < count; i++) {
-        float diff = (ratios[i] - effective > 0) ? (ratios[i] - effective) : (effective - ratios[i]);
-        if (diff < best_diff) {
-            best_diff = diff;
-            best = i;
-        }
-    }
-
-    // Advance to next (wrap)
-    int next = (best + 1) % count;
-    swl_client_set_scroller_ratio(focused, ratios[next]);
+    char *name = NULL;
+    if (index != 0 && !(name = strdup(mgr->modes[index])))
+        return SWL_ERR_NOMEM;
+    free(mgr->current_mode_name);
+    mgr->current_mode_name = name;
+    mgr->current_mode = (size_t)index;
 
-    // Re-arrange the monitor
-    if (mon)
-        swl_monitor_arrange(mon);
+    SwlEventBus *bus = swl_compositor_get_event_bus(mgr->comp);
+    swl_event_bus_emit_simple(bus, SWL_EVENT_MODE_CHANGE, (void *)mgr->modes[index]);
+    return SWL_OK;
 }
 
-static void action_consume_or_expel(SwlCompositor *comp, const char *arg)
+const char *swl_keybinding_get_mode(const SwlKeybindingManager *mgr)
 {
-    SwlClientManager *clients = swl_compositor_get_clients(comp);
-    SwlClient *focused = swl_client_focused(clients);
-    if (!focused)
-        return;
-
-    SwlClientInfo info = swl_client_get_info(focused);
-    if (info.floating || info.fullscreen)
-        return;
-
-    // Only meaningful in scroller layout
-    SwlMonitor *mon = swl_client_get_monitor(focused);
-    if (!mon) {
-        SwlOutputManager *output = swl_compositor_get_output(comp);
-        mon = swl_monitor_get_focused(output);
-    }
-    if (!mon)
-        return;
-
-    const SwlLayout *layout = swl_monitor_get_layout(mon);
-    if (!layout || !layout->name || strcmp(layout->name, "scroller") != 0)
-        return;
-
-    int dir = arg ? atoi(arg) : 1;
-    swl_client_consume_or_expel(clients, focused, dir);
+    if (!mgr || mgr->current_mode >= mgr->mode_count)
+        return DEFAULT_MODE;
+    return mgr->modes[mgr->current_mode];
 }
 
-static void action_chvt(SwlCompositor *comp, const char *arg)
+SwlError swl_action_parse_required(SwlCompositor *comp, const char *str, SwlActionArg *out)
 {
-    if (!arg)
-        return;
-
-    int vt = atoi(arg);
-    if (vt < 1 || vt > 12)
-        return;
-
-    struct wlr_session *session = swl_compositor_get_session(comp);
-    if (session)
-        wlr_session_change_vt(session, vt);
+    (void)comp;
+    (void)out;
+    return str && *str ? SWL_OK : SWL_ERR_INVALID_ARG;
 }
 
-// Parse modifier string like "mod+shift+ctrl" and return modifier mask
-static uint32_t parse_modifiers(const char *str, uint32_t modkey)
+// "up"/"down"/"left"/"right" or the numeric direction
+SwlError swl_action_parse_direction(SwlCompositor *comp, const char *str, SwlActionArg *out)
 {
-    if (!str) return 0;
-
-    uint32_t mods = 0;
-    char *copy = strdup(str);
-    if (!copy) return 0;
-
-    char *token = strtok(copy, "+");
-    while (token) {
-        // Trim whitespace
-        while (*token && isspace(*token)) token++;
-        char *end = token + strlen(token) - 1;
-        while (end > token && isspace(*end)) *end-- = '\0';
-
-        // Convert to lowercase
-        for (char *p = token; *p; p++) *p = tolower(*p);
-
-        if (strcmp(token, "mod") == 0) {
-            mods |= modkey;
-        } else if (strcmp(token, "super") == 0 || strcmp(token, "logo") == 0 ||
-                   strcmp(token, "mod4") == 0 || strcmp(token, "win") == 0) {
-            mods |= WLR_MODIFIER_LOGO;
-        } else if (strcmp(token, "shift") == 0) {
-            mods |= WLR_MODIFIER_SHIFT;
-        } else if (strcmp(token, "ctrl") == 0 || strcmp(token, "control") == 0) {
-            mods |= WLR_MODIFIER_CTRL;
-        } else if (strcmp(token, "alt") == 0 || strcmp(token, "mod1") == 0) {
-            mods |= WLR_MODIFIER_ALT;
-        }
-        // Unrecognized tokens are assumed to be the key name
+    (void)comp;
+    if (!str)
+        return SWL_ERR_INVALID_ARG;
 
-        token = strtok(NULL, "+");
-    }
+    if (strcmp(str, "up") == 0)
+        out->i = 0;
+    else if (strcmp(str, "down") == 0)
+        out->i = 1;
+    else if (strcmp(str, "left") == 0)
+        out->i = 2;
+    else if (strcmp(str, "right") == 0)
+        out->i = 3;
+    else if (!parse_int(str, &out->i) || out->i < 0 || out->i > 3)
+        return SWL_ERR_INVALID_ARG;
 
-    free(copy);
-    return mods;
+    return SWL_OK;
 }
 
-// Extract the key name from a binding string like "mod+shift+Return"
-static const char *extract_keyname(const char *str)
+// Monitor direction: a direction name or numeric -1/+1 (positive = right)
+SwlError swl_action_parse_monitor_direction(SwlCompositor *comp, const char *str,
+                                            SwlActionArg *out)
 {
-    if (!str) return NULL;
+    if (!str)
+        return SWL_ERR_INVALID_ARG;
 
-    // Find the last '+' - everything after is the key name
-    const char *last_plus = strrchr(str, '+');
-    if (last_plus)
-        return last_plus + 1;
-    return str;
+    int dir;
+    if (parse_int(str, &dir)) {
+        out->i = dir > 0 ? 3 : 2;
+        return SWL_OK;
+    }
+    return swl_action_parse_direction(comp, str, out);
 }
 
-// Parse a keysym from a string
-static xkb_keysym_t parse_keysym(const char *str)
+SwlError swl_action_parse_layout(SwlCompositor *comp, const char *str, SwlActionArg *out)
 {
-    if (!str) return XKB_KEY_NoSymbol;
-
-    // Try XKB lookup
-    xkb_keysym_t sym = xkb_keysym_from_name(str, XKB_KEYSYM_CASE_INSENSITIVE);
-    if (sym != XKB_KEY_NoSymbol) return sym;
-
-    // Handle common aliases
-    if (strcasecmp(str, "enter") == 0) return XKB_KEY_Return;
-    if (strcasecmp(str, "esc") == 0) return XKB_KEY_Escape;
-    if (strcasecmp(str, "del") == 0) return XKB_KEY_Delete;
-    if (strcasecmp(str, "backspace") == 0) return XKB_KEY_BackSpace;
+    if (!str)
+        return SWL_ERR_INVALID_ARG;
 
-    return XKB_KEY_NoSymbol;
+    SwlLayoutRegistry *layouts = swl_compositor_get_layouts(comp);
+    out->layout = swl_layout_get(layouts, str);
+    return out->layout ? SWL_OK : SWL_ERR_NOT_FOUND;
 }
 
-// Parse a button name
-static uint32_t parse_button(const char *str)
+SwlError swl_action_parse_moveresize(SwlCompositor *comp, const char *str, SwlActionArg *out)
 {
-    if (!str) return 0;
+    (void)comp;
+    if (!str)
+        return SWL_ERR_INVALID_ARG;
 
-    if (strcasecmp(str, "left") == 0) return BTN_LEFT;
-    if (strcasecmp(str, "middle") == 0) return BTN_MIDDLE;
-    if (strcasecmp(str, "right") == 0) return BTN_RIGHT;
-    if (strcasecmp(str, "side") == 0) return BTN_SIDE;
-    if (strcasecmp(str, "extra") == 0) return BTN_EXTRA;
+    if (strcmp(str, "move") == 0)
+        out->i = SWL_MOVERESIZE_MOVE;
+    else if (strcmp(str, "resize") == 0)
+        out->i = SWL_MOVERESIZE_RESIZE;
+    else
+        return SWL_ERR_INVALID_ARG;
 
-    return 0;
+    return SWL_OK;
 }
 
-// Load keybindings from config
-// Format: keybindings."mod+key" = "action" or "action:argument"
-static void load_keybindings_from_config(SwlKeybindingManager *mgr)
+// Comma-separated ratios, from the argument or appearance.scroller_ratios
+SwlError swl_action_parse_ratios(SwlCompositor *comp, const char *str, SwlActionArg *out)
 {
-    SwlConfig *cfg = swl_compositor_get_config(mgr->comp);
-    if (!cfg)
-        return;
-
-    // Get modkey setting
-    const char *modkey_str = swl_config_get_string(cfg, "general.modkey", "alt");
-    uint32_t modkey = WLR_MODIFIER_ALT;
-    if (strcasecmp(modkey_str, "super") == 0 || strcasecmp(modkey_str, "logo") == 0)
-        modkey = WLR_MODIFIER_LOGO;
-    else if (strcasecmp(modkey_str, "ctrl") == 0)
-        modkey = WLR_MODIFIER_CTRL;
-
-    // Get all keybinding keys
-    size_t count = 0;
-    const char **keys = swl_config_keys(cfg, "keybindings.", &count);
-    if (!keys || count == 0)
-        return;
-
-    // Process each keybinding
-    // Format: keybindings."mod+shift+Return" = "action:argument"
-    for (size_t i = 0; i < count; i++) {
-        const char *key = keys[i];
-
-        // Extract binding key from config key (e.g., "mod+p" from "keybindings.mod+p")
-        const char *binding_key = key + strlen("keybindings.");
-
-        // Get value (action:argument format)
-        const char *value = swl_config_get_string(cfg, key, NULL);
-        if (!value)
-            continue;
-
-        // Parse action and argument from value
-        char *action = strdup(value);
-        if (!action)
-            continue;
+    if (!str) {
+        SwlConfig *cfg = swl_compositor_get_config(comp);
+        str = swl_config_get_string(cfg, "appearance.scroller_ratios", "0.4,0.6,0.8,1.0");
+    }
 
-        char *arg_str = NULL;
-        char *colon = strchr(action, ':');
-        if (colon) {
-            *colon = '\0';
-            arg_str = colon + 1;
-        }
+    char *copy = strdup(str);
+    if (!copy)
+        return SWL_ERR_NOMEM;
 
-        // Parse modifiers and keysym
-        uint32_t mods = parse_modifiers(binding_key, modkey);
-        const char *keyname = extract_keyname(binding_key);
-        xkb_keysym_t keysym = parse_keysym(keyname);
-
-        if (keysym != XKB_KEY_NoSymbol) {
-            SwlKeybinding binding = {
-                .modifiers = mods,
-                .keysym = keysym,
-                .action = action,
-                .argument = arg_str,
-            };
-            swl_keybinding_add(mgr, &binding);
-        } else {
-            free(action);
-        }
+    char *saveptr = NULL;
+    char *token = strtok_r(copy, ",", &saveptr);
+    while (token && out->float_count < SWL_ACTION_MAX_FLOATS) {
+        while (*token == ' ') token++;
+        float ratio = strtof(token, NULL);
+        if (ratio > 0.0f && ratio <= 1.0f)
+            out->floats[out->float_count++] = ratio;
+        token = strtok_r(NULL, ",", &saveptr);
     }
+    free(copy);
 
-    swl_config_keys_free(keys, count);
+    return out->float_count > 0 ? SWL_OK : SWL_ERR_INVALID_ARG;
 }
 
-// Load button bindings from config
-// Format: buttons."mod+button" = "action" or "action:argument"
-static void load_buttons_from_config(SwlKeybindingManager *mgr)
+// Optional integer, 1 when omitted
+SwlError swl_action_parse_int_default_one(SwlCompositor *comp, const char *str,
+                                          SwlActionArg *out)
 {
-    SwlConfig *cfg = swl_compositor_get_config(mgr->comp);
-    if (!cfg)
-        return;
-
-    // Get modkey setting
-    const char *modkey_str = swl_config_get_string(cfg, "general.modkey", "alt");
-    uint32_t modkey = WLR_MODIFIER_ALT;
-    if (strcasecmp(modkey_str, "super") == 0 || strcasecmp(modkey_str, "logo") == 0)
-        modkey = WLR_MODIFIER_LOGO;
-    else if (strcasecmp(modkey_str, "ctrl") == 0)
-        modkey = WLR_MODIFIER_CTRL;
-
-    // Get all button binding keys
-    size_t count = 0;
-    const char **keys = swl_config_keys(cfg, "buttons.", &count);
-    if (!keys || count == 0)
-        return;
-
-    for (size_t i = 0; i < count; i++) {
-        const char *key = keys[i];
-
-        const char *binding_key = key + strlen("buttons.");
-
-        const char *value = swl_config_get_string(cfg, key, NULL);
-        if (!value)
-            continue;
-
-        char *action = strdup(value);
-        if (!action)
-            continue;
-
-        char *arg_str = NULL;
-        char *colon = strchr(action, ':');
-        if (colon) {
-            *colon = '\0';
-            arg_str = colon + 1;
-        }
-
-        uint32_t mods = parse_modifiers(binding_key, modkey);
-        const char *buttonname = extract_keyname(binding_key);
-        uint32_t button = parse_button(buttonname);
-
-        if (button != 0) {
-            SwlButtonBinding binding = {
-                .modifiers = mods,
-                .button = button,
-                .action = action,
-                .argument = arg_str,
-            };
-            swl_button_binding_add(mgr, &binding);
-        } else {
-            free(action);
-        }
-    }
-
-    swl_config_keys_free(keys, count);
+    (void)comp;
+    out->i = 1;
+    if (!str)
+        return SWL_OK;
+    return parse_int(str, &out->i) ? SWL_OK : SWL_ERR_INVALID_ARG;
 }
 
-void swl_keybinding_reload(SwlKeybindingManager *mgr)
+SwlError swl_action_parse_vt(SwlCompositor *comp, const char *str, SwlActionArg *out)
 {
-    if (!mgr)
-        return;
-
-    swl_keybinding_clear(mgr);
-    swl_button_binding_clear(mgr);
-    load_keybindings_from_config(mgr);
-    load_buttons_from_config(mgr);
-}
-
-void swl_action_register_builtins(SwlKeybindingManager *mgr)
-{
-    // Register all action handlers
-    swl_action_register(mgr, "quit", action_quit);
-    swl_action_register(mgr, "spawn", action_spawn);
-    swl_action_register(mgr, "close", action_close);
-    swl_action_register(mgr, "killclient", action_close);  // Alias
-    swl_action_register(mgr, "focus-next", action_focus_next);
-    swl_action_register(mgr, "focus-prev", action_focus_prev);
-    swl_action_register(mgr, "focusstack", action_focus_next);  // Alias with direction
-    swl_action_register(mgr, "toggle-floating", action_toggle_floating);
-    swl_action_register(mgr, "togglefloating", action_toggle_floating);  // Alias
-    swl_action_register(mgr, "toggle-fullscreen", action_toggle_fullscreen);
-    swl_action_register(mgr, "togglefullscreen", action_toggle_fullscreen);  // Alias
-    swl_action_register(mgr, "setlayout", action_set_layout);
-    swl_action_register(mgr, "set-layout", action_set_layout);
-    swl_action_register(mgr, "focus-monitor", action_focus_monitor);
-    swl_action_register(mgr, "focusmon", action_focus_monitor);  // Alias
-    swl_action_register(mgr, "send-monitor", action_send_monitor);
-    swl_action_register(mgr, "sendmon", action_send_monitor);  // Alias
-    swl_action_register(mgr, "tag-monitor", action_send_monitor);  // Compat alias
-    swl_action_register(mgr, "tagmon", action_send_monitor);  // Compat alias
-    swl_action_register(mgr, "reload-config", action_reload_config);
-    swl_action_register(mgr, "reload_config", action_reload_config);  // Alias
-    swl_action_register(mgr, "zoom", action_zoom);
-    swl_action_register(mgr, "focusdir", action_focusdir);
-    swl_action_register(mgr, "moveresize", action_moveresize);
-    swl_action_register(mgr, "cycle-ratio", action_cycle_ratio);
-    swl_action_register(mgr, "consume_or_expel", action_consume_or_expel);
-    swl_action_register(mgr, "consume-or-expel", action_consume_or_expel);
-    swl_action_register(mgr, "chvt", action_chvt);
-
-    // Try to load keybindings from config
-    SwlConfig *cfg = swl_compositor_get_config(mgr->comp);
-    bool has_config_keybindings = false;
-
-    if (cfg) {
-        size_t count = 0;
-        const char **keys = swl_config_keys(cfg, "keybindings.", &count);
-        if (keys && count > 0) {
-            has_config_keybindings = true;
-            swl_config_keys_free(keys, count);
-        }
-    }
-
-    if (has_config_keybindings) {
-        // Load keybindings from config
-        load_keybindings_from_config(mgr);
-        load_buttons_from_config(mgr);
-        goto hardcoded_chvt;
-    }
-
-    // Default keybindings (Mod = Alt)
-    #define MOD WLR_MODIFIER_ALT
-    #define SHIFT WLR_MODIFIER_SHIFT
-
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD | SHIFT, XKB_KEY_q, "quit", NULL});
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD | SHIFT, XKB_KEY_Return, "spawn", "foot"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_Return, "spawn", "foot"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD | SHIFT, XKB_KEY_c, "close", NULL});
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_j, "focus-next", NULL});
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_k, "focus-prev", NULL});
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_space, "toggle-floating", NULL});
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_f, "toggle-fullscreen", NULL});
-    // Layout keybindings
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_s, "set-layout", "scroller"});
-
-    // Zoom (swap with master)
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_z, "zoom", NULL});
-
-    // Monitor focus/move (left = -1, right = 1)
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_comma, "focus-monitor", "-1"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_period, "focus-monitor", "1"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD | SHIFT, XKB_KEY_comma, "send-monitor", "-1"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD | SHIFT, XKB_KEY_period, "send-monitor", "1"});
-
-    // Directional focus (arrow keys)
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_Up, "focusdir", "up"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_Down, "focusdir", "down"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_Left, "focusdir", "left"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){MOD, XKB_KEY_Right, "focusdir", "right"});
-
-    // Default button bindings (Mod+click = move/resize)
-    swl_button_binding_add(mgr, &(SwlButtonBinding){MOD, BTN_LEFT, "moveresize", "move"});
-    swl_button_binding_add(mgr, &(SwlButtonBinding){MOD, BTN_MIDDLE, "toggle-floating", NULL});
-    swl_button_binding_add(mgr, &(SwlButtonBinding){MOD, BTN_RIGHT, "moveresize", "resize"});
-
-    #undef MOD
-    #undef SHIFT
-
-hardcoded_chvt:
-    // Hardcoded VT switching keybindings (Ctrl+Alt+F1-F12)
-    // These are always registered regardless of config
-    #define CHVT_MODS (WLR_MODIFIER_CTRL | WLR_MODIFIER_ALT)
-    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_1, "chvt", "1"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_2, "chvt", "2"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_3, "chvt", "3"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_4, "chvt", "4"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_5, "chvt", "5"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_6, "chvt", "6"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_7, "chvt", "7"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_8, "chvt", "8"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_9, "chvt", "9"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_10, "chvt", "10"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_11, "chvt", "11"});
-    swl_keybinding_add(mgr, &(SwlKeybinding){CHVT_MODS, XKB_KEY_XF86Switch_VT_12, "chvt", "12"});
-    #undef CHVT_MODS
+    (void)comp;
+    if (!parse_int(str, &out->i) || out->i < 1 || out->i > 12)
+        return SWL_ERR_INVALID_ARG;
+    return SWL_OK;
 }
@@ -1,6 +1,15 @@
+#define _POSIX_C_SOURCE 200809L
 #include "input_internal.h"
 #include "compositor.h"
+#include "monitor.h"
 #include "session_lock.h"
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
 #include <wayland-server-core.h>
 #include <wlr/types/wlr_keyboard.h>
 #include <wlr/interfaces/wlr_keyboard.h>
@@ -9,10 +18,217 @@
 #include <xkbcommon/xkbcommon.h>
 #include <linux/input-event-codes.h>
 
+// RMLVO names joined by a separator that can't appear in them
+static char *keymap_key(const struct xkb_rule_names *names)
+{
+    const char *f[] = { names->rules, names->model, names->layout,
+                        names->variant, names->options };
+    size_t len = 1;
+    for (size_t i = 0; i < 5; i++)
+        len += (f[i] ? strlen(f[i]) : 0) + 1;
+
+    char *key = malloc(len);
+    if (!key)
+        return NULL;
+
+    snprintf(key, len, "%s\x1f%s\x1f%s\x1f%s\x1f%s",
+             f[0] ? f[0] : "", f[1] ? f[1] : "", f[2] ? f[2] : "",
+             f[3] ? f[3] : "", f[4] ? f[4] : "");
+    return key;
+}
+
+#define FNV_OFFSET 0xcbf29ce484222325ull
+
+static uint64_t fnv1a_bytes(uint64_t h, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+    for (size_t i = 0; i < len; i++)
+        h = (h ^ p[i]) * 0x100000001b3ull;
+    return h;
+}
+
+static uint64_t fnv1a(const char *s)
+{
+    return fnv1a_bytes(FNV_OFFSET, s, strlen(s));
+}
+
+#ifndef SWL_XKBCOMMON_VERSION
+#define SWL_XKBCOMMON_VERSION "unknown"
+#endif
+
+// The same names compile to a different keymap once xkbcommon or the XKB
+// data it reads changes, so a persisted keymap is stamped with the
+// xkbcommon version and the mtimes of every include path. Packages and
+// editors replace files, which bumps the mtime of the directory they are in.
+static char *persisted_keymap_header(struct xkb_context *ctx, const char *key)
+{
+    static const char *const subdirs[] = {
+        "", "/rules", "/keycodes", "/types", "/compat", "/symbols",
+    };
+
+    uint64_t h = FNV_OFFSET;
+    for (unsigned int i = 0; i < xkb_context_num_include_paths(ctx); i++) {
+        const char *dir = xkb_context_include_path_get(ctx, i);
+        if (!dir)
+            continue;
+        h = fnv1a_bytes(h, dir, strlen(dir) + 1);
+
+        for (size_t j = 0; j < sizeof(subdirs) / sizeof(subdirs[0]); j++) {
+            char path[PATH_MAX];
+            struct stat st;
+            snprintf(path, sizeof(path), "%s%s", dir, subdirs[j]);
+            int64_t stamp[2] = { -1, -1 };
+            if (stat(path, &st) == 0) {
+                stamp[0] = (int64_t)st.st_mtim.tv_sec;
+                stamp[1] = (int64_t)st.st_mtim.tv_nsec;
+            }
+            h = fnv1a_bytes(h, stamp, sizeof(stamp));
+        }
+    }
+
+    size_t len = strlen(key) + strlen(SWL_XKBCOMMON_VERSION) + 20;
+    char *header = malloc(len);
+    if (!header)
+        return NULL;
+    snprintf(header, len, "%s\x1f%s\x1f%016" PRIx64, key, SWL_XKBCOMMON_VERSION, h);
+    return header;
+}
+
+static bool keymap_cache_path(const char *key, char *path, size_t size)
+{
+    const char *xdg_cache = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+
+    char dir[512];
+    if (xdg_cache && *xdg_cache) {
+        snprintf(dir, sizeof(dir), "%s/swl", xdg_cache);
+    } else if (home) {
+        snprintf(dir, sizeof(dir), "%s/.cache", home);
+        mkdir(dir, 0755);
+        snprintf(dir, sizeof(dir), "%s/.cache/swl", home);
+    } else {
+        return false;
+    }
+
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST)
+        return false;
+
+    snprintf(path, size, "%s/keymap-%016" PRIx64 ".xkb", dir, fnv1a(key));
+    return true;
+}
+
+// Persisted keymaps start with their header on its own line, so hash
+// collisions, edited configs and updated XKB data never load the wrong keymap
+static struct xkb_keymap *load_persisted_keymap(struct xkb_context *ctx, const char *key,
+                                                const char *header)
+{
+    char path[600];
+    if (!keymap_cache_path(key, path, sizeof(path)))
+        return NULL;
+
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return NULL;
+
+    char *buf = NULL;
+    long size = -1;
+    if (fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) > 0 && fseek(f, 0, SEEK_SET) == 0)
+        buf = malloc((size_t)size + 1);
+    if (!buf || fread(buf, 1, (size_t)size, f) != (size_t)size) {
+        free(buf);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    buf[size] = '\0';
+
+    struct xkb_keymap *keymap = NULL;
+    char *text = strchr(buf, '\n');
+    if (text) {
+        *text++ = '\0';
+        if (strcmp(buf, header) == 0)
+            keymap = xkb_keymap_new_from_string(ctx, text, XKB_KEYMAP_FORMAT_TEXT_V1,
+                                                XKB_KEYMAP_COMPILE_NO_FLAGS);
+    }
+
+    free(buf);
+    return keymap;
+}
+
+static void persist_keymap(struct xkb_keymap *keymap, const char *key, const char *header)
+{
+    char path[600], tmp[640];
+    if (!keymap_cache_path(key, path, sizeof(path)))
+        return;
+
+    char *text = xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
+    if (!text)
+        return;
+
+    // Write to a temporary and rename so a crash never leaves half a keymap
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *f = fopen(tmp, "w");
+    if (f) {
+        bool ok = fprintf(f, "%s\n%s", header, text) >= 0;
+        if (fclose(f) == 0 && ok)
+            rename(tmp, path);
+        else
+            remove(tmp);
+    }
+    free(text);
+}
+
+// Returns a keymap owned by the cache, compiling it only on a miss
+static struct xkb_keymap *get_keymap(SwlInput *input, const struct xkb_rule_names *names)
+{
+    char *key = keymap_key(names);
+    if (!key)
+        return NULL;
+
+    input->keymap_clock++;
+
+    SwlKeymapCacheEntry *slot = &input->keymaps[0];
+    for (size_t i = 0; i < MAX_CACHED_KEYMAPS; i++) {
+        SwlKeymapCacheEntry *e = &input->keymaps[i];
+        if (e->key && strcmp(e->key, key) == 0) {
+            e->last_used = input->keymap_clock;
+            free(key);
+            return e->keymap;
+        }
+        // Reuse an empty slot, else evict the least recently used
+        if (slot->key && (!e->key || e->last_used < slot->last_used))
+            slot = e;
+    }
+
+    char *header = input->kb_config.xkb_persist_cache ?
+        persisted_keymap_header(input->xkb_ctx, key) : NULL;
+    struct xkb_keymap *keymap = header ? load_persisted_keymap(input->xkb_ctx, key, header) : NULL;
+    if (!keymap) {
+        keymap = xkb_keymap_new_from_names(input->xkb_ctx, names, XKB_KEYMAP_COMPILE_NO_FLAGS);
+        if (keymap && header)
+            persist_keymap(keymap, key, header);
+    }
+    free(header);
+    if (!keymap) {
+        free(key);
+        return NULL;
+    }
+
+    if (slot->key) {
+        free(slot->key);
+        xkb_keymap_unref(slot->keymap);
+    }
+    slot->key = key;
+    slot->keymap = keymap;
+    slot->last_used = input->keymap_clock;
+    return keymap;
+}
+
 void configure_keyboard(SwlInput *input, struct wlr_keyboard *kb)
 {
-    struct xkb_context *ctx = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
-    if (!ctx)
+    if (!input->xkb_ctx)
+        input->xkb_ctx = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+    if (!input->xkb_ctx)
         return;
 
     struct xkb_rule_names rules = {
@@ -23,13 +239,11 @@ void configure_keyboard(SwlInput *input, struct wlr_keyboard *kb)
         .options = input->kb_config.xkb_options,
     };
 
-    struct xkb_keymap *keymap = xkb_keymap_new_from_names(ctx, &rules,
-        XKB_KEYMAP_COMPILE_NO_FLAGS);
-
-    if (keymap) {
+    // Unchanged names give back the keymap the keyboard already has, so
+    // reloads don't re-send it to every client
+    struct xkb_keymap *keymap = get_keymap(input, &rules);
+    if (keymap && keymap != kb->keymap)
         wlr_keyboard_set_keymap(kb, keymap);
-        xkb_keymap_unref(keymap);
-    }
 
     wlr_keyboard_set_repeat_info(kb,
         input->kb_config.repeat_rate > 0 ? input->kb_config.repeat_rate : 25,
@@ -45,8 +259,6 @@ void configure_keyboard(SwlInput *input, struct wlr_keyboard *kb)
 
     if (input->locked_mods)
         wlr_keyboard_notify_modifiers(kb, 0, 0, input->locked_mods, 0);
-
-    xkb_context_unref(ctx);
 }
 
 void handle_keyboard_key(struct wl_listener *listener, void *data)
@@ -57,6 +269,8 @@ void handle_keyboard_key(struct wl_listener *listener, void *data)
 
     wlr_idle_notifier_v1_notify_activity(
         swl_compositor_get_idle_notifier(input->comp), input->seat);
+    if (event->state == WL_KEYBOARD_KEY_STATE_PRESSED)
+        swl_output_note_input(swl_compositor_get_output(input->comp), event->time_msec);
 
     uint32_t keycode = event->keycode + 8;
     const xkb_keysym_t *syms;
@@ -109,4 +323,10 @@ void swl_keyboard_cleanup(SwlInput *input)
 {
     wl_list_remove(&input->keyboard_key.link);
     wl_list_remove(&input->keyboard_modifiers.link);
+
+    for (size_t i = 0; i < MAX_CACHED_KEYMAPS; i++) {
+        free(input->keymaps[i].key);
+        xkb_keymap_unref(input->keymaps[i].keymap);
+    }
+    xkb_context_unref(input->xkb_ctx);
 }
@@ -0,0 +1,127 @@
+#include "motion.h"
+#include <stddef.h>
+
+void swl_motion_init(SwlMotionState *m, int64_t idle_interval_ns)
+{
+    if (!m)
+        return;
+
+    *m = (SwlMotionState){0};
+    m->idle_interval_ns = idle_interval_ns;
+}
+
+bool swl_motion_push(SwlMotionState *m, uint32_t time_msec)
+{
+    if (!m)
+        return false;
+
+    bool first = !m->pending;
+    if (!first)
+        m->coalesced++;
+
+    m->pending = true;
+    m->time_msec = time_msec;
+    return first;
+}
+
+bool swl_motion_take(SwlMotionState *m, uint32_t *time_msec)
+{
+    if (!m || !m->pending)
+        return false;
+
+    m->pending = false;
+    if (time_msec)
+        *time_msec = m->time_msec;
+    return true;
+}
+
+bool swl_motion_should_notify_idle(SwlMotionState *m, int64_t now_ns)
+{
+    if (!m)
+        return false;
+
+    // The first event after a quiet period always goes through, so
+    // waking from idle is never delayed
+    if (m->last_idle_ns != 0 && now_ns - m->last_idle_ns < m->idle_interval_ns)
+        return false;
+
+    m->last_idle_ns = now_ns;
+    return true;
+}
+
+bool swl_motion_box_contains(const SwlMotionBox *box, double x, double y)
+{
+    if (!box || box->width <= 0 || box->height <= 0)
+        return false;
+
+    return x >= box->x && x < box->x + box->width &&
+           y >= box->y && y < box->y + box->height;
+}
+
+bool swl_motion_box_exclude(SwlMotionBox *box, const SwlMotionBox *above, double x, double y)
+{
+    if (!box || !above)
+        return false;
+
+    int bx2 = box->x + box->width, by2 = box->y + box->height;
+    int ax2 = above->x + above->width, ay2 = above->y + above->height;
+
+    // No overlap, nothing to cut
+    if (above->width <= 0 || above->height <= 0 ||
+        ax2 <= box->x || above->x >= bx2 || ay2 <= box->y || above->y >= by2)
+        return box->width > 0 && box->height > 0;
+
+    // Candidate strips of box on each side of above, keep the biggest one
+    // the point is in
+    SwlMotionBox cand[4] = {
+        { box->x, box->y, above->x - box->x, box->height },
+        { ax2, box->y, bx2 - ax2, box->height },
+        { box->x, box->y, box->width, above->y - box->y },
+        { box->x, ay2, box->width, by2 - ay2 },
+    };
+
+    const SwlMotionBox *best = NULL;
+    long best_area = 0;
+    for (size_t i = 0; i < 4; i++) {
+        if (!swl_motion_box_contains(&cand[i], x, y))
+            continue;
+        long area = (long)cand[i].width * cand[i].height;
+        if (area > best_area) {
+            best = &cand[i];
+            best_area = area;
+        }
+    }
+
+    if (!best) {
+        box->width = box->height = 0;
+        return false;
+    }
+
+    *box = *best;
+    return true;
+}
+
+bool swl_motion_hit_cached(const SwlMotionState *m, double x, double y)
+{
+    return m && m->hit_valid && swl_motion_box_contains(&m->hit_box, x, y);
+}
+
+void swl_motion_set_hit(SwlMotionState *m, const SwlMotionBox *box)
+{
+    if (!m)
+        return;
+
+    if (!box || box->width <= 0 || box->height <= 0) {
+        m->hit_valid = false;
+        return;
+    }
+
+    m->hit_box = *box;
+    m->hit_valid = true;
+}
+
+void swl_motion_invalidate(SwlMotionState *m)
+{
+    if (m)
+        m->hit_valid = false;
+}
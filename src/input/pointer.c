@@ -1,18 +1,294 @@
+#define _POSIX_C_SOURCE 200809L
 #include "input_internal.h"
 #include "compositor.h"
 #include "client.h"
 #include "monitor.h"
 #include "scene.h"
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pixman.h>
 #include <wayland-server-core.h>
 #include <wlr/backend/libinput.h>
+#include <wlr/types/wlr_compositor.h>
 #include <wlr/types/wlr_cursor.h>
 #include <wlr/types/wlr_data_device.h>
 #include <wlr/types/wlr_primary_selection.h>
 #include <wlr/types/wlr_idle_notify_v1.h>
+#include <wlr/types/wlr_output.h>
 #include <wlr/types/wlr_pointer.h>
+#include <wlr/types/wlr_pointer_constraints_v1.h>
+#include <wlr/types/wlr_relative_pointer_v1.h>
+#include <wlr/util/region.h>
 #include <scenefx/types/wlr_scene.h>
 #include <libinput.h>
 
+// Idle timeouts are seconds long, telling the notifier about every motion
+// event of a 1kHz mouse only re-arms its timers
+#define IDLE_NOTIFY_INTERVAL_NS (100 * 1000000LL)
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void notify_motion_activity(SwlInput *input)
+{
+    if (swl_motion_should_notify_idle(&input->motion, now_ns()))
+        wlr_idle_notifier_v1_notify_activity(
+            swl_compositor_get_idle_notifier(input->comp), input->seat);
+}
+
+static void clear_hit(SwlInput *input)
+{
+    swl_motion_invalidate(&input->motion);
+    if (input->hit_node) {
+        wl_list_remove(&input->hit_destroy.link);
+        input->hit_node = NULL;
+    }
+}
+
+static void handle_hit_destroy(struct wl_listener *listener, void *data)
+{
+    SwlInput *input = wl_container_of(listener, input, hit_destroy);
+    (void)data;
+
+    clear_hit(input);
+}
+
+static void handle_hit_surface_map(struct wl_listener *listener, void *data)
+{
+    struct SwlHitSurface *hs = wl_container_of(listener, hs, map);
+    (void)data;
+
+    swl_motion_invalidate(&hs->input->motion);
+}
+
+static void handle_hit_surface_unmap(struct wl_listener *listener, void *data)
+{
+    struct SwlHitSurface *hs = wl_container_of(listener, hs, unmap);
+    (void)data;
+
+    swl_motion_invalidate(&hs->input->motion);
+}
+
+static void handle_hit_surface_commit(struct wl_listener *listener, void *data)
+{
+    struct SwlHitSurface *hs = wl_container_of(listener, hs, commit);
+    struct wlr_surface *surface = hs->surface;
+    (void)data;
+
+    // Most commits only bring new content; the hit box only depends on the
+    // surface's size, offset and input region
+    bool resized = surface->current.width != hs->width ||
+                   surface->current.height != hs->height;
+    hs->width = surface->current.width;
+    hs->height = surface->current.height;
+
+    uint32_t geometry = WLR_SURFACE_STATE_INPUT_REGION | WLR_SURFACE_STATE_OFFSET;
+    if (surface->mapped && (resized || (surface->current.committed & geometry)))
+        swl_motion_invalidate(&hs->input->motion);
+}
+
+static void hit_surface_destroy(struct SwlHitSurface *hs)
+{
+    wl_list_remove(&hs->map.link);
+    wl_list_remove(&hs->unmap.link);
+    wl_list_remove(&hs->commit.link);
+    wl_list_remove(&hs->destroy.link);
+    wl_list_remove(&hs->link);
+    free(hs);
+}
+
+static void handle_hit_surface_destroy(struct wl_listener *listener, void *data)
+{
+    struct SwlHitSurface *hs = wl_container_of(listener, hs, destroy);
+    (void)data;
+
+    hit_surface_destroy(hs);
+}
+
+static void handle_new_surface(struct wl_listener *listener, void *data)
+{
+    SwlInput *input = wl_container_of(listener, input, new_surface);
+    struct wlr_surface *surface = data;
+
+    struct SwlHitSurface *hs = calloc(1, sizeof(*hs));
+    if (!hs)
+        return;
+
+    hs->input = input;
+    hs->surface = surface;
+    hs->map.notify = handle_hit_surface_map;
+    wl_signal_add(&surface->events.map, &hs->map);
+    hs->unmap.notify = handle_hit_surface_unmap;
+    wl_signal_add(&surface->events.unmap, &hs->unmap);
+    hs->commit.notify = handle_hit_surface_commit;
+    wl_signal_add(&surface->events.commit, &hs->commit);
+    hs->destroy.notify = handle_hit_surface_destroy;
+    wl_signal_add(&surface->events.destroy, &hs->destroy);
+    wl_list_insert(&input->hit_surfaces, &hs->link);
+}
+
+// Size of the nodes wlr_scene_node_at() can return, and of the scenefx
+// shadow and blur nodes stacked with them. Unknown types report false so
+// they are treated as covering everything.
+static bool node_size(struct wlr_scene_node *node, int *width, int *height)
+{
+    switch (node->type) {
+    case WLR_SCENE_NODE_SHADOW: {
+        struct wlr_scene_shadow *shadow = wl_container_of(node, shadow, node);
+        *width = shadow->width;
+        *height = shadow->height;
+        return true;
+    }
+    case WLR_SCENE_NODE_OPTIMIZED_BLUR: {
+        struct wlr_scene_optimized_blur *blur = wl_container_of(node, blur, node);
+        *width = blur->width;
+        *height = blur->height;
+        return true;
+    }
+    case WLR_SCENE_NODE_RECT: {
+        struct wlr_scene_rect *rect = wlr_scene_rect_from_node(node);
+        *width = rect->width;
+        *height = rect->height;
+        return true;
+    }
+    case WLR_SCENE_NODE_BUFFER: {
+        struct wlr_scene_buffer *buf = wlr_scene_buffer_from_node(node);
+        *width = buf->dst_width;
+        *height = buf->dst_height;
+        if ((*width == 0 || *height == 0) && buf->buffer) {
+            *width = buf->buffer->width;
+            *height = buf->buffer->height;
+            wlr_output_transform_coords(buf->transform, width, height);
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+typedef struct {
+    struct wlr_scene_node *hit;
+    bool above;       // Walk has passed the hit node
+    SwlMotionBox box;
+    double x, y;
+} HitBoxContext;
+
+// Walk bottom to top, cutting everything stacked above the hit node out of
+// the box so the cached result stays exact while the pointer is inside it
+static bool clip_hit_box(struct wlr_scene_node *node, int lx, int ly, HitBoxContext *ctx)
+{
+    if (!node->enabled)
+        return true;
+
+    lx += node->x;
+    ly += node->y;
+
+    if (node == ctx->hit) {
+        ctx->above = true;
+        return true;
+    }
+
+    if (node->type == WLR_SCENE_NODE_TREE) {
+        struct wlr_scene_tree *tree = wlr_scene_tree_from_node(node);
+        struct wlr_scene_node *child;
+        wl_list_for_each(child, &tree->children, link) {
+            if (!clip_hit_box(child, lx, ly, ctx))
+                return false;
+        }
+        return true;
+    }
+
+    if (!ctx->above)
+        return true;
+
+    SwlMotionBox above;
+    if (!node_size(node, &above.width, &above.height)) {
+        ctx->box.width = ctx->box.height = 0;
+        return false;
+    }
+    above.x = lx;
+    above.y = ly;
+
+    return swl_motion_box_exclude(&ctx->box, &above, ctx->x, ctx->y);
+}
+
+static void cache_hit(SwlInput *input, struct wlr_scene *scene, struct wlr_scene_node *node,
+                      double sx, double sy)
+{
+    int lx, ly, width, height;
+    if (!wlr_scene_node_coords(node, &lx, &ly) || !node_size(node, &width, &height))
+        return;
+
+    HitBoxContext ctx = {
+        .hit = node,
+        .box = { lx, ly, width, height },
+        .x = input->cursor->x,
+        .y = input->cursor->y,
+    };
+
+    // Surfaces only take input inside their input region
+    if (node->type == WLR_SCENE_NODE_BUFFER) {
+        struct wlr_scene_surface *scene_surface =
+            wlr_scene_surface_try_from_buffer(wlr_scene_buffer_from_node(node));
+        if (scene_surface) {
+            pixman_box32_t rect;
+            if (!pixman_region32_contains_point(&scene_surface->surface->input_region,
+                                                (int)sx, (int)sy, &rect))
+                return;
+            SwlMotionBox input_box = {
+                lx + rect.x1, ly + rect.y1, rect.x2 - rect.x1, rect.y2 - rect.y1,
+            };
+            int x2 = ctx.box.x + ctx.box.width, y2 = ctx.box.y + ctx.box.height;
+            int ix2 = input_box.x + input_box.width, iy2 = input_box.y + input_box.height;
+            ctx.box.x = input_box.x > ctx.box.x ? input_box.x : ctx.box.x;
+            ctx.box.y = input_box.y > ctx.box.y ? input_box.y : ctx.box.y;
+            ctx.box.width = (ix2 < x2 ? ix2 : x2) - ctx.box.x;
+            ctx.box.height = (iy2 < y2 ? iy2 : y2) - ctx.box.y;
+        }
+    }
+
+    if (!clip_hit_box(&scene->tree.node, 0, 0, &ctx))
+        return;
+
+    swl_motion_set_hit(&input->motion, &ctx.box);
+    if (!input->motion.hit_valid)
+        return;
+
+    input->hit_node = node;
+    input->hit_lx = lx;
+    input->hit_ly = ly;
+    input->hit_destroy.notify = handle_hit_destroy;
+    wl_signal_add(&node->events.destroy, &input->hit_destroy);
+}
+
+// wlr_scene_node_at() with the last result reused while the pointer stays
+// in an area where nothing else can be hit
+static struct wlr_scene_node *pointer_node_at(SwlInput *input, double *sx, double *sy)
+{
+    double x = input->cursor->x, y = input->cursor->y;
+
+    if (input->hit_node && swl_motion_hit_cached(&input->motion, x, y)) {
+        *sx = x - input->hit_lx;
+        *sy = y - input->hit_ly;
+        return input->hit_node;
+    }
+
+    clear_hit(input);
+
+    struct wlr_scene *scene = swl_compositor_get_scene(input->comp);
+    struct wlr_scene_node *node = wlr_scene_node_at(&scene->tree.node, x, y, sx, sy);
+    if (node)
+        cache_hit(input, scene, node, *sx, *sy);
+
+    return node;
+}
+
 static void process_cursor_motion(SwlInput *input, uint32_t time)
 {
     // Handle move/resize if active
@@ -21,10 +297,7 @@ static void process_cursor_motion(SwlInput *input, uint32_t time)
         if (c) {
             int new_x = (int)input->cursor->x - input->grab_x;
             int new_y = (int)input->cursor->y - input->grab_y;
-            SwlClientInfo info = swl_client_get_info(c);
-            int bw2 = 2 * info.border_width;
-            swl_client_resize(c, new_x, new_y,
-                info.geometry.width + bw2, info.geometry.height + bw2);
+            swl_client_move(c, new_x, new_y);
         }
         return;
     } else if (input->cursor_mode == SWL_CURSOR_RESIZE) {
@@ -35,26 +308,35 @@ static void process_cursor_motion(SwlInput *input, uint32_t time)
             int new_height = (int)input->cursor->y - info.geometry.y;
             if (new_width < 50) new_width = 50;
             if (new_height < 50) new_height = 50;
-            swl_client_resize(c, info.geometry.x, info.geometry.y, new_width, new_height);
+            swl_client_resize_interactive(c, info.geometry.x, info.geometry.y,
+                                          new_width, new_height);
         }
         return;
     }
 
-    // Update focused monitor to follow cursor
+    // Update focused monitor to follow cursor, the layout only needs
+    // querying once the cursor leaves the focused one
     SwlOutputManager *output_mgr = swl_compositor_get_output(input->comp);
-    SwlMonitor *mon = swl_monitor_at(output_mgr, input->cursor->x, input->cursor->y);
-    if (mon && mon != swl_monitor_get_focused(output_mgr))
-        swl_monitor_focus(mon);
+    SwlMonitor *focused = swl_monitor_get_focused(output_mgr);
+    SwlMotionBox mon_box = {0};
+    if (focused) {
+        SwlMonitorInfo info = swl_monitor_get_info(focused);
+        mon_box = (SwlMotionBox){ info.x, info.y, info.width, info.height };
+    }
+    if (!swl_motion_box_contains(&mon_box, input->cursor->x, input->cursor->y)) {
+        SwlMonitor *mon = swl_monitor_at(output_mgr, input->cursor->x, input->cursor->y);
+        if (mon && mon != focused)
+            swl_monitor_focus(mon);
+    }
 
     // Normal cursor motion handling
-    struct wlr_scene *scene = swl_compositor_get_scene(input->comp);
     double sx, sy;
-    struct wlr_scene_node *node = wlr_scene_node_at(&scene->tree.node,
-        input->cursor->x, input->cursor->y, &sx, &sy);
+    struct wlr_scene_node *node = pointer_node_at(input, &sx, &sy);
 
     if (!node) {
         wlr_cursor_set_xcursor(input->cursor, input->xcursor_mgr, "default");
         wlr_seat_pointer_clear_focus(input->seat);
+        swl_pointer_update_constraint(input);
         return;
     }
 
@@ -71,17 +353,88 @@ static void process_cursor_motion(SwlInput *input, uint32_t time)
     struct wlr_surface *surface = scene_surface->surface;
     wlr_seat_pointer_notify_enter(input->seat, surface, sx, sy);
     wlr_seat_pointer_notify_motion(input->seat, time, sx, sy);
+    swl_pointer_update_constraint(input);
+}
+
+// Apply the newest pending motion, returns true if there was one
+static bool flush_motion(SwlInput *input)
+{
+    uint32_t time;
+    if (!swl_motion_take(&input->motion, &time))
+        return false;
+
+    process_cursor_motion(input, time);
+    return true;
 }
 
+static void handle_motion_idle(void *data)
+{
+    SwlInput *input = data;
+
+    input->motion_idle = NULL;
+    if (flush_motion(input))
+        wlr_seat_pointer_notify_frame(input->seat);
+}
+
+// Constraints only apply to the surface they belong to, and not while a
+// move/resize grab owns the pointer
+static bool pointer_constrained(SwlInput *input)
+{
+    return input->active_constraint && input->cursor_mode == SWL_CURSOR_NORMAL &&
+           input->active_constraint->surface == input->seat->pointer_state.focused_surface;
+}
+
+// A constrained pointer can't leave its surface, so there is nothing to
+// hit-test: motion goes straight to the client
+static void constrained_motion(SwlInput *input, struct wlr_input_device *dev,
+                               uint32_t time, double dx, double dy)
+{
+    struct wlr_pointer_constraint_v1 *constraint = input->active_constraint;
+
+    // Surface-local position below must be current
+    flush_motion(input);
+
+    if (constraint->type == WLR_POINTER_CONSTRAINT_V1_LOCKED)
+        return;
+
+    double sx = input->seat->pointer_state.sx;
+    double sy = input->seat->pointer_state.sy;
+    double cx, cy;
+    // No point of the region is reachable, so the motion is dropped
+    if (!wlr_region_confine(&constraint->region, sx, sy, sx + dx, sy + dy, &cx, &cy))
+        return;
+    dx = cx - sx;
+    dy = cy - sy;
+
+    double old_x = input->cursor->x, old_y = input->cursor->y;
+    wlr_cursor_move(input->cursor, dev, dx, dy);
+    wlr_seat_pointer_notify_motion(input->seat, time,
+        sx + input->cursor->x - old_x, sy + input->cursor->y - old_y);
+}
+
+// The cursor image moves right away, focus, hit-testing and the events sent
+// to clients wait for the frame (see handle_cursor_frame)
 void handle_cursor_motion(struct wl_listener *listener, void *data)
 {
     SwlInput *input = wl_container_of(listener, input, cursor_motion);
     struct wlr_pointer_motion_event *event = data;
 
-    wlr_idle_notifier_v1_notify_activity(
-        swl_compositor_get_idle_notifier(input->comp), input->seat);
+    notify_motion_activity(input);
+    swl_output_note_input(swl_compositor_get_output(input->comp), event->time_msec);
+
+    // Raw deltas before acceleration and constraints, for games and 3D tools
+    wlr_relative_pointer_manager_v1_send_relative_motion(input->relative_pointer_mgr,
+        input->seat, (uint64_t)event->time_msec * 1000,
+        event->delta_x, event->delta_y, event->unaccel_dx, event->unaccel_dy);
+
+    if (pointer_constrained(input)) {
+        constrained_motion(input, &event->pointer->base, event->time_msec,
+                           event->delta_x, event->delta_y);
+        return;
+    }
+
     wlr_cursor_move(input->cursor, &event->pointer->base, event->delta_x, event->delta_y);
-    process_cursor_motion(input, event->time_msec);
+    swl_motion_push(&input->motion, event->time_msec);
 }
 
 void handle_cursor_motion_abs(struct wl_listener *listener, void *data)
@@ -89,18 +442,142 @@ void handle_cursor_motion_abs(struct wl_listener *listener, void *data)
     SwlInput *input = wl_container_of(listener, input, cursor_motion_abs);
     struct wlr_pointer_motion_absolute_event *event = data;
 
-    wlr_idle_notifier_v1_notify_activity(
-        swl_compositor_get_idle_notifier(input->comp), input->seat);
+    notify_motion_activity(input);
+    swl_output_note_input(swl_compositor_get_output(input->comp), event->time_msec);
+
+    if (pointer_constrained(input)) {
+        double lx, ly;
+        wlr_cursor_absolute_to_layout_coords(input->cursor, &event->pointer->base,
+                                             event->x, event->y, &lx, &ly);
+        constrained_motion(input, &event->pointer->base, event->time_msec,
+                           lx - input->cursor->x, ly - input->cursor->y);
+        return;
+    }
+
     wlr_cursor_warp_absolute(input->cursor, &event->pointer->base, event->x, event->y);
-    process_cursor_motion(input, event->time_msec);
+    swl_motion_push(&input->motion, event->time_msec);
+}
+
+// Put the cursor where the client last said the locked pointer should be
+static void warp_to_cursor_hint(SwlInput *input, struct wlr_pointer_constraint_v1 *constraint)
+{
+    if (!constraint->current.cursor_hint.enabled ||
+        constraint->surface != input->seat->pointer_state.focused_surface)
+        return;
+
+    double hx = constraint->current.cursor_hint.x;
+    double hy = constraint->current.cursor_hint.y;
+    double origin_x = input->cursor->x - input->seat->pointer_state.sx;
+    double origin_y = input->cursor->y - input->seat->pointer_state.sy;
+
+    wlr_cursor_warp(input->cursor, NULL, origin_x + hx, origin_y + hy);
+    wlr_seat_pointer_warp(input->seat, hx, hy);
+}
+
+static void set_constraint(SwlInput *input, struct wlr_pointer_constraint_v1 *constraint)
+{
+    if (input->active_constraint == constraint)
+        return;
+
+    if (input->active_constraint) {
+        warp_to_cursor_hint(input, input->active_constraint);
+        wlr_pointer_constraint_v1_send_deactivated(input->active_constraint);
+    }
+
+    input->active_constraint = constraint;
+    if (constraint)
+        wlr_pointer_constraint_v1_send_activated(constraint);
+}
+
+// A constraint is active while its surface has both pointer and keyboard
+// focus
+void swl_pointer_update_constraint(SwlInput *input)
+{
+    if (!input || !input->pointer_constraints)
+        return;
+
+    struct wlr_surface *ptr = input->seat->pointer_state.focused_surface;
+    struct wlr_surface *kb = input->seat->keyboard_state.focused_surface;
+
+    struct wlr_pointer_constraint_v1 *constraint = NULL;
+    if (ptr && kb && wlr_surface_get_root_surface(ptr) == wlr_surface_get_root_surface(kb))
+        constraint = wlr_pointer_constraints_v1_constraint_for_surface(
+            input->pointer_constraints, ptr, input->seat);
+
+    set_constraint(input, constraint);
+}
+
+// A client can shrink or move the region of a confined pointer, a cursor
+// left outside goes to the middle of the region's first rectangle
+static void handle_constraint_set_region(struct wl_listener *listener, void *data)
+{
+    struct SwlPointerConstraint *pc = wl_container_of(listener, pc, set_region);
+    SwlInput *input = pc->input;
+    (void)data;
+
+    if (input->active_constraint != pc->constraint || !pointer_constrained(input) ||
+        pc->constraint->type != WLR_POINTER_CONSTRAINT_V1_CONFINED)
+        return;
+
+    flush_motion(input);
+
+    double sx = input->seat->pointer_state.sx;
+    double sy = input->seat->pointer_state.sy;
+    if (pixman_region32_contains_point(&pc->constraint->region, (int)floor(sx),
+                                       (int)floor(sy), NULL))
+        return;
+
+    int nboxes;
+    pixman_box32_t *boxes = pixman_region32_rectangles(&pc->constraint->region, &nboxes);
+    if (nboxes == 0)
+        return;
+
+    double cx = (boxes[0].x1 + boxes[0].x2) / 2.0;
+    double cy = (boxes[0].y1 + boxes[0].y2) / 2.0;
+    wlr_cursor_warp(input->cursor, NULL, input->cursor->x - sx + cx,
+                    input->cursor->y - sy + cy);
+    wlr_seat_pointer_warp(input->seat, cx, cy);
+}
+
+static void handle_constraint_destroy(struct wl_listener *listener, void *data)
+{
+    struct SwlPointerConstraint *pc = wl_container_of(listener, pc, destroy);
+    (void)data;
+
+    // Destroyed constraints must not be sent deactivated
+    if (pc->input->active_constraint == pc->constraint) {
+        warp_to_cursor_hint(pc->input, pc->constraint);
+        pc->input->active_constraint = NULL;
+    }
+
+    wl_list_remove(&pc->set_region.link);
+    wl_list_remove(&pc->destroy.link);
+    free(pc);
+}
+
+static void handle_new_constraint(struct wl_listener *listener, void *data)
+{
+    SwlInput *input = wl_container_of(listener, input, new_constraint);
+    struct wlr_pointer_constraint_v1 *constraint = data;
+
+    struct SwlPointerConstraint *pc = calloc(1, sizeof(*pc));
+    if (!pc)
+        return;
+
+    pc->input = input;
+    pc->constraint = constraint;
+    pc->set_region.notify = handle_constraint_set_region;
+    wl_signal_add(&constraint->events.set_region, &pc->set_region);
+    pc->destroy.notify = handle_constraint_destroy;
+    wl_signal_add(&constraint->events.destroy, &pc->destroy);
+
+    swl_pointer_update_constraint(input);
 }
 
 SwlClient *client_at_cursor(SwlInput *input)
 {
-    struct wlr_scene *scene = swl_compositor_get_scene(input->comp);
     double sx, sy;
-    struct wlr_scene_node *node = wlr_scene_node_at(&scene->tree.node,
-        input->cursor->x, input->cursor->y, &sx, &sy);
+    struct wlr_scene_node *node = pointer_node_at(input, &sx, &sy);
 
     // Walk up to find client
     while (node && !node->data) {
@@ -126,6 +603,12 @@ void handle_cursor_button(struct wl_listener *listener, void *data)
     wlr_idle_notifier_v1_notify_activity(
         swl_compositor_get_idle_notifier(input->comp), input->seat);
 
+    if (event->state == WL_POINTER_BUTTON_STATE_PRESSED)
+        swl_output_note_input(swl_compositor_get_output(input->comp), event->time_msec);
+
+    // Clients must see the pointer where the button happened
+    flush_motion(input);
+
     // End move/resize on button release
     if (event->state == WL_POINTER_BUTTON_STATE_RELEASED) {
         if (input->cursor_mode != SWL_CURSOR_NORMAL) {
@@ -163,6 +646,8 @@ void handle_cursor_axis(struct wl_listener *listener, void *data)
 
     wlr_idle_notifier_v1_notify_activity(
         swl_compositor_get_idle_notifier(input->comp), input->seat);
+    swl_output_note_input(swl_compositor_get_output(input->comp), event->time_msec);
+    flush_motion(input);
     wlr_seat_pointer_notify_axis(input->seat, event->time_msec, event->orientation,
         event->delta, event->delta_discrete, event->source, event->relative_direction);
 }
@@ -172,6 +657,19 @@ void handle_cursor_frame(struct wl_listener *listener, void *data)
     SwlInput *input = wl_container_of(listener, input, cursor_frame);
     (void)data;
 
+    // Frames carrying motion are merged until the event loop has drained
+    // everything the devices queued, then applied once
+    if (input->motion.pending) {
+        if (!input->motion_idle) {
+            struct wl_event_loop *loop = wl_display_get_event_loop(
+                swl_compositor_get_wl_display(input->comp));
+            input->motion_idle = wl_event_loop_add_idle(loop, handle_motion_idle, input);
+        }
+        if (input->motion_idle)
+            return;
+        flush_motion(input);
+    }
+
     wlr_seat_pointer_notify_frame(input->seat);
 }
 
@@ -329,6 +827,14 @@ void swl_pointer_reconfigure_all(SwlInput *input)
 
 void swl_pointer_setup(SwlInput *input)
 {
+    swl_motion_init(&input->motion, IDLE_NOTIFY_INTERVAL_NS);
+
+    struct wl_display *display = swl_compositor_get_wl_display(input->comp);
+    input->relative_pointer_mgr = wlr_relative_pointer_manager_v1_create(display);
+    input->pointer_constraints = wlr_pointer_constraints_v1_create(display);
+    input->new_constraint.notify = handle_new_constraint;
+    wl_signal_add(&input->pointer_constraints->events.new_constraint, &input->new_constraint);
+
     input->cursor_motion.notify = handle_cursor_motion;
     wl_signal_add(&input->cursor->events.motion, &input->cursor_motion);
 
@@ -358,10 +864,27 @@ void swl_pointer_setup(SwlInput *input)
 
     input->start_drag.notify = handle_start_drag;
     wl_signal_add(&input->seat->events.start_drag, &input->start_drag);
+
+    // Surface changes that move hit boxes around; scene changes made by the
+    // compositor itself go through swl_input_scene_changed()
+    struct wlr_compositor *compositor = swl_compositor_get_wlr_compositor(input->comp);
+    wl_list_init(&input->hit_surfaces);
+    input->new_surface.notify = handle_new_surface;
+    wl_signal_add(&compositor->events.new_surface, &input->new_surface);
 }
 
 void swl_pointer_cleanup(SwlInput *input)
 {
+    if (input->motion_idle)
+        wl_event_source_remove(input->motion_idle);
+    clear_hit(input);
+    wl_list_remove(&input->new_constraint.link);
+
+    wl_list_remove(&input->new_surface.link);
+    struct SwlHitSurface *hs, *tmp;
+    wl_list_for_each_safe(hs, tmp, &input->hit_surfaces, link)
+        hit_surface_destroy(hs);
+
     wl_list_remove(&input->cursor_motion.link);
     wl_list_remove(&input->cursor_motion_abs.link);
     wl_list_remove(&input->cursor_button.link);
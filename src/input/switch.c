@@ -2,8 +2,8 @@
 #include "compositor.h"
 #include "config.h"
 #include "events.h"
+#include "process.h"
 #include <stdlib.h>
-#include <unistd.h>
 #include <wlr/types/wlr_switch.h>
 
 void handle_switch_toggle(struct wl_listener *listener, void *data)
@@ -21,13 +21,8 @@ void handle_switch_toggle(struct wl_listener *listener, void *data)
 
         SwlConfig *cfg = swl_compositor_get_config(input->comp);
         const char *cmd = swl_config_get_string(cfg, "lid.command", "");
-        if (cmd && cmd[0] != '\0') {
-            if (fork() == 0) {
-                setsid();
-                execl("/bin/sh", "/bin/sh", "-c", cmd, NULL);
-                _exit(1);
-            }
-        }
+        if (cmd && cmd[0] != '\0')
+            swl_process_spawn_shell(swl_compositor_get_processes(input->comp), cmd);
 
         swl_event_bus_emit_simple(bus, SWL_EVENT_LID_CLOSE, NULL);
     } else {
@@ -9,66 +9,100 @@
 #include "layer.h"
 #include "layout.h"
 #include "monitor.h"
+#include "process.h"
+#include "profile.h"
 #include "render.h"
-#include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <time.h>
 
-typedef struct {
-    char *json;
-    int offset;
-    bool first;
-} GetWindowsCtx;
+static void serialize_client_info(SwlJsonWriter *w, const SwlClientInfo *info)
+{
+    swl_json_begin_object(w);
+    swl_json_field_uint(w, "id", info->id);
+    swl_json_field_string(w, "app_id", info->app_id);
+    swl_json_field_string(w, "title", info->title);
+    swl_json_field_int(w, "x", info->geometry.x);
+    swl_json_field_int(w, "y", info->geometry.y);
+    swl_json_field_int(w, "width", info->geometry.width);
+    swl_json_field_int(w, "height", info->geometry.height);
+    swl_json_field_bool(w, "floating", info->floating);
+    swl_json_field_bool(w, "fullscreen", info->fullscreen);
+    swl_json_field_bool(w, "focused", info->focused);
+    swl_json_end_object(w);
+}
 
-static bool get_windows_iter(SwlClient *c, void *data)
+static void serialize_monitor_info(SwlJsonWriter *w, const SwlMonitorInfo *info)
 {
-    GetWindowsCtx *ctx = data;
-    SwlClientInfo info = swl_client_get_info(c);
+    swl_json_begin_object(w);
+    swl_json_field_uint(w, "id", info->id);
+    swl_json_field_string(w, "name", info->name);
+    swl_json_field_int(w, "x", info->x);
+    swl_json_field_int(w, "y", info->y);
+    swl_json_field_int(w, "width", info->width);
+    swl_json_field_int(w, "height", info->height);
+    swl_json_field_double(w, "scale", info->scale, 2);
+    swl_json_field_bool(w, "enabled", info->enabled);
+    swl_json_field_int(w, "max_render_time", info->max_render_time);
+    swl_json_field_int(w, "render_time_us", info->render_time_us);
+    swl_json_end_object(w);
+}
 
-    if (!ctx->first) ctx->offset += sprintf(ctx->json + ctx->offset, ",");
-    ctx->first = false;
-
-    ctx->offset += sprintf(ctx->json + ctx->offset,
-        "{\"id\":%u,\"app_id\":\"%s\",\"title\":\"%s\","
-        "\"x\":%d,\"y\":%d,\"width\":%d,\"height\":%d,"
-        "\"floating\":%s,\"fullscreen\":%s,\"focused\":%s}",
-        info.id,
-        info.app_id ? info.app_id : "",
-        info.title ? info.title : "",
-        info.geometry.x, info.geometry.y,
-        info.geometry.width, info.geometry.height,
-        info.floating ? "true" : "false",
-        info.fullscreen ? "true" : "false",
-        info.focused ? "true" : "false");
+static void serialize_layer_info(SwlJsonWriter *w, const SwlLayerSurfaceInfo *info)
+{
+    swl_json_begin_object(w);
+    swl_json_field_string(w, "namespace", info->namespace);
+    swl_json_field_int(w, "x", info->x);
+    swl_json_field_int(w, "y", info->y);
+    swl_json_field_int(w, "width", info->width);
+    swl_json_field_int(w, "height", info->height);
+    swl_json_field_int(w, "layer", (int)info->layer);
+    swl_json_field_bool(w, "mapped", info->mapped);
+    swl_json_end_object(w);
+}
+
+// Start a reply in the writer shared by all requests; finish it with
+// json_reply(). The socket writes it out before the next request runs.
+static SwlJsonWriter *reply_writer(SwlCompositor *comp)
+{
+    SwlIPC *ipc = swl_compositor_get_ipc(comp);
+    swl_json_reset(&ipc->reply);
+    return &ipc->reply;
+}
+
+static SwlIPCResponse json_reply(SwlJsonWriter *w)
+{
+    SwlIPCResponse r = {.success = !w->failed};
+    if (w->failed) {
+        r.error = strdup("out of memory");
+    } else {
+        r.shared_json = swl_json_cstr(w);
+        r.shared_len = swl_json_len(w);
+    }
+    return r;
+}
 
+static bool get_windows_iter(SwlClient *c, void *data)
+{
+    SwlJsonWriter *w = data;
+    SwlClientInfo info = swl_client_get_info(c);
+    serialize_client_info(w, &info);
     return true;
 }
 
 static SwlIPCResponse cmd_get_windows(SwlCompositor *comp, const char *args)
 {
     (void)args;
-    SwlIPCResponse r = {.success = true};
+    SwlJsonWriter *w = reply_writer(comp);
 
+    swl_json_begin_array(w);
     SwlClientManager *mgr = swl_compositor_get_clients(comp);
-    if (!mgr) {
-        r.json = strdup("[]");
-        return r;
-    }
-
-    GetWindowsCtx ctx = {
-        .json = malloc(BUFFER_SIZE),
-        .offset = 0,
-        .first = true,
-    };
-    ctx.offset += sprintf(ctx.json + ctx.offset, "[");
+    if (mgr)
+        swl_client_foreach(mgr, get_windows_iter, w);
+    swl_json_end_array(w);
 
-    swl_client_foreach(mgr, get_windows_iter, &ctx);
-
-    ctx.offset += sprintf(ctx.json + ctx.offset, "]");
-    r.json = ctx.json;
-    return r;
+    return json_reply(w);
 }
 
 static SwlIPCResponse cmd_quit(SwlCompositor *comp, const char *args)
@@ -123,43 +157,127 @@ static SwlIPCResponse cmd_reload_config(SwlCompositor *comp, const char *args)
 static SwlIPCResponse cmd_get_monitors(SwlCompositor *comp, const char *args)
 {
     (void)args;
-    SwlIPCResponse r = {.success = true};
+    SwlJsonWriter *w = reply_writer(comp);
 
+    swl_json_begin_array(w);
     SwlOutputManager *output = swl_compositor_get_output(comp);
-    if (!output) {
-        r.json = strdup("[]");
+    size_t count = output ? swl_monitor_count(output) : 0;
+    for (size_t i = 0; i < count; i++) {
+        SwlMonitor *mon = swl_monitor_by_index(output, i);
+        if (!mon) continue;
+
+        SwlMonitorInfo info = swl_monitor_get_info(mon);
+        serialize_monitor_info(w, &info);
+    }
+    swl_json_end_array(w);
+
+    return json_reply(w);
+}
+
+static SwlIPCResponse cmd_get_render_quality(SwlCompositor *comp, const char *args)
+{
+    (void)args;
+    SwlIPCResponse r = {.success = true};
+
+    SwlRenderer *renderer = swl_compositor_get_renderer(comp);
+    if (!renderer) {
+        r.success = false;
+        r.error = strdup("renderer not available");
         return r;
     }
 
-    char *json = malloc(BUFFER_SIZE);
-    int offset = 0;
-    offset += sprintf(json + offset, "[");
+    SwlRenderQuality q = swl_renderer_get_quality(renderer);
+    SwlJsonWriter *w = reply_writer(comp);
+    swl_json_begin_object(w);
+    swl_json_field_bool(w, "governor", q.governor_enabled);
+    swl_json_field_int(w, "level", q.level);
+    swl_json_field_int(w, "max_level", q.max_level);
+    swl_json_field_int(w, "blur_passes", q.blur_passes);
+    swl_json_field_int(w, "blur_radius", q.blur_radius);
+    swl_json_field_bool(w, "unfocused_shadows", q.unfocused_shadows);
+    swl_json_end_object(w);
+    return json_reply(w);
+}
 
-    bool first = true;
-    size_t count = swl_monitor_count(output);
+static SwlIPCResponse cmd_get_mode(SwlCompositor *comp, const char *args)
+{
+    (void)args;
+    SwlIPCResponse r = {.success = true};
+
+    SwlInput *input = swl_compositor_get_input(comp);
+    SwlKeybindingManager *kb = input ? swl_input_get_keybindings(input) : NULL;
+    if (!kb) {
+        r.success = false;
+        r.error = strdup("keybinding manager not available");
+        return r;
+    }
+
+    SwlJsonWriter *w = reply_writer(comp);
+    swl_json_begin_object(w);
+    swl_json_field_string(w, "mode", swl_keybinding_get_mode(kb));
+    swl_json_end_object(w);
+    return json_reply(w);
+}
+
+static SwlIPCResponse cmd_get_latency(SwlCompositor *comp, const char *args)
+{
+    (void)args;
+    SwlJsonWriter *w = reply_writer(comp);
+
+    swl_json_begin_array(w);
+    SwlOutputManager *output = swl_compositor_get_output(comp);
+    size_t count = output ? swl_monitor_count(output) : 0;
     for (size_t i = 0; i < count; i++) {
         SwlMonitor *mon = swl_monitor_by_index(output, i);
         if (!mon) continue;
 
         SwlMonitorInfo info = swl_monitor_get_info(mon);
+        SwlLatencySummary lat = swl_monitor_get_latency(mon);
+
+        swl_json_begin_object(w);
+        swl_json_field_string(w, "name", info.name);
+        swl_json_field_uint(w, "samples", lat.samples);
+        swl_json_field_uint(w, "total", lat.total);
+        swl_json_field_int(w, "p50_us", lat.p50_ns / 1000);
+        swl_json_field_int(w, "p95_us", lat.p95_ns / 1000);
+        swl_json_field_int(w, "p99_us", lat.p99_ns / 1000);
+        swl_json_end_object(w);
+    }
+    swl_json_end_array(w);
 
-        if (!first) offset += sprintf(json + offset, ",");
-        first = false;
+    return json_reply(w);
+}
 
-        offset += sprintf(json + offset,
-            "{\"id\":%u,\"name\":\"%s\",\"x\":%d,\"y\":%d,"
-            "\"width\":%d,\"height\":%d,\"scale\":%.2f,"
-            "\"enabled\":%s}",
-            info.id,
-            info.name ? info.name : "",
-            info.x, info.y, info.width, info.height,
-            info.scale,
-            info.enabled ? "true" : "false");
+static SwlIPCResponse cmd_get_startup_profile(SwlCompositor *comp, const char *args)
+{
+    (void)args;
+    SwlJsonWriter *w = reply_writer(comp);
+    const SwlStartupProfile *profile = swl_compositor_get_startup_profile(comp);
+
+    swl_json_begin_object(w);
+    if (profile) {
+        swl_json_field_int(w, "total_us", swl_profile_total(profile) / 1000);
+        swl_json_key(w, "first_frame_us");
+        if (profile->first_frame_ns > 0)
+            swl_json_int(w, profile->first_frame_ns / 1000);
+        else
+            swl_json_null(w);
+
+        swl_json_key(w, "phases");
+        swl_json_begin_array(w);
+        for (size_t i = 0; i < profile->count; i++) {
+            const SwlProfilePhase *phase = &profile->phases[i];
+            swl_json_begin_object(w);
+            swl_json_field_string(w, "name", phase->name);
+            swl_json_field_int(w, "start_us", phase->start_ns / 1000);
+            swl_json_field_int(w, "duration_us", phase->duration_ns / 1000);
+            swl_json_end_object(w);
+        }
+        swl_json_end_array(w);
     }
+    swl_json_end_object(w);
 
-    offset += sprintf(json + offset, "]");
-    r.json = json;
-    return r;
+    return json_reply(w);
 }
 
 static SwlIPCResponse cmd_focus(SwlCompositor *comp, const char *args)
@@ -249,30 +367,20 @@ static SwlIPCResponse cmd_layout(SwlCompositor *comp, const char *args)
 static SwlIPCResponse cmd_get_layouts(SwlCompositor *comp, const char *args)
 {
     (void)args;
-    SwlIPCResponse r = {.success = true};
+    SwlJsonWriter *w = reply_writer(comp);
 
+    swl_json_begin_array(w);
     SwlLayoutRegistry *layouts = swl_compositor_get_layouts(comp);
-    if (!layouts) {
-        r.json = strdup("[]");
-        return r;
+    if (layouts) {
+        size_t count;
+        const char **names = swl_layout_list(layouts, &count);
+        for (size_t i = 0; names && i < count; i++)
+            swl_json_string(w, names[i]);
+        free((void *)names);
     }
+    swl_json_end_array(w);
 
-    size_t count;
-    const char **names = swl_layout_list(layouts, &count);
-
-    char *json = malloc(BUFFER_SIZE);
-    int offset = 0;
-    offset += sprintf(json + offset, "[");
-
-    for (size_t i = 0; i < count; i++) {
-        if (i > 0) offset += sprintf(json + offset, ",");
-        offset += sprintf(json + offset, "\"%s\"", names[i]);
-    }
-
-    offset += sprintf(json + offset, "]");
-    free((void *)names);
-    r.json = json;
-    return r;
+    return json_reply(w);
 }
 
 static SwlIPCResponse cmd_output_power(SwlCompositor *comp, const char *args)
@@ -360,10 +468,15 @@ static const char *event_type_names[] = {
     [SWL_EVENT_SESSION_UNLOCK]  = "session_unlock",
     [SWL_EVENT_LID_CLOSE]       = "lid_close",
     [SWL_EVENT_LID_OPEN]        = "lid_open",
+    [SWL_EVENT_MODE_CHANGE]     = "mode_change",
+    [SWL_EVENT_PROCESS_EXIT]    = "process_exit",
 };
 
 #define EVENT_TYPE_COUNT (sizeof(event_type_names) / sizeof(event_type_names[0]))
 
+// Subscriber masks are one bit per event type
+_Static_assert(SWL_EVENT_TYPE_COUNT <= 32, "event type does not fit the subscriber mask");
+
 static int event_type_from_name(const char *name)
 {
     for (size_t i = 0; i < EVENT_TYPE_COUNT; i++) {
@@ -373,46 +486,6 @@ static int event_type_from_name(const char *name)
     return -1;
 }
 
-static int serialize_client_info(char *buf, size_t bufsize, const SwlClientInfo *info)
-{
-    return snprintf(buf, bufsize,
-        "{\"id\":%u,\"app_id\":\"%s\",\"title\":\"%s\","
-        "\"x\":%d,\"y\":%d,\"width\":%d,\"height\":%d,"
-        "\"floating\":%s,\"fullscreen\":%s,\"focused\":%s}",
-        info->id,
-        info->app_id ? info->app_id : "",
-        info->title ? info->title : "",
-        info->geometry.x, info->geometry.y,
-        info->geometry.width, info->geometry.height,
-        info->floating ? "true" : "false",
-        info->fullscreen ? "true" : "false",
-        info->focused ? "true" : "false");
-}
-
-static int serialize_monitor_info(char *buf, size_t bufsize, const SwlMonitorInfo *info)
-{
-    return snprintf(buf, bufsize,
-        "{\"id\":%u,\"name\":\"%s\",\"x\":%d,\"y\":%d,"
-        "\"width\":%d,\"height\":%d,\"scale\":%.2f,"
-        "\"enabled\":%s}",
-        info->id,
-        info->name ? info->name : "",
-        info->x, info->y, info->width, info->height,
-        info->scale,
-        info->enabled ? "true" : "false");
-}
-
-static int serialize_layer_info(char *buf, size_t bufsize, const SwlLayerSurfaceInfo *info)
-{
-    return snprintf(buf, bufsize,
-        "{\"namespace\":\"%s\",\"x\":%d,\"y\":%d,"
-        "\"width\":%d,\"height\":%d,\"layer\":%d,\"mapped\":%s}",
-        info->namespace ? info->namespace : "",
-        info->x, info->y, info->width, info->height,
-        (int)info->layer,
-        info->mapped ? "true" : "false");
-}
-
 static uint64_t get_timestamp_ms(void)
 {
     struct timespec ts;
@@ -420,25 +493,45 @@ static uint64_t get_timestamp_ms(void)
     return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
 }
 
-static void ipc_event_handler(void *ctx, const SwlEvent *event)
+// Which object an event is about, so coalescing only folds events together
+// that describe the same window, output or process
+static uint64_t event_key(const SwlEvent *event)
 {
-    SwlIPC *ipc = ctx;
-    if (!ipc || ipc->subscriber_count == 0)
-        return;
+    if (!event->data)
+        return 0;
 
-    if ((size_t)event->type >= EVENT_TYPE_COUNT)
-        return;
-
-    const char *event_name = event_type_names[event->type];
-    if (!event_name)
-        return;
-
-    char buf[BUFFER_SIZE];
-    int offset = 0;
-    uint64_t ts = get_timestamp_ms();
+    switch (event->type) {
+    case SWL_EVENT_CLIENT_CREATE:
+    case SWL_EVENT_CLIENT_DESTROY:
+    case SWL_EVENT_CLIENT_FOCUS:
+    case SWL_EVENT_CLIENT_UNFOCUS:
+    case SWL_EVENT_CLIENT_FULLSCREEN:
+    case SWL_EVENT_CLIENT_FLOAT:
+    case SWL_EVENT_CLIENT_MOVE:
+    case SWL_EVENT_CLIENT_RESIZE:
+    case SWL_EVENT_CLIENT_URGENT:
+        return swl_client_get_info(event->data).id;
+    case SWL_EVENT_MONITOR_ADD:
+    case SWL_EVENT_MONITOR_REMOVE:
+    case SWL_EVENT_MONITOR_FOCUS:
+        return swl_monitor_get_info(event->data).id;
+    case SWL_EVENT_LAYER_MAP:
+    case SWL_EVENT_LAYER_UNMAP:
+        // Layer surfaces have no id of their own
+        return (uint64_t)(uintptr_t)event->data;
+    case SWL_EVENT_PROCESS_EXIT:
+        return (uint64_t)((const SwlProcessExit *)event->data)->pid;
+    default:
+        return 0;
+    }
+}
 
-    offset += snprintf(buf + offset, sizeof(buf) - offset,
-        "{\"event\":\"%s\",\"data\":", event_name);
+static void serialize_event(SwlJsonWriter *w, const SwlEvent *event,
+                            const char *event_name, uint64_t timestamp)
+{
+    swl_json_begin_object(w);
+    swl_json_field_string(w, "event", event_name);
+    swl_json_key(w, "data");
 
     switch (event->type) {
     case SWL_EVENT_CLIENT_CREATE:
@@ -453,9 +546,9 @@ static void ipc_event_handler(void *ctx, const SwlEvent *event)
         SwlClient *client = event->data;
         if (client) {
             SwlClientInfo info = swl_client_get_info(client);
-            offset += serialize_client_info(buf + offset, sizeof(buf) - offset, &info);
+            serialize_client_info(w, &info);
         } else {
-            offset += snprintf(buf + offset, sizeof(buf) - offset, "null");
+            swl_json_null(w);
         }
         break;
     }
@@ -465,9 +558,9 @@ static void ipc_event_handler(void *ctx, const SwlEvent *event)
         SwlMonitor *mon = event->data;
         if (mon) {
             SwlMonitorInfo info = swl_monitor_get_info(mon);
-            offset += serialize_monitor_info(buf + offset, sizeof(buf) - offset, &info);
+            serialize_monitor_info(w, &info);
         } else {
-            offset += snprintf(buf + offset, sizeof(buf) - offset, "null");
+            swl_json_null(w);
         }
         break;
     }
@@ -476,21 +569,81 @@ static void ipc_event_handler(void *ctx, const SwlEvent *event)
         SwlLayerSurface *layer = event->data;
         if (layer) {
             SwlLayerSurfaceInfo info = swl_layer_surface_get_info(layer);
-            offset += serialize_layer_info(buf + offset, sizeof(buf) - offset, &info);
+            serialize_layer_info(w, &info);
         } else {
-            offset += snprintf(buf + offset, sizeof(buf) - offset, "null");
+            swl_json_null(w);
+        }
+        break;
+    }
+    case SWL_EVENT_MODE_CHANGE: {
+        const char *mode = event->data;
+        swl_json_begin_object(w);
+        swl_json_field_string(w, "mode", mode);
+        swl_json_end_object(w);
+        break;
+    }
+    case SWL_EVENT_PROCESS_EXIT: {
+        const SwlProcessExit *proc = event->data;
+        if (proc) {
+            swl_json_begin_object(w);
+            swl_json_field_int(w, "pid", proc->pid);
+            swl_json_field_int(w, "exit_code", proc->exit_code);
+            swl_json_field_int(w, "signal", proc->signal);
+            swl_json_field_string(w, "command", proc->command);
+            swl_json_end_object(w);
+        } else {
+            swl_json_null(w);
         }
         break;
     }
     default:
-        offset += snprintf(buf + offset, sizeof(buf) - offset, "null");
+        swl_json_null(w);
         break;
     }
 
-    offset += snprintf(buf + offset, sizeof(buf) - offset,
-        ",\"timestamp\":%" PRIu64 "}\n", ts);
+    swl_json_field_uint(w, "timestamp", timestamp);
+    swl_json_end_object(w);
+}
 
-    swl_ipc_broadcast_event(ipc, event->type, buf);
+static void ipc_event_handler(void *ctx, const SwlEvent *event)
+{
+    SwlIPC *ipc = ctx;
+    if (!ipc || (size_t)event->type >= EVENT_TYPE_COUNT)
+        return;
+
+    uint32_t bit = 1u << (uint32_t)event->type;
+    if (!(ipc->event_mask & bit))
+        return;
+
+    const char *event_name = event_type_names[event->type];
+    if (!event_name)
+        return;
+
+    uint64_t timestamp = get_timestamp_ms();
+
+    // Encode only for the kinds of subscriber that asked for this type
+    SwlJsonWriter *text = NULL;
+    if (ipc->text_event_mask & bit) {
+        text = &ipc->event_json;
+        swl_json_reset(text);
+        serialize_event(text, event, event_name, timestamp);
+        swl_json_raw(text, "\n", 1);
+        if (text->failed)
+            text = NULL;
+    }
+
+    SwlJsonWriter *binary = NULL;
+    if (ipc->binary_event_mask & bit) {
+        binary = &ipc->event_cbor;
+        swl_json_reset(binary);
+        ipc_frame_begin(binary);
+        serialize_event(binary, event, event_name, timestamp);
+        ipc_frame_end(binary);
+        if (binary->failed)
+            binary = NULL;
+    }
+
+    swl_ipc_broadcast_event(ipc, event->type, event_key(event), text, binary);
 }
 
 static SwlIPCResponse cmd_subscribe(SwlCompositor *comp, const char *args)
@@ -582,7 +735,10 @@ static SwlIPCResponse cmd_dispatch(SwlCompositor *comp, const char *args)
     if (err != SWL_OK) {
         r.success = false;
         char errbuf[256];
-        snprintf(errbuf, sizeof(errbuf), "unknown action: %s", action);
+        if (err == SWL_ERR_NOT_FOUND)
+            snprintf(errbuf, sizeof(errbuf), "unknown action: %s", action);
+        else
+            snprintf(errbuf, sizeof(errbuf), "invalid argument for %s: %s", action, arg ? arg : "(none)");
         r.error = strdup(errbuf);
         free(copy);
         return r;
@@ -593,20 +749,37 @@ static SwlIPCResponse cmd_dispatch(SwlCompositor *comp, const char *args)
     return r;
 }
 
-void ipc_subscribe_all_events(SwlIPC *ipc)
+// Called whenever a subscriber comes or goes. Only types some subscriber
+// asked for stay on the bus, so nobody pays to serialize the rest.
+void ipc_update_event_subscriptions(SwlIPC *ipc)
 {
+    uint32_t text_mask = 0, binary_mask = 0;
+    IPCSubscriber *sub;
+    wl_list_for_each(sub, &ipc->subscribers, link) {
+        if (sub->binary)
+            binary_mask |= sub->event_mask;
+        else
+            text_mask |= sub->event_mask;
+    }
+    uint32_t mask = text_mask | binary_mask;
+    ipc->text_event_mask = text_mask;
+    ipc->binary_event_mask = binary_mask;
+    ipc->event_mask = mask;
+
     SwlEventBus *bus = swl_compositor_get_event_bus(ipc->comp);
     if (!bus)
         return;
 
-    ipc->event_sub_count = 0;
     for (size_t i = 0; i < EVENT_TYPE_COUNT; i++) {
-        if (!event_type_names[i])
-            continue;
-        int sub_id = swl_event_bus_subscribe(bus, (SwlEventType)i,
-            ipc_event_handler, ipc);
-        if (sub_id >= 0 && ipc->event_sub_count < 24) {
-            ipc->event_sub_ids[ipc->event_sub_count++] = sub_id;
+        bool wanted = event_type_names[i] && (mask & (1u << i));
+        int *sub_id = &ipc->event_sub_ids[i];
+
+        if (wanted && *sub_id <= 0) {
+            *sub_id = swl_event_bus_subscribe(bus, (SwlEventType)i,
+                ipc_event_handler, ipc);
+        } else if (!wanted && *sub_id > 0) {
+            swl_event_bus_unsubscribe(bus, *sub_id);
+            *sub_id = 0;
         }
     }
 }
@@ -616,6 +789,10 @@ void swl_ipc_register_builtins(SwlIPC *ipc)
     swl_ipc_register_command(ipc, "get-windows", cmd_get_windows);
     swl_ipc_register_command(ipc, "get-monitors", cmd_get_monitors);
     swl_ipc_register_command(ipc, "get-layouts", cmd_get_layouts);
+    swl_ipc_register_command(ipc, "get-render-quality", cmd_get_render_quality);
+    swl_ipc_register_command(ipc, "get-mode", cmd_get_mode);
+    swl_ipc_register_command(ipc, "get-latency", cmd_get_latency);
+    swl_ipc_register_command(ipc, "get-startup-profile", cmd_get_startup_profile);
     swl_ipc_register_command(ipc, "focus", cmd_focus);
     swl_ipc_register_command(ipc, "close", cmd_close);
     swl_ipc_register_command(ipc, "layout", cmd_layout);
@@ -625,5 +802,4 @@ void swl_ipc_register_builtins(SwlIPC *ipc)
     swl_ipc_register_command(ipc, "subscribe", cmd_subscribe);
     swl_ipc_register_command(ipc, "dispatch", cmd_dispatch);
 
-    ipc_subscribe_all_events(ipc);
 }
@@ -13,6 +13,13 @@ SwlIPC *swl_ipc_create(SwlCompositor *comp)
 
     ipc->comp = comp;
     ipc->socket_fd = -1;
+    wl_list_init(&ipc->subscribers);
+    swl_json_init(&ipc->reply);
+    swl_json_init(&ipc->event_json);
+    swl_json_init(&ipc->event_cbor);
+    swl_json_set_encoding(&ipc->event_cbor, SWL_JSON_CBOR);
+    swl_json_init(&ipc->frame);
+    swl_json_set_encoding(&ipc->frame, SWL_JSON_CBOR);
 
     if (swl_ipc_socket_init(ipc) < 0) {
         free(ipc);
@@ -27,19 +34,17 @@ void swl_ipc_destroy(SwlIPC *ipc)
     if (!ipc)
         return;
 
-    /* Unsubscribe from event bus */
-    SwlEventBus *bus = swl_compositor_get_event_bus(ipc->comp);
-    if (bus) {
-        for (size_t i = 0; i < ipc->event_sub_count; i++)
-            swl_event_bus_unsubscribe(bus, ipc->event_sub_ids[i]);
-    }
-    ipc->event_sub_count = 0;
-
+    /* Dropping the last subscriber also drops our event bus subscriptions */
     swl_ipc_socket_cleanup(ipc);
+    ipc_update_event_subscriptions(ipc);
 
     for (size_t i = 0; i < ipc->command_count; i++)
         free(ipc->commands[i].name);
 
+    swl_json_finish(&ipc->reply);
+    swl_json_finish(&ipc->event_json);
+    swl_json_finish(&ipc->event_cbor);
+    swl_json_finish(&ipc->frame);
     free(ipc);
 }
 
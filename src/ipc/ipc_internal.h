@@ -3,30 +3,79 @@
 
 #include "ipc.h"
 #include "events.h"
+#include "json.h"
+#include "outqueue.h"
 #include <wayland-server-core.h>
 
 #define MAX_COMMANDS 64
 #define SOCKET_PATH "/tmp/swl.sock"
 #define BUFFER_SIZE 8192
-#define MAX_SUBSCRIBERS 32
+#define DEFAULT_SUBSCRIBER_HIGH_WATER (1024 * 1024)
 #define SWL_SUBSCRIBE_ALL ((uint32_t)0xFFFFFFFF)
 
+// Connections come in three kinds, told apart by how they open:
+//
+// Text session: the client opens with SWL_IPC_TEXT_HELLO and gets it
+// echoed back. Then newline-terminated requests, "[id ]command [args]".
+// Any number may be sent, pipelined, over one connection; each gets a
+// one-line JSON reply, in order, tagged with the id (the request's
+// position on the connection if none was given):
+//   {"id": 1, "ok": true, "data": ...}     (data only for get-* queries)
+//   {"id": 2, "ok": false, "error": "..."}
+//
+// Binary session: the client opens with SWL_IPC_HELLO and gets it echoed
+// back. Every message after that, in either direction, is a 4-byte
+// big-endian payload length followed by one CBOR value. Requests are
+// [id, "command", "args"] with id and args optional; replies are shaped
+// like the text session's.
+//
+// Either kind turns into an event stream after "subscribe"; events are
+// {"event": "...", "data": ..., "timestamp": ...}. Sessions are read no
+// further while replies are waiting to be written.
+//
+// Legacy: anything else is a single command, taken from the first read
+// (or everything sent before the client shut down its write side). It
+// gets the bare reply (JSON, "ok" or an error string) and the connection
+// is closed.
+#define SWL_IPC_HELLO "\0SWL\1"
+#define SWL_IPC_HELLO_LEN 5
+#define SWL_IPC_TEXT_HELLO "SWL 1\n"
+#define SWL_IPC_TEXT_HELLO_LEN 6
+#define SWL_IPC_FRAME_HEADER 4
+
 typedef struct {
     char *name;
     SwlIPCHandler handler;
 } IPCCommand;
 
+typedef enum {
+    IPC_CLIENT_NEW,      // No hello or command recognised yet
+    IPC_CLIENT_TEXT,     // Newline-framed session
+    IPC_CLIENT_BINARY,   // Length-framed CBOR session
+    IPC_CLIENT_LEGACY,   // One command without a hello, answered then closed
+} IPCClientMode;
+
 typedef struct {
     int fd;
     SwlIPC *ipc;
     struct wl_event_source *event_source;
+    IPCClientMode mode;
+    bool greeted;        // Session hello checked and echoed
+    bool closing;        // Close once the queued replies are written
+    uint64_t requests;   // Requests seen; the default reply id
+    char in[BUFFER_SIZE];
+    size_t in_len;
+    SwlOutQueue out;     // Replies not yet written; no reading while non-empty
 } IPCClient;
 
 typedef struct {
+    struct wl_list link;  // SwlIPC.subscribers
+    SwlIPC *ipc;
     int fd;
     struct wl_event_source *event_source;
     uint32_t event_mask;
-    bool active;
+    bool binary;      // Gets CBOR frames instead of NDJSON
+    SwlOutQueue out;  // Flushed on WL_EVENT_WRITABLE while non-empty
 } IPCSubscriber;
 
 struct SwlIPC {
@@ -41,22 +90,38 @@ struct SwlIPC {
     SwlStatusHandler status_handler;
     void *status_ctx;
 
-    IPCSubscriber subscribers[MAX_SUBSCRIBERS];
+    struct wl_list subscribers;  // IPCSubscriber.link
     size_t subscriber_count;
 
-    int event_sub_ids[24];
-    size_t event_sub_count;
+    // Union of the subscribers' masks. The bus only calls us for these
+    // types; event_sub_ids holds the subscription per type, 0 when unused.
+    uint32_t event_mask;
+    uint32_t text_event_mask;    // Wanted by NDJSON subscribers
+    uint32_t binary_event_mask;  // Wanted by binary subscribers
+    int event_sub_ids[SWL_EVENT_TYPE_COUNT];
+
+    // Kept across requests and events so serialization reuses the buffers
+    SwlJsonWriter reply;
+    SwlJsonWriter event_json;
+    SwlJsonWriter event_cbor;
+    SwlJsonWriter frame;  // Session reply envelope being built
 };
 
 /* socket.c */
 int swl_ipc_socket_init(SwlIPC *ipc);
 void swl_ipc_socket_cleanup(SwlIPC *ipc);
-void swl_ipc_add_subscriber(SwlIPC *ipc, int fd, struct wl_event_source *event_source,
-                             uint32_t event_mask);
-void swl_ipc_broadcast_event(SwlIPC *ipc, SwlEventType type, const char *json);
+IPCSubscriber *swl_ipc_add_subscriber(SwlIPC *ipc, int fd, uint32_t event_mask,
+                                      bool binary, SwlOutQueue *pending);
+// Either document may be NULL when no subscriber of that kind wants the event.
+// key names the object the event is about, for coalescing.
+void swl_ipc_broadcast_event(SwlIPC *ipc, SwlEventType type, uint64_t key,
+                             const SwlJsonWriter *text, const SwlJsonWriter *binary);
+// Reserve and fill in the length prefix of a binary frame
+void ipc_frame_begin(SwlJsonWriter *w);
+void ipc_frame_end(SwlJsonWriter *w);
 
 /* commands.c */
 void swl_ipc_register_builtins(SwlIPC *ipc);
-void ipc_subscribe_all_events(SwlIPC *ipc);
+void ipc_update_event_subscriptions(SwlIPC *ipc);
 
 #endif /* SWL_IPC_INTERNAL_H */
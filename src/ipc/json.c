@@ -0,0 +1,544 @@
+#define _POSIX_C_SOURCE 200809L
+#include "json.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_CAPACITY 1024
+
+void swl_json_init(SwlJsonWriter *w)
+{
+    if (w)
+        memset(w, 0, sizeof(*w));
+}
+
+void swl_json_finish(SwlJsonWriter *w)
+{
+    if (!w)
+        return;
+
+    free(w->buf);
+    memset(w, 0, sizeof(*w));
+}
+
+void swl_json_reset(SwlJsonWriter *w)
+{
+    if (!w)
+        return;
+
+    w->len = 0;
+    w->depth = 0;
+    w->has_items = 0;
+    w->after_key = false;
+    w->failed = false;
+    if (w->buf)
+        w->buf[0] = '\0';
+}
+
+void swl_json_set_encoding(SwlJsonWriter *w, SwlJsonEncoding encoding)
+{
+    if (!w)
+        return;
+
+    swl_json_reset(w);
+    w->encoding = encoding;
+}
+
+const char *swl_json_cstr(const SwlJsonWriter *w)
+{
+    return w && w->buf ? w->buf : "";
+}
+
+size_t swl_json_len(const SwlJsonWriter *w)
+{
+    return w ? w->len : 0;
+}
+
+// Make room for extra bytes plus the terminator, doubling the capacity
+static bool reserve(SwlJsonWriter *w, size_t extra)
+{
+    if (w->failed)
+        return false;
+
+    size_t need = w->len + extra + 1;
+    if (need <= w->cap)
+        return true;
+
+    size_t cap = w->cap ? w->cap : INITIAL_CAPACITY;
+    while (cap < need)
+        cap *= 2;
+
+    char *buf = realloc(w->buf, cap);
+    if (!buf) {
+        w->failed = true;
+        return false;
+    }
+
+    w->buf = buf;
+    w->cap = cap;
+    return true;
+}
+
+static void append(SwlJsonWriter *w, const char *s, size_t len)
+{
+    if (!reserve(w, len))
+        return;
+
+    memcpy(w->buf + w->len, s, len);
+    w->len += len;
+    w->buf[w->len] = '\0';
+}
+
+static void append_char(SwlJsonWriter *w, char c)
+{
+    if (!reserve(w, 1))
+        return;
+
+    w->buf[w->len++] = c;
+    w->buf[w->len] = '\0';
+}
+
+// CBOR initial byte: major type and argument, in the shortest form.
+// Writes at most 9 bytes to out and returns the count.
+static size_t cbor_encode_head(uint8_t *out, uint8_t major, uint64_t v)
+{
+    size_t n;
+
+    major <<= 5;
+    if (v < 24) {
+        out[0] = major | (uint8_t)v;
+        return 1;
+    } else if (v <= UINT8_MAX) {
+        out[0] = major | 24;
+        n = 2;
+    } else if (v <= UINT16_MAX) {
+        out[0] = major | 25;
+        n = 3;
+    } else if (v <= UINT32_MAX) {
+        out[0] = major | 26;
+        n = 5;
+    } else {
+        out[0] = major | 27;
+        n = 9;
+    }
+    for (size_t i = n - 1; i > 0; i--, v >>= 8)
+        out[i] = (uint8_t)v;
+    return n;
+}
+
+static void cbor_head(SwlJsonWriter *w, uint8_t major, uint64_t v)
+{
+    if (!reserve(w, 9))
+        return;
+
+    w->len += cbor_encode_head((uint8_t *)w->buf + w->len, major, v);
+    w->buf[w->len] = '\0';
+}
+
+// Length of the well-formed UTF-8 sequence starting at s (RFC 3629: no
+// overlong forms, surrogates or code points past U+10FFFF), 0 if there is none
+static size_t utf8_sequence(const unsigned char *s, size_t n)
+{
+    unsigned char c = s[0];
+    size_t len;
+    unsigned char lo = 0x80, hi = 0xbf;  // Range of the second byte
+
+    if (c < 0x80)
+        return 1;
+    if (c >= 0xc2 && c <= 0xdf) {
+        len = 2;
+    } else if (c >= 0xe0 && c <= 0xef) {
+        len = 3;
+        if (c == 0xe0)
+            lo = 0xa0;
+        else if (c == 0xed)
+            hi = 0x9f;
+    } else if (c >= 0xf0 && c <= 0xf4) {
+        len = 4;
+        if (c == 0xf0)
+            lo = 0x90;
+        else if (c == 0xf4)
+            hi = 0x8f;
+    } else {
+        return 0;
+    }
+
+    if (n < len || s[1] < lo || s[1] > hi)
+        return 0;
+    for (size_t i = 2; i < len; i++) {
+        if ((s[i] & 0xc0) != 0x80)
+            return 0;
+    }
+    return len;
+}
+
+// U+FFFD, written in place of each byte that isn't part of valid UTF-8
+static const char utf8_replacement[] = "\xef\xbf\xbd";
+
+static void cbor_string(SwlJsonWriter *w, const char *s)
+{
+    const unsigned char *u = (const unsigned char *)s;
+    size_t n = s ? strlen(s) : 0;
+
+    // Text strings must be valid UTF-8, so the length is only known once
+    // invalid bytes are counted
+    size_t out_len = 0;
+    bool valid = true;
+    for (size_t i = 0; i < n;) {
+        size_t seq = utf8_sequence(u + i, n - i);
+        if (seq == 0) {
+            valid = false;
+            out_len += 3;
+            i++;
+        } else {
+            out_len += seq;
+            i += seq;
+        }
+    }
+
+    // Head and bytes under one capacity check
+    if (!reserve(w, out_len + 9))
+        return;
+
+    w->len += cbor_encode_head((uint8_t *)w->buf + w->len, 3, out_len);
+    char *out = w->buf + w->len;
+    if (valid) {
+        if (n > 0)
+            memcpy(out, s, n);
+        out += n;
+    } else {
+        for (size_t i = 0; i < n;) {
+            size_t seq = utf8_sequence(u + i, n - i);
+            if (seq == 0) {
+                memcpy(out, utf8_replacement, 3);
+                out += 3;
+                i++;
+            } else {
+                memcpy(out, s + i, seq);
+                out += seq;
+                i += seq;
+            }
+        }
+    }
+    w->len = (size_t)(out - w->buf);
+    w->buf[w->len] = '\0';
+}
+
+// Separator before a value or key in the current container
+static void prelude(SwlJsonWriter *w)
+{
+    if (w->encoding == SWL_JSON_CBOR)
+        return;
+
+    if (w->after_key) {
+        w->after_key = false;
+        return;
+    }
+
+    uint32_t bit = 1u << w->depth;
+    if (w->depth > 0 && (w->has_items & bit))
+        append_char(w, ',');
+    w->has_items |= bit;
+}
+
+static void begin(SwlJsonWriter *w, char open, uint8_t cbor_open)
+{
+    if (!w)
+        return;
+
+    prelude(w);
+    if (w->depth + 1 >= SWL_JSON_MAX_DEPTH) {
+        w->failed = true;
+        return;
+    }
+
+    append_char(w, w->encoding == SWL_JSON_CBOR ? (char)cbor_open : open);
+    w->depth++;
+    w->has_items &= ~(1u << w->depth);
+}
+
+static void end(SwlJsonWriter *w, char close)
+{
+    if (!w || w->depth == 0)
+        return;
+
+    w->depth--;
+    append_char(w, w->encoding == SWL_JSON_CBOR ? (char)0xff : close);
+}
+
+void swl_json_begin_object(SwlJsonWriter *w)
+{
+    begin(w, '{', 0xbf);  // Indefinite-length map
+}
+
+void swl_json_end_object(SwlJsonWriter *w)
+{
+    end(w, '}');
+}
+
+void swl_json_begin_array(SwlJsonWriter *w)
+{
+    begin(w, '[', 0x9f);  // Indefinite-length array
+}
+
+void swl_json_end_array(SwlJsonWriter *w)
+{
+    end(w, ']');
+}
+
+static void write_escaped(SwlJsonWriter *w, const char *s)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    size_t n = s ? strlen(s) : 0;
+    // Worst case every byte becomes \u00XX; reserving once keeps the loop
+    // free of capacity checks
+    if (!reserve(w, n * 6 + 2))
+        return;
+
+    char *out = w->buf + w->len;
+    *out++ = '"';
+    for (size_t i = 0; i < n; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c >= 0x80) {
+            // Valid UTF-8 passes through unchanged, stray bytes become U+FFFD
+            size_t seq = utf8_sequence((const unsigned char *)s + i, n - i);
+            if (seq == 0) {
+                memcpy(out, utf8_replacement, 3);
+                out += 3;
+            } else {
+                memcpy(out, s + i, seq);
+                out += seq;
+                i += seq - 1;
+            }
+            continue;
+        }
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            *out++ = (char)c;
+            continue;
+        }
+
+        *out++ = '\\';
+        switch (c) {
+        case '"':  *out++ = '"'; break;
+        case '\\': *out++ = '\\'; break;
+        case '\n': *out++ = 'n'; break;
+        case '\r': *out++ = 'r'; break;
+        case '\t': *out++ = 't'; break;
+        case '\b': *out++ = 'b'; break;
+        case '\f': *out++ = 'f'; break;
+        default:
+            *out++ = 'u';
+            *out++ = '0';
+            *out++ = '0';
+            *out++ = hex[c >> 4];
+            *out++ = hex[c & 0xf];
+            break;
+        }
+    }
+    *out++ = '"';
+
+    w->len = (size_t)(out - w->buf);
+    w->buf[w->len] = '\0';
+}
+
+// Digits of v, written backwards from the end of buf; returns the start
+static char *format_u64(char *end, uint64_t v)
+{
+    char *p = end;
+    do {
+        *--p = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    return p;
+}
+
+void swl_json_key(SwlJsonWriter *w, const char *key)
+{
+    if (!w || w->depth == 0)
+        return;
+
+    if (w->encoding == SWL_JSON_CBOR) {
+        cbor_string(w, key);
+        return;
+    }
+
+    prelude(w);
+    write_escaped(w, key);
+    append_char(w, ':');
+    w->after_key = true;
+}
+
+void swl_json_string(SwlJsonWriter *w, const char *s)
+{
+    if (!w)
+        return;
+
+    if (w->encoding == SWL_JSON_CBOR) {
+        cbor_string(w, s);
+        return;
+    }
+
+    prelude(w);
+    write_escaped(w, s);
+}
+
+void swl_json_int(SwlJsonWriter *w, int64_t v)
+{
+    if (!w)
+        return;
+
+    if (w->encoding == SWL_JSON_CBOR) {
+        // Negative integers are stored as -1 - v
+        if (v < 0)
+            cbor_head(w, 1, ~(uint64_t)v);
+        else
+            cbor_head(w, 0, (uint64_t)v);
+        return;
+    }
+
+    char num[24];
+    char *end = num + sizeof(num);
+    uint64_t mag = v < 0 ? 0 - (uint64_t)v : (uint64_t)v;
+    char *p = format_u64(end, mag);
+    if (v < 0)
+        *--p = '-';
+    prelude(w);
+    append(w, p, (size_t)(end - p));
+}
+
+void swl_json_uint(SwlJsonWriter *w, uint64_t v)
+{
+    if (!w)
+        return;
+
+    if (w->encoding == SWL_JSON_CBOR) {
+        cbor_head(w, 0, v);
+        return;
+    }
+
+    char num[24];
+    char *end = num + sizeof(num);
+    char *p = format_u64(end, v);
+    prelude(w);
+    append(w, p, (size_t)(end - p));
+}
+
+// Single precision when it round-trips, double otherwise
+static void cbor_float(SwlJsonWriter *w, double v)
+{
+    uint8_t out[9];
+    size_t n;
+
+    float f = (float)v;
+    if ((double)f == v) {
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        out[0] = 0xfa;
+        for (int i = 4; i > 0; i--, bits >>= 8)
+            out[i] = (uint8_t)bits;
+        n = 5;
+    } else {
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        out[0] = 0xfb;
+        for (int i = 8; i > 0; i--, bits >>= 8)
+            out[i] = (uint8_t)bits;
+        n = 9;
+    }
+
+    append(w, (const char *)out, n);
+}
+
+void swl_json_double(SwlJsonWriter *w, double v, int decimals)
+{
+    if (!w)
+        return;
+
+    if (!isfinite(v)) {
+        swl_json_null(w);
+        return;
+    }
+
+    if (w->encoding == SWL_JSON_CBOR) {
+        cbor_float(w, v);
+        return;
+    }
+
+    char num[64];
+    int n = snprintf(num, sizeof(num), "%.*f", decimals, v);
+    if (n < 0 || (size_t)n >= sizeof(num)) {
+        swl_json_null(w);
+        return;
+    }
+    prelude(w);
+    append(w, num, (size_t)n);
+}
+
+void swl_json_bool(SwlJsonWriter *w, bool v)
+{
+    if (!w)
+        return;
+
+    if (w->encoding == SWL_JSON_CBOR) {
+        append_char(w, v ? (char)0xf5 : (char)0xf4);
+        return;
+    }
+
+    prelude(w);
+    if (v)
+        append(w, "true", 4);
+    else
+        append(w, "false", 5);
+}
+
+void swl_json_null(SwlJsonWriter *w)
+{
+    if (!w)
+        return;
+
+    if (w->encoding == SWL_JSON_CBOR) {
+        append_char(w, (char)0xf6);
+        return;
+    }
+
+    prelude(w);
+    append(w, "null", 4);
+}
+
+void swl_json_field_string(SwlJsonWriter *w, const char *key, const char *s)
+{
+    swl_json_key(w, key);
+    swl_json_string(w, s);
+}
+
+void swl_json_field_int(SwlJsonWriter *w, const char *key, int64_t v)
+{
+    swl_json_key(w, key);
+    swl_json_int(w, v);
+}
+
+void swl_json_field_uint(SwlJsonWriter *w, const char *key, uint64_t v)
+{
+    swl_json_key(w, key);
+    swl_json_uint(w, v);
+}
+
+void swl_json_field_double(SwlJsonWriter *w, const char *key, double v, int decimals)
+{
+    swl_json_key(w, key);
+    swl_json_double(w, v, decimals);
+}
+
+void swl_json_field_bool(SwlJsonWriter *w, const char *key, bool v)
+{
+    swl_json_key(w, key);
+    swl_json_bool(w, v);
+}
+
+void swl_json_raw(SwlJsonWriter *w, const char *s, size_t len)
+{
+    if (w && s)
+        append(w, s, len);
+}
@@ -0,0 +1,295 @@
+#define _POSIX_C_SOURCE 200809L
+#include "outqueue.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#define INITIAL_CAPACITY 16
+#define MAX_IOV 16
+#define GAP_TYPE UINT32_MAX
+#define FRAME_HEADER 4
+
+SwlOutMsg *swl_outmsg_create(uint32_t type, const char *data, size_t len)
+{
+    SwlOutMsg *msg = malloc(sizeof(*msg) + len);
+    if (!msg)
+        return NULL;
+
+    msg->refs = 1;
+    msg->type = type;
+    msg->key = 0;
+    msg->len = len;
+    memcpy(msg->data, data, len);
+    return msg;
+}
+
+void swl_outmsg_unref(SwlOutMsg *msg)
+{
+    if (msg && --msg->refs == 0)
+        free(msg);
+}
+
+void swl_outqueue_init(SwlOutQueue *q, size_t high_water, SwlOverflowPolicy policy)
+{
+    memset(q, 0, sizeof(*q));
+    q->high_water = high_water;
+    q->policy = policy;
+}
+
+void swl_outqueue_finish(SwlOutQueue *q)
+{
+    if (!q)
+        return;
+
+    for (size_t i = 0; i < q->count; i++)
+        swl_outmsg_unref(q->ring[(q->head + i) % q->cap]);
+    free(q->ring);
+    memset(q, 0, sizeof(*q));
+}
+
+bool swl_outqueue_empty(const SwlOutQueue *q)
+{
+    return !q || q->count == 0;
+}
+
+static SwlOutMsg **slot(const SwlOutQueue *q, size_t i)
+{
+    return &q->ring[(q->head + i) % q->cap];
+}
+
+static bool grow(SwlOutQueue *q)
+{
+    if (q->count < q->cap)
+        return true;
+
+    size_t cap = q->cap ? q->cap * 2 : INITIAL_CAPACITY;
+    SwlOutMsg **ring = malloc(cap * sizeof(*ring));
+    if (!ring)
+        return false;
+
+    for (size_t i = 0; i < q->count; i++)
+        ring[i] = *slot(q, i);
+    free(q->ring);
+    q->ring = ring;
+    q->cap = cap;
+    q->head = 0;
+    return true;
+}
+
+// Insert before position i (i == count appends)
+static bool insert_at(SwlOutQueue *q, size_t i, SwlOutMsg *msg)
+{
+    if (!grow(q))
+        return false;
+
+    q->count++;
+    for (size_t j = q->count - 1; j > i; j--)
+        *slot(q, j) = *slot(q, j - 1);
+    *slot(q, i) = msg;
+    q->bytes += msg->len;
+    return true;
+}
+
+static void remove_at(SwlOutQueue *q, size_t i)
+{
+    SwlOutMsg *msg = *slot(q, i);
+    q->bytes -= msg->len - (i == 0 ? q->offset : 0);
+    if (i == 0)
+        q->offset = 0;
+
+    for (size_t j = i; j + 1 < q->count; j++)
+        *slot(q, j) = *slot(q, j + 1);
+    q->count--;
+    swl_outmsg_unref(msg);
+}
+
+// The head message can't be touched once part of it is on the wire
+static size_t first_unsent(const SwlOutQueue *q)
+{
+    return q->offset > 0 ? 1 : 0;
+}
+
+// {"event":"gap","data":{"dropped":N}}, framed the way the reader expects
+static SwlOutMsg *create_gap(const SwlOutQueue *q)
+{
+    bool binary = q->encoding == SWL_JSON_CBOR;
+    SwlJsonWriter w;
+    swl_json_init(&w);
+    swl_json_set_encoding(&w, q->encoding);
+
+    if (binary)
+        swl_json_raw(&w, "\0\0\0\0", FRAME_HEADER);
+    swl_json_begin_object(&w);
+    swl_json_field_string(&w, "event", "gap");
+    swl_json_key(&w, "data");
+    swl_json_begin_object(&w);
+    swl_json_field_uint(&w, "dropped", q->dropped);
+    swl_json_end_object(&w);
+    swl_json_end_object(&w);
+
+    if (!binary)
+        swl_json_raw(&w, "\n", 1);
+
+    SwlOutMsg *gap = NULL;
+    if (!w.failed) {
+        if (binary) {
+            size_t payload = w.len - FRAME_HEADER;
+            w.buf[0] = (char)(payload >> 24);
+            w.buf[1] = (char)(payload >> 16);
+            w.buf[2] = (char)(payload >> 8);
+            w.buf[3] = (char)payload;
+        }
+        gap = swl_outmsg_create(GAP_TYPE, swl_json_cstr(&w), swl_json_len(&w));
+    }
+    swl_json_finish(&w);
+    return gap;
+}
+
+static bool drop_oldest(SwlOutQueue *q, size_t incoming)
+{
+    size_t i = first_unsent(q);
+    bool have_gap = i < q->count && (*slot(q, i))->type == GAP_TYPE;
+    size_t victim = have_gap ? i + 1 : i;
+    // The marker doesn't count against the mark, or it would eat what follows
+    size_t marker = have_gap ? (*slot(q, i))->len : 0;
+    uint64_t dropped = 0;
+
+    while (q->bytes - marker + incoming > q->high_water && victim < q->count) {
+        // Only events give way, replies stay queued in order
+        if ((*slot(q, victim))->type == SWL_OUTMSG_REPLY) {
+            victim++;
+            continue;
+        }
+        remove_at(q, victim);
+        dropped++;
+    }
+    if (dropped == 0)
+        return true;
+
+    q->dropped += dropped;
+    q->dropped_total += dropped;
+
+    // One marker covers everything dropped since the reader last heard
+    SwlOutMsg *gap = create_gap(q);
+    if (!gap)
+        return false;
+    if (have_gap)
+        remove_at(q, i);
+    return insert_at(q, i, gap);
+}
+
+static void coalesce(SwlOutQueue *q, const SwlOutMsg *msg)
+{
+    if (msg->type == SWL_OUTMSG_REPLY)
+        return;
+
+    // A newer event only supersedes the one about the same object
+    for (size_t i = q->count; i > first_unsent(q); i--) {
+        const SwlOutMsg *queued = *slot(q, i - 1);
+        if (queued->type == msg->type && queued->key == msg->key) {
+            remove_at(q, i - 1);
+            q->dropped_total++;
+            return;
+        }
+    }
+}
+
+bool swl_outqueue_push(SwlOutQueue *q, SwlOutMsg *msg)
+{
+    if (!q || !msg)
+        return false;
+
+    if (q->count > 0 && q->bytes + msg->len > q->high_water) {
+        switch (q->policy) {
+        case SWL_OVERFLOW_DISCONNECT:
+            return false;
+        case SWL_OVERFLOW_COALESCE:
+            coalesce(q, msg);
+            if (q->bytes + msg->len <= q->high_water)
+                break;
+            // Nothing of this type to fold into; keep the queue bounded
+            // fall through
+        case SWL_OVERFLOW_DROP_OLDEST:
+            if (!drop_oldest(q, msg->len))
+                return false;
+            break;
+        }
+    }
+
+    msg->refs++;
+    if (!insert_at(q, q->count, msg)) {
+        msg->refs--;
+        return false;
+    }
+    return true;
+}
+
+// Account for n bytes that left through the socket
+static void consume(SwlOutQueue *q, size_t n)
+{
+    while (n > 0 && q->count > 0) {
+        SwlOutMsg *head = *slot(q, 0);
+        if (head->type == GAP_TYPE && q->offset == 0)
+            q->dropped = 0;  // Marker is going out, later drops start over
+
+        size_t left = head->len - q->offset;
+        if (n < left) {
+            q->offset += n;
+            q->bytes -= n;
+            return;
+        }
+
+        n -= left;
+        q->bytes -= left;
+        q->offset = 0;
+        q->head = (q->head + 1) % q->cap;
+        q->count--;
+        swl_outmsg_unref(head);
+    }
+}
+
+int swl_outqueue_flush(SwlOutQueue *q, int fd)
+{
+    if (!q)
+        return -1;
+
+    while (q->count > 0) {
+        struct iovec iov[MAX_IOV];
+        size_t n = q->count < MAX_IOV ? q->count : MAX_IOV;
+        for (size_t i = 0; i < n; i++) {
+            SwlOutMsg *msg = *slot(q, i);
+            size_t skip = i == 0 ? q->offset : 0;
+            iov[i].iov_base = msg->data + skip;
+            iov[i].iov_len = msg->len - skip;
+        }
+
+        ssize_t written = writev(fd, iov, (int)n);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return 0;
+            return -1;
+        }
+        consume(q, (size_t)written);
+    }
+
+    return 1;
+}
+
+bool swl_overflow_policy_from_string(const char *name, SwlOverflowPolicy *out)
+{
+    if (!name || !out)
+        return false;
+
+    if (strcmp(name, "drop_oldest") == 0)
+        *out = SWL_OVERFLOW_DROP_OLDEST;
+    else if (strcmp(name, "coalesce") == 0)
+        *out = SWL_OVERFLOW_COALESCE;
+    else if (strcmp(name, "disconnect") == 0)
+        *out = SWL_OVERFLOW_DISCONNECT;
+    else
+        return false;
+    return true;
+}
@@ -1,6 +1,8 @@
 #define _POSIX_C_SOURCE 200809L
 #include "ipc_internal.h"
 #include "compositor.h"
+#include "config.h"
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -12,6 +14,7 @@
 
 static int handle_client(int fd, uint32_t mask, void *data);
 static int handle_socket(int fd, uint32_t mask, void *data);
+static void ipc_subscriber_cleanup(IPCSubscriber *sub);
 
 int swl_ipc_socket_init(SwlIPC *ipc)
 {
@@ -34,6 +37,7 @@ int swl_ipc_socket_init(SwlIPC *ipc)
 
     int flags = fcntl(ipc->socket_fd, F_GETFL);
     fcntl(ipc->socket_fd, F_SETFL, flags | O_NONBLOCK);
+    fcntl(ipc->socket_fd, F_SETFD, FD_CLOEXEC);
 
     struct sockaddr_un addr = {
         .sun_family = AF_UNIX,
@@ -70,15 +74,9 @@ int swl_ipc_socket_init(SwlIPC *ipc)
 void swl_ipc_socket_cleanup(SwlIPC *ipc)
 {
     /* Close all active subscribers */
-    for (size_t i = 0; i < MAX_SUBSCRIBERS; i++) {
-        if (ipc->subscribers[i].active) {
-            if (ipc->subscribers[i].event_source)
-                wl_event_source_remove(ipc->subscribers[i].event_source);
-            close(ipc->subscribers[i].fd);
-            ipc->subscribers[i].active = false;
-        }
-    }
-    ipc->subscriber_count = 0;
+    IPCSubscriber *sub, *tmp;
+    wl_list_for_each_safe(sub, tmp, &ipc->subscribers, link)
+        ipc_subscriber_cleanup(sub);
 
     if (ipc->event_source) {
         wl_event_source_remove(ipc->event_source);
@@ -96,6 +94,21 @@ void swl_ipc_socket_cleanup(SwlIPC *ipc)
     ipc->socket_path = NULL;
 }
 
+static void load_overflow_config(SwlIPC *ipc, size_t *high_water, SwlOverflowPolicy *policy)
+{
+    SwlConfig *cfg = swl_compositor_get_config(ipc->comp);
+
+    int hw = swl_config_get_int(cfg, "ipc.subscriber_high_water",
+                                DEFAULT_SUBSCRIBER_HIGH_WATER);
+    *high_water = hw > 0 ? (size_t)hw : DEFAULT_SUBSCRIBER_HIGH_WATER;
+
+    const char *name = swl_config_get_string(cfg, "ipc.overflow_policy", "drop_oldest");
+    if (!swl_overflow_policy_from_string(name, policy)) {
+        fprintf(stderr, "ipc: unknown overflow_policy '%s', using drop_oldest\n", name);
+        *policy = SWL_OVERFLOW_DROP_OLDEST;
+    }
+}
+
 static int handle_socket(int fd, uint32_t mask, void *data)
 {
     SwlIPC *ipc = data;
@@ -107,16 +120,28 @@ static int handle_socket(int fd, uint32_t mask, void *data)
 
     int flags = fcntl(client_fd, F_GETFL);
     fcntl(client_fd, F_SETFL, flags | O_NONBLOCK);
+    fcntl(client_fd, F_SETFD, FD_CLOEXEC);
 
     struct wl_display *display = swl_compositor_get_wl_display(ipc->comp);
     struct wl_event_loop *loop = wl_display_get_event_loop(display);
 
-    IPCClient *client = malloc(sizeof(*client));
+    IPCClient *client = calloc(1, sizeof(*client));
+    if (!client) {
+        close(client_fd);
+        return 0;
+    }
     client->fd = client_fd;
     client->ipc = ipc;
     client->event_source = wl_event_loop_add_fd(loop, client_fd,
         WL_EVENT_READABLE, handle_client, client);
 
+    // Replies are never dropped; a client that stops reading them is
+    // throttled instead, see client_flush()
+    size_t high_water;
+    SwlOverflowPolicy policy;
+    load_overflow_config(ipc, &high_water, &policy);
+    swl_outqueue_init(&client->out, high_water, policy);
+
     return 0;
 }
 
@@ -124,151 +149,607 @@ static void ipc_client_cleanup(IPCClient *client)
 {
     wl_event_source_remove(client->event_source);
     close(client->fd);
+    swl_outqueue_finish(&client->out);
     free(client);
 }
 
-static void ipc_subscriber_cleanup(SwlIPC *ipc, size_t idx)
+static void ipc_subscriber_cleanup(IPCSubscriber *sub)
 {
-    IPCSubscriber *sub = &ipc->subscribers[idx];
-    if (!sub->active)
-        return;
-
     if (sub->event_source)
         wl_event_source_remove(sub->event_source);
     close(sub->fd);
-    sub->active = false;
-    ipc->subscriber_count--;
+    swl_outqueue_finish(&sub->out);
+    wl_list_remove(&sub->link);
+    sub->ipc->subscriber_count--;
+    ipc_update_event_subscriptions(sub->ipc);
+    free(sub);
+}
+
+// Push queued messages out; watch for writability only while some remain.
+// Throttled connections also stop being read until everything is out.
+static bool ipc_flush(SwlOutQueue *q, int fd, struct wl_event_source *source,
+                      bool throttle)
+{
+    int ret = swl_outqueue_flush(q, fd);
+    if (ret < 0)
+        return false;
+
+    uint32_t mask = WL_EVENT_READABLE;
+    if (ret == 0)
+        mask = throttle ? WL_EVENT_WRITABLE : mask | WL_EVENT_WRITABLE;
+    wl_event_source_fd_update(source, mask);
+    return true;
+}
+
+// Queue a message and start writing it unless earlier ones are still
+// waiting for WL_EVENT_WRITABLE, which keeps the order. False means the
+// connection should be dropped.
+static bool ipc_send(SwlOutQueue *q, int fd, struct wl_event_source *source,
+                     SwlOutMsg *msg, bool throttle)
+{
+    bool waiting = !swl_outqueue_empty(q);
+    if (!swl_outqueue_push(q, msg))
+        return false;
+
+    return waiting || ipc_flush(q, fd, source, throttle);
+}
+
+// Request connections are throttled: a client pipelining requests faster
+// than it reads the replies is no longer read from until they drain,
+// rather than being disconnected
+static bool client_flush(IPCClient *client)
+{
+    return ipc_flush(&client->out, client->fd, client->event_source, true);
+}
+
+static bool client_send(IPCClient *client, SwlOutMsg *msg)
+{
+    return ipc_send(&client->out, client->fd, client->event_source, msg, true);
 }
 
 static int handle_subscriber(int fd, uint32_t mask, void *data)
 {
-    SwlIPC *ipc = data;
+    IPCSubscriber *sub = data;
 
-    /* Find the subscriber by fd */
-    for (size_t i = 0; i < MAX_SUBSCRIBERS; i++) {
-        if (ipc->subscribers[i].active && ipc->subscribers[i].fd == fd) {
-            if (mask & (WL_EVENT_HANGUP | WL_EVENT_ERROR)) {
-                ipc_subscriber_cleanup(ipc, i);
-                return 0;
-            }
-            /* Discard any data sent by subscriber */
-            char discard[256];
-            ssize_t n = read(fd, discard, sizeof(discard));
-            if (n <= 0) {
-                ipc_subscriber_cleanup(ipc, i);
-            }
+    if (mask & (WL_EVENT_HANGUP | WL_EVENT_ERROR)) {
+        ipc_subscriber_cleanup(sub);
+        return 0;
+    }
+
+    if (mask & WL_EVENT_WRITABLE) {
+        if (!ipc_flush(&sub->out, sub->fd, sub->event_source, false)) {
+            ipc_subscriber_cleanup(sub);
             return 0;
         }
     }
 
+    if (mask & WL_EVENT_READABLE) {
+        /* Discard any data sent by subscriber */
+        char discard[256];
+        ssize_t n = read(fd, discard, sizeof(discard));
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR))
+            ipc_subscriber_cleanup(sub);
+    }
+
     return 0;
 }
 
-void swl_ipc_add_subscriber(SwlIPC *ipc, int fd, struct wl_event_source *event_source,
-                             uint32_t event_mask)
+IPCSubscriber *swl_ipc_add_subscriber(SwlIPC *ipc, int fd, uint32_t event_mask,
+                                      bool binary, SwlOutQueue *pending)
 {
-    for (size_t i = 0; i < MAX_SUBSCRIBERS; i++) {
-        if (!ipc->subscribers[i].active) {
-            ipc->subscribers[i].fd = fd;
-            ipc->subscribers[i].event_source = event_source;
-            ipc->subscribers[i].event_mask = event_mask;
-            ipc->subscribers[i].active = true;
-            ipc->subscriber_count++;
-            return;
-        }
+    IPCSubscriber *sub = calloc(1, sizeof(*sub));
+    if (!sub) {
+        close(fd);
+        return NULL;
     }
 
-    /* No free slot — close the fd */
-    if (event_source)
-        wl_event_source_remove(event_source);
-    close(fd);
+    struct wl_display *display = swl_compositor_get_wl_display(ipc->comp);
+    struct wl_event_loop *loop = wl_display_get_event_loop(display);
+    sub->event_source = wl_event_loop_add_fd(loop, fd, WL_EVENT_READABLE,
+        handle_subscriber, sub);
+    if (!sub->event_source) {
+        close(fd);
+        free(sub);
+        return NULL;
+    }
+
+    size_t high_water;
+    SwlOverflowPolicy policy;
+    load_overflow_config(ipc, &high_water, &policy);
+
+    sub->ipc = ipc;
+    sub->fd = fd;
+    sub->event_mask = event_mask;
+    sub->binary = binary;
+    if (pending) {
+        // Take over replies still on their way to the client
+        sub->out = *pending;
+        sub->out.high_water = high_water;
+        sub->out.policy = policy;
+        memset(pending, 0, sizeof(*pending));
+    } else {
+        swl_outqueue_init(&sub->out, high_water, policy);
+    }
+    sub->out.encoding = binary ? SWL_JSON_CBOR : SWL_JSON_TEXT;
+    wl_list_insert(ipc->subscribers.prev, &sub->link);
+    ipc->subscriber_count++;
+    ipc_update_event_subscriptions(ipc);
+
+    if (!swl_outqueue_empty(&sub->out))
+        wl_event_source_fd_update(sub->event_source,
+            WL_EVENT_READABLE | WL_EVENT_WRITABLE);
+    return sub;
 }
 
-void swl_ipc_broadcast_event(SwlIPC *ipc, SwlEventType type, const char *json)
+void swl_ipc_broadcast_event(SwlIPC *ipc, SwlEventType type, uint64_t key,
+                             const SwlJsonWriter *text, const SwlJsonWriter *binary)
 {
-    if (!ipc || !json || ipc->subscriber_count == 0)
+    if (!ipc || ipc->subscriber_count == 0)
         return;
 
     uint32_t type_bit = 1u << (uint32_t)type;
-    size_t json_len = strlen(json);
+    const SwlJsonWriter *docs[2] = {text, binary};
+    SwlOutMsg *msgs[2] = {NULL, NULL};
 
-    for (size_t i = 0; i < MAX_SUBSCRIBERS; i++) {
-        IPCSubscriber *sub = &ipc->subscribers[i];
-        if (!sub->active)
-            continue;
+    IPCSubscriber *sub, *tmp;
+    wl_list_for_each_safe(sub, tmp, &ipc->subscribers, link) {
         if (!(sub->event_mask & type_bit))
             continue;
 
-        ssize_t written = write(sub->fd, json, json_len);
-        if (written < 0) {
-            /* EPIPE or other error — subscriber gone */
-            ipc_subscriber_cleanup(ipc, i);
+        int kind = sub->binary ? 1 : 0;
+        if (!docs[kind])
+            continue;
+
+        // One copy of the event per encoding, shared by every queue it lands in
+        if (!msgs[kind]) {
+            msgs[kind] = swl_outmsg_create((uint32_t)type,
+                swl_json_cstr(docs[kind]), swl_json_len(docs[kind]));
+            if (!msgs[kind])
+                break;
+            msgs[kind]->key = key;
+        }
+
+        if (!ipc_send(&sub->out, sub->fd, sub->event_source, msgs[kind], false)) {
+            fprintf(stderr, "ipc: subscriber fell %zu bytes behind, disconnecting\n",
+                    sub->out.bytes);
+            ipc_subscriber_cleanup(sub);
         }
     }
+
+    swl_outmsg_unref(msgs[0]);
+    swl_outmsg_unref(msgs[1]);
 }
 
-static int handle_client(int fd, uint32_t mask, void *data)
+void ipc_frame_begin(SwlJsonWriter *w)
 {
-    (void)fd;
-    IPCClient *client = data;
+    swl_json_raw(w, "\0\0\0\0", SWL_IPC_FRAME_HEADER);
+}
 
-    if (mask & WL_EVENT_HANGUP) {
-        ipc_client_cleanup(client);
-        return 0;
+void ipc_frame_end(SwlJsonWriter *w)
+{
+    if (w->failed || w->len < SWL_IPC_FRAME_HEADER)
+        return;
+
+    size_t payload = w->len - SWL_IPC_FRAME_HEADER;
+    if (payload > UINT32_MAX) {
+        w->failed = true;
+        return;
+    }
+    w->buf[0] = (char)(payload >> 24);
+    w->buf[1] = (char)(payload >> 16);
+    w->buf[2] = (char)(payload >> 8);
+    w->buf[3] = (char)payload;
+}
+
+/* --- Requests --- */
+
+// Read a CBOR head of the given major type; definite lengths only
+static bool cbor_read_head(const uint8_t **p, const uint8_t *end, uint8_t major,
+                           uint64_t *value)
+{
+    if (*p >= end || (**p >> 5) != major)
+        return false;
+
+    uint8_t info = *(*p)++ & 0x1f;
+    if (info < 24) {
+        *value = info;
+        return true;
+    }
+    if (info > 27)
+        return false;
+
+    size_t n = (size_t)1 << (info - 24);
+    if ((size_t)(end - *p) < n)
+        return false;
+
+    uint64_t v = 0;
+    for (size_t i = 0; i < n; i++)
+        v = (v << 8) | *(*p)++;
+    *value = v;
+    return true;
+}
+
+// Copy a CBOR text string out as a C string
+static bool cbor_read_text(const uint8_t **p, const uint8_t *end, char *out, size_t cap)
+{
+    uint64_t len;
+    if (!cbor_read_head(p, end, 3, &len))
+        return false;
+    if (len >= cap || len > (uint64_t)(end - *p))
+        return false;
+
+    memcpy(out, *p, (size_t)len);
+    out[len] = '\0';
+    *p += len;
+    return true;
+}
+
+// Request payload: [id, "command", "args"], id and args optional
+static bool decode_request(const uint8_t *p, size_t len, uint64_t *id, char *cmd,
+                           char *args, bool *has_args)
+{
+    const uint8_t *end = p + len;
+    uint64_t count;
+    if (!cbor_read_head(&p, end, 4, &count) || count < 1 || count > 3)
+        return false;
+
+    if (p < end && (*p >> 5) == 0) {
+        if (!cbor_read_head(&p, end, 0, id))
+            return false;
+        count--;
+    }
+    if (count < 1 || count > 2)
+        return false;
+
+    if (!cbor_read_text(&p, end, cmd, BUFFER_SIZE))
+        return false;
+
+    *has_args = count == 2;
+    if (*has_args && !cbor_read_text(&p, end, args, BUFFER_SIZE))
+        return false;
+
+    return p == end;
+}
+
+// Session reply: a JSON line or a CBOR frame around the handler's result
+static SwlOutMsg *reply_envelope(SwlIPC *ipc, bool binary, uint64_t id,
+                                 const SwlIPCResponse *r)
+{
+    SwlJsonWriter *w = &ipc->frame;
+    swl_json_set_encoding(w, binary ? SWL_JSON_CBOR : SWL_JSON_TEXT);
+    if (binary)
+        ipc_frame_begin(w);
+    swl_json_begin_object(w);
+    swl_json_field_uint(w, "id", id);
+    swl_json_field_bool(w, "ok", r->success);
+    if (r->success && r->shared_json) {
+        // Already in this session's encoding; JSON from the writer has no newlines
+        swl_json_key(w, "data");
+        swl_json_raw(w, r->shared_json, r->shared_len);
+    } else if (!r->success) {
+        swl_json_field_string(w, "error", r->error ? r->error : "error");
     }
+    swl_json_end_object(w);
+    if (binary)
+        ipc_frame_end(w);
+    else
+        swl_json_raw(w, "\n", 1);
 
-    char buffer[BUFFER_SIZE];
-    ssize_t n = read(client->fd, buffer, sizeof(buffer) - 1);
-    if (n <= 0) {
+    if (w->failed)
+        return NULL;
+    return swl_outmsg_create(SWL_OUTMSG_REPLY, swl_json_cstr(w), swl_json_len(w));
+}
+
+// The bare reply the one-shot protocol has always sent
+static SwlOutMsg *legacy_reply(const SwlIPCResponse *r)
+{
+    if (r->success && r->shared_json)
+        return swl_outmsg_create(SWL_OUTMSG_REPLY, r->shared_json, r->shared_len);
+
+    const char *reply;
+    if (r->success && r->json)
+        reply = r->json;
+    else if (r->error)
+        reply = r->error;
+    else
+        reply = r->success ? "ok" : "error";
+    return swl_outmsg_create(SWL_OUTMSG_REPLY, reply, strlen(reply));
+}
+
+// Queue the reply and, after "subscribe", hand the connection over to the
+// subscriber list. Returns false once the client is gone.
+static bool send_reply(IPCClient *client, uint64_t id, SwlIPCResponse *response)
+{
+    SwlIPC *ipc = client->ipc;
+    bool binary = client->mode == IPC_CLIENT_BINARY;
+
+    SwlOutMsg *msg = client->mode == IPC_CLIENT_LEGACY
+        ? legacy_reply(response)
+        : reply_envelope(ipc, binary, id, response);
+    // Only after the reply is copied out of it
+    swl_json_set_encoding(&ipc->reply, SWL_JSON_TEXT);
+
+    bool ok = msg && client_send(client, msg);
+    swl_outmsg_unref(msg);
+
+    if (ok && response->keep_open) {
+        /* The subscriber takes over the fd and any replies still queued */
+        int sub_fd = client->fd;
+        uint32_t event_mask = response->event_mask;
+        SwlOutQueue pending = client->out;
+        wl_event_source_remove(client->event_source);
+        free(client);
+        swl_ipc_response_free(response);
+        swl_ipc_add_subscriber(ipc, sub_fd, event_mask, binary, &pending);
+        return false;
+    }
+
+    swl_ipc_response_free(response);
+    if (!ok) {
         ipc_client_cleanup(client);
-        return 0;
+        return false;
     }
-    buffer[n] = '\0';
+    return true;
+}
+
+static bool handle_request(IPCClient *client, uint64_t id, const char *cmd,
+                           const char *args)
+{
+    SwlIPC *ipc = client->ipc;
+    swl_json_set_encoding(&ipc->reply,
+        client->mode == IPC_CLIENT_BINARY ? SWL_JSON_CBOR : SWL_JSON_TEXT);
+
+    SwlIPCResponse response = swl_ipc_execute(ipc, cmd, args);
+    return send_reply(client, id, &response);
+}
 
-    char *space = strchr(buffer, ' ');
-    char *cmd = buffer;
-    char *args = NULL;
+// Split "command args" in place; args is NULL without a space
+static void split_command(char *line, char **args)
+{
+    char *space = strchr(line, ' ');
+    *args = NULL;
     if (space) {
         *space = '\0';
-        args = space + 1;
+        *args = space + 1;
     }
+}
 
-    SwlIPCResponse response = swl_ipc_execute(client->ipc, cmd, args);
+// Drop consumed input. A full buffer is an error only when it holds no
+// complete request, not when requests are waiting for replies to drain.
+static bool compact_input(IPCClient *client, size_t pos)
+{
+    memmove(client->in, client->in + pos, client->in_len - pos);
+    client->in_len -= pos;
+    if (client->in_len == sizeof(client->in) && swl_outqueue_empty(&client->out)) {
+        fprintf(stderr, "ipc: request larger than %d bytes, disconnecting\n", BUFFER_SIZE);
+        ipc_client_cleanup(client);
+        return false;
+    }
+    return true;
+}
 
-    char *reply;
-    if (response.success && response.json)
-        reply = response.json;
-    else if (response.error)
-        reply = response.error;
-    else
-        reply = response.success ? "ok" : "error";
+// Consume whatever complete frames have arrived
+static void process_binary_input(IPCClient *client)
+{
+    const uint8_t *in = (const uint8_t *)client->in;
+    size_t pos = 0;
+
+    if (!client->greeted) {
+        if (client->in_len < SWL_IPC_HELLO_LEN)
+            return;
+        if (memcmp(in, SWL_IPC_HELLO, SWL_IPC_HELLO_LEN) != 0) {
+            ipc_client_cleanup(client);
+            return;
+        }
+
+        SwlOutMsg *hello = swl_outmsg_create(SWL_OUTMSG_REPLY,
+            SWL_IPC_HELLO, SWL_IPC_HELLO_LEN);
+        bool ok = hello && client_send(client, hello);
+        swl_outmsg_unref(hello);
+        if (!ok) {
+            ipc_client_cleanup(client);
+            return;
+        }
+        client->greeted = true;
+        pos = SWL_IPC_HELLO_LEN;
+    }
+
+    char cmd[BUFFER_SIZE], args[BUFFER_SIZE];
+    while (swl_outqueue_empty(&client->out) &&
+           client->in_len - pos >= SWL_IPC_FRAME_HEADER) {
+        const uint8_t *h = in + pos;
+        size_t len = (size_t)h[0] << 24 | (size_t)h[1] << 16 | (size_t)h[2] << 8 | h[3];
+        if (len > sizeof(client->in) - SWL_IPC_FRAME_HEADER) {
+            ipc_client_cleanup(client);
+            return;
+        }
+        if (client->in_len - pos - SWL_IPC_FRAME_HEADER < len)
+            break;
+        pos += SWL_IPC_FRAME_HEADER + len;
+
+        uint64_t id = ++client->requests;
+        bool has_args, alive;
+        if (decode_request(h + SWL_IPC_FRAME_HEADER, len, &id, cmd, args, &has_args)) {
+            alive = handle_request(client, id, cmd, has_args ? args : NULL);
+        } else {
+            SwlIPCResponse response = {.error = strdup("malformed request")};
+            alive = send_reply(client, id, &response);
+        }
+        if (!alive)
+            return;
+    }
+
+    compact_input(client, pos);
+}
+
+// Consume whatever complete lines have arrived
+static void process_text_input(IPCClient *client)
+{
+    size_t pos = 0;
+
+    if (!client->greeted) {
+        SwlOutMsg *hello = swl_outmsg_create(SWL_OUTMSG_REPLY,
+            SWL_IPC_TEXT_HELLO, SWL_IPC_TEXT_HELLO_LEN);
+        bool ok = hello && client_send(client, hello);
+        swl_outmsg_unref(hello);
+        if (!ok) {
+            ipc_client_cleanup(client);
+            return;
+        }
+        client->greeted = true;
+        pos = SWL_IPC_TEXT_HELLO_LEN;
+    }
+
+    char *nl;
+    while (swl_outqueue_empty(&client->out) &&
+           (nl = memchr(client->in + pos, '\n', client->in_len - pos))) {
+        char *line = client->in + pos;
+        pos = (size_t)(nl - client->in) + 1;
+        *nl = '\0';
+        if (nl > line && nl[-1] == '\r')
+            nl[-1] = '\0';
+        if (*line == '\0')
+            continue;
+
+        // Optional leading request id
+        uint64_t id = ++client->requests;
+        if (*line >= '0' && *line <= '9') {
+            char *end;
+            unsigned long long v = strtoull(line, &end, 10);
+            if (*end == ' ' || *end == '\0') {
+                id = v;
+                line = end + strspn(end, " ");
+            }
+        }
+
+        char *args;
+        split_command(line, &args);
+        if (!handle_request(client, id, line, args))
+            return;
+    }
+
+    compact_input(client, pos);
+}
 
-    if (write(client->fd, reply, strlen(reply)) < 0) {
-        swl_ipc_response_free(&response);
+// A single command without a newline: answer it and close, as before
+static void process_legacy_input(IPCClient *client)
+{
+    if (client->in_len == sizeof(client->in)) {
         ipc_client_cleanup(client);
-        return 0;
+        return;
     }
+    client->in[client->in_len] = '\0';
 
-    if (response.keep_open) {
-        /* Convert this client connection to a persistent subscriber */
-        int sub_fd = client->fd;
-        SwlIPC *ipc = client->ipc;
-        uint32_t event_mask_val = response.event_mask;
+    char *args;
+    split_command(client->in, &args);
+    if (!handle_request(client, 0, client->in, args))
+        return;
 
-        /* Remove the IPCClient event source — subscriber gets its own */
-        wl_event_source_remove(client->event_source);
-        free(client);
+    client->closing = true;
+    if (swl_outqueue_empty(&client->out))
+        ipc_client_cleanup(client);
+}
 
-        struct wl_display *display = swl_compositor_get_wl_display(ipc->comp);
-        struct wl_event_loop *loop = wl_display_get_event_loop(display);
-        struct wl_event_source *sub_source = wl_event_loop_add_fd(loop, sub_fd,
-            WL_EVENT_READABLE, handle_subscriber, ipc);
+// Could the input so far still become this hello?
+static bool hello_prefix(const IPCClient *client, const char *hello, size_t len)
+{
+    size_t n = client->in_len < len ? client->in_len : len;
+    return memcmp(client->in, hello, n) == 0;
+}
 
-        swl_ipc_add_subscriber(ipc, sub_fd, sub_source, event_mask_val);
+// Pick the protocol from how the connection opens. Stays undecided while
+// the input is a partial hello; eof means no more input is coming.
+static void detect_mode(IPCClient *client, bool eof)
+{
+    if (hello_prefix(client, SWL_IPC_HELLO, SWL_IPC_HELLO_LEN)) {
+        // process_binary_input() waits for and checks the rest
+        client->mode = IPC_CLIENT_BINARY;
+        client->out.encoding = SWL_JSON_CBOR;
+    } else if (hello_prefix(client, SWL_IPC_TEXT_HELLO, SWL_IPC_TEXT_HELLO_LEN)) {
+        if (client->in_len >= SWL_IPC_TEXT_HELLO_LEN)
+            client->mode = IPC_CLIENT_TEXT;
+        else if (eof)
+            client->mode = IPC_CLIENT_LEGACY;
     } else {
+        client->mode = IPC_CLIENT_LEGACY;
+    }
+}
+
+static void process_input(IPCClient *client)
+{
+    switch (client->mode) {
+    case IPC_CLIENT_BINARY:
+        process_binary_input(client);
+        break;
+    case IPC_CLIENT_TEXT:
+        process_text_input(client);
+        break;
+    case IPC_CLIENT_LEGACY:
+        process_legacy_input(client);
+        break;
+    default:
+        break;
+    }
+}
+
+static int handle_client(int fd, uint32_t mask, void *data)
+{
+    (void)fd;
+    IPCClient *client = data;
+
+    if (mask & (WL_EVENT_HANGUP | WL_EVENT_ERROR)) {
         ipc_client_cleanup(client);
+        return 0;
+    }
+
+    if (mask & WL_EVENT_WRITABLE) {
+        if (!client_flush(client)) {
+            ipc_client_cleanup(client);
+            return 0;
+        }
+        if (!swl_outqueue_empty(&client->out))
+            return 0;
+        if (client->closing) {
+            ipc_client_cleanup(client);
+            return 0;
+        }
+        // Requests that arrived while the replies were backed up
+        if (client->in_len > 0) {
+            process_input(client);
+            return 0;
+        }
+    }
+
+    if (!(mask & WL_EVENT_READABLE) || client->closing ||
+        !swl_outqueue_empty(&client->out))
+        return 0;
+
+    ssize_t n = read(client->fd, client->in + client->in_len,
+                     sizeof(client->in) - client->in_len);
+    if (n < 0 && (errno == EAGAIN || errno == EINTR))
+        return 0;
+    if (n < 0) {
+        ipc_client_cleanup(client);
+        return 0;
+    }
+
+    if (n == 0) {
+        // The client is done sending: input that never became a session
+        // is a one-shot command, otherwise finish writing the replies
+        if (client->mode == IPC_CLIENT_NEW && client->in_len > 0) {
+            detect_mode(client, true);
+            process_input(client);
+            return 0;
+        }
+        client->closing = true;
+        if (swl_outqueue_empty(&client->out))
+            ipc_client_cleanup(client);
+        return 0;
     }
+    client->in_len += (size_t)n;
 
-    swl_ipc_response_free(&response);
+    if (client->mode == IPC_CLIENT_NEW)
+        detect_mode(client, false);
+    process_input(client);
     return 0;
 }
@@ -5,6 +5,7 @@
 #include "monitor.h"
 #include "scene.h"
 #include "events.h"
+#include "input.h"
 #include <stdlib.h>
 #include <string.h>
 #include <wayland-server-core.h>
@@ -59,12 +60,21 @@ static struct wlr_scene_tree *layer_to_scene_tree(SwlLayerManager *mgr, enum zwl
     }
 }
 
+// Background and bottom surfaces feed the cached optimized blur
+static bool is_below_clients(const SwlLayerSurface *surface)
+{
+    return surface->layer_surface->current.layer == ZWLR_LAYER_SHELL_V1_LAYER_BACKGROUND ||
+           surface->layer_surface->current.layer == ZWLR_LAYER_SHELL_V1_LAYER_BOTTOM;
+}
+
 static void layer_surface_handle_map(struct wl_listener *listener, void *data)
 {
     SwlLayerSurface *surface = wl_container_of(listener, surface, map);
     (void)data;
 
     surface->mapped = true;
+    if (is_below_clients(surface))
+        swl_monitor_invalidate_blur(surface->mon);
     swl_layer_arrange(surface->mgr, surface->mon);
 
     // Update keyboard focus if requested
@@ -87,6 +97,8 @@ static void layer_surface_handle_unmap(struct wl_listener *listener, void *data)
     (void)data;
 
     surface->mapped = false;
+    if (is_below_clients(surface))
+        swl_monitor_invalidate_blur(surface->mon);
     swl_layer_arrange(surface->mgr, surface->mon);
 
     // Restore keyboard focus to the previously focused client
@@ -149,8 +161,16 @@ static void layer_surface_handle_commit(struct wl_listener *listener, void *data
                     ? swl_scene_get_layer(scene_mgr, SWL_LAYER_TOP) : new_tree;
             wlr_scene_node_reparent(&surface->popup_tree->node, popup_parent);
         }
+        swl_input_scene_changed(swl_compositor_get_input(surface->mgr->comp));
     }
 
+    // New content under the clients invalidates the cached blur; also
+    // covers moving into or out of those layers
+    bool new_buffer = surface->layer_surface->surface->current.committed & WLR_SURFACE_STATE_BUFFER;
+    if (surface->mapped && ((new_buffer && is_below_clients(surface)) ||
+                            (committed & WLR_LAYER_SURFACE_V1_STATE_LAYER)))
+        swl_monitor_invalidate_blur(surface->mon);
+
     // Arrange to send configure (initial or update)
     swl_layer_arrange(surface->mgr, surface->mon);
 }
@@ -322,6 +342,7 @@ void swl_layer_arrange(SwlLayerManager *mgr, SwlMonitor *mon)
 
     int usable_x = full_x, usable_y = full_y;
     int usable_w = full_w, usable_h = full_h;
+    bool moved = false;
 
     // Process layers in order: background, bottom, top, overlay
     // Apply exclusive zones for each layer
@@ -367,6 +388,9 @@ void swl_layer_arrange(SwlLayerManager *mgr, SwlMonitor *mon)
             wlr_scene_layer_surface_v1_configure(scene_surface, &bounds, &bounds);
 
             // Track surface position and sync popup tree
+            if (scene_surface->tree->node.x != surface->x ||
+                scene_surface->tree->node.y != surface->y)
+                moved = true;
             surface->x = scene_surface->tree->node.x;
             surface->y = scene_surface->tree->node.y;
             if (surface->popup_tree)
@@ -379,6 +403,11 @@ void swl_layer_arrange(SwlLayerManager *mgr, SwlMonitor *mon)
         }
     }
 
+    // Every layer commit comes through here, only a moved surface changes
+    // what the pointer hits
+    if (moved)
+        swl_input_scene_changed(swl_compositor_get_input(mgr->comp));
+
     // Update monitor's usable area
     swl_monitor_set_usable_area(mon, usable_x, usable_y, usable_w, usable_h);
 
@@ -6,6 +6,9 @@
 #include "client.h"
 #include "layer.h"
 #include "events.h"
+#include "latency.h"
+#include "render.h"
+#include "scene.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,12 +17,18 @@
 #include <wlr/backend.h>
 #include <wlr/render/allocator.h>
 #include <wlr/render/wlr_renderer.h>
+#include <wlr/types/wlr_compositor.h>
 #include <wlr/types/wlr_output.h>
 #include <wlr/types/wlr_output_layout.h>
 #include <wlr/types/wlr_output_management_v1.h>
 #include <wlr/types/wlr_damage_ring.h>
 #include <scenefx/types/wlr_scene.h>
 
+#define RENDER_TIME_AUTO -1
+#define RENDER_TIME_SLACK_NS 1000000  // Safety margin before the deadline
+#define RENDER_TIME_MIN_DELAY_NS 1000000  // Not worth arming a timer below this
+#define LATENCY_MAX_PENDING_NS 250000000  // Input nothing answered is dropped after this
+
 struct SwlMonitor {
     uint32_t id;
     SwlOutputManager *mgr;
@@ -36,7 +45,27 @@ struct SwlMonitor {
     int gap_inner_h, gap_inner_v;
     int gap_outer_h, gap_outer_v;
 
+    // Late commit: render just before the predicted vblank instead of
+    // right after the previous one
+    int max_render_time;  // ms, 0 = off, RENDER_TIME_AUTO = measured
+    struct wl_event_source *render_timer;
+    struct wl_event_source *frame_done_timer;  // Wakes throttled clients, see send_frame_done()
+    int64_t render_time_ns;     // Smoothed render duration
+    int64_t last_present_ns;
+    int64_t refresh_ns;         // From present feedback, 0 if unknown
+
+    // Blurred copy of the background/bottom layers for optimized blur
+    struct wlr_scene_optimized_blur *blur_cache;
+
+    // Input-to-present latency: input the focused client answered waits in
+    // pending for the next frame, then in inflight until it is presented
+    SwlLatencyStats latency;
+    int64_t latency_pending_ns;
+    int64_t latency_inflight_ns;
+    int64_t latency_logged_ns;
+
     struct wl_listener frame;
+    struct wl_listener present;
     struct wl_listener destroy;
     struct wl_listener request_state;
 
@@ -56,9 +85,15 @@ struct SwlOutputManager {
 
     struct wl_listener new_output;
     struct wl_listener layout_change;
+
+    int64_t input_ns;              // Earliest input no client has answered yet
+    int64_t latency_log_interval_ns;  // 0 = no periodic log
 };
 
 static void handle_frame(struct wl_listener *listener, void *data);
+static void handle_present(struct wl_listener *listener, void *data);
+static int handle_render_timer(void *data);
+static int handle_frame_done_timer(void *data);
 static void handle_destroy(struct wl_listener *listener, void *data);
 static void handle_request_state(struct wl_listener *listener, void *data);
 static void handle_new_output(struct wl_listener *listener, void *data);
@@ -67,6 +102,7 @@ static void handle_output_mgmt_apply(struct wl_listener *listener, void *data);
 static void handle_output_mgmt_test(struct wl_listener *listener, void *data);
 static void update_output_management(SwlOutputManager *mgr);
 static void apply_monitor_rules(SwlMonitor *mon);
+static void update_blur_cache(SwlMonitor *mon);
 
 /* Data structure for restore_client_to_monitor callback */
 typedef struct {
@@ -86,6 +122,13 @@ static bool restore_client_to_monitor(SwlClient *c, void *data)
     return true;
 }
 
+static void load_latency_config(SwlOutputManager *mgr)
+{
+    SwlConfig *cfg = swl_compositor_get_config(mgr->comp);
+    int interval = swl_config_get_int(cfg, "general.latency_log_interval", 0);
+    mgr->latency_log_interval_ns = interval > 0 ? (int64_t)interval * 1000000000 : 0;
+}
+
 SwlOutputManager *swl_output_create(SwlCompositor *comp)
 {
     SwlOutputManager *mgr = calloc(1, sizeof(*mgr));
@@ -95,6 +138,7 @@ SwlOutputManager *swl_output_create(SwlCompositor *comp)
     mgr->comp = comp;
     mgr->next_id = 1;
     wl_list_init(&mgr->monitors);
+    load_latency_config(mgr);
 
     // Use the compositor's output layout (shared with XDG output manager)
     mgr->layout = swl_compositor_get_output_layout(comp);
@@ -135,9 +179,14 @@ void swl_output_destroy(SwlOutputManager *mgr)
         // Remove all listeners before freeing to prevent use-after-free
         // when backend destroy triggers output destroy signals
         wl_list_remove(&mon->frame.link);
+        wl_list_remove(&mon->present.link);
         wl_list_remove(&mon->destroy.link);
         wl_list_remove(&mon->request_state.link);
         wl_list_remove(&mon->link);
+        if (mon->render_timer)
+            wl_event_source_remove(mon->render_timer);
+        if (mon->frame_done_timer)
+            wl_event_source_remove(mon->frame_done_timer);
         free(mon);
     }
 
@@ -216,6 +265,13 @@ static void handle_new_output(struct wl_listener *listener, void *data)
     // Manually set scene output position to match layout
     wlr_scene_output_set_position(mon->scene_output, mon->x, mon->y);
 
+    SwlSceneManager *scene_mgr =
+        swl_client_manager_get_scene(swl_compositor_get_clients(mgr->comp));
+    struct wlr_scene_tree *blur_layer = swl_scene_get_layer(scene_mgr, SWL_LAYER_BLUR);
+    if (blur_layer)
+        mon->blur_cache = wlr_scene_optimized_blur_create(blur_layer, 0, 0);
+    update_blur_cache(mon);
+
     fprintf(stderr, "Monitor %s: pos=(%d,%d) size=%dx%d scene_output=(%d,%d)\n",
             output->name, mon->x, mon->y, mon->width, mon->height,
             mon->scene_output->x, mon->scene_output->y);
@@ -223,6 +279,14 @@ static void handle_new_output(struct wl_listener *listener, void *data)
     mon->frame.notify = handle_frame;
     wl_signal_add(&output->events.frame, &mon->frame);
 
+    mon->present.notify = handle_present;
+    wl_signal_add(&output->events.present, &mon->present);
+
+    struct wl_event_loop *loop =
+        wl_display_get_event_loop(swl_compositor_get_wl_display(mgr->comp));
+    mon->render_timer = wl_event_loop_add_timer(loop, handle_render_timer, mon);
+    mon->frame_done_timer = wl_event_loop_add_timer(loop, handle_frame_done_timer, mon);
+
     mon->destroy.notify = handle_destroy;
     wl_signal_add(&output->events.destroy, &mon->destroy);
 
@@ -259,6 +323,166 @@ static void handle_new_output(struct wl_listener *listener, void *data)
     update_output_management(mgr);
 }
 
+static int64_t timespec_to_ns(const struct timespec *ts)
+{
+    return (int64_t)ts->tv_sec * 1000000000 + ts->tv_nsec;
+}
+
+static int64_t refresh_period_ns(const SwlMonitor *mon)
+{
+    if (mon->refresh_ns > 0)
+        return mon->refresh_ns;
+    if (mon->output->refresh > 0)
+        return 1000000000000LL / mon->output->refresh;  // refresh is mHz
+    return 0;
+}
+
+typedef struct {
+    SwlMonitor *mon;
+    SwlRenderer *renderer;
+    const struct timespec *now;
+    int64_t now_ns;
+    int64_t refresh_ns;
+    int64_t next_ns;  // Earliest withheld callback, 0 if none
+    bool withheld_only;  // Timer pass, skip clients the throttle didn't hold back
+} FrameDoneContext;
+
+static SwlClient *client_from_node(struct wlr_scene_node *node)
+{
+    // Client trees carry their SwlClient in node.data, see swl_scene_client_create()
+    while (node && !node->data)
+        node = node->parent ? &node->parent->node : NULL;
+
+    if (!node || !swl_client_is_valid(node->data))
+        return NULL;
+    return node->data;
+}
+
+static void frame_done_iterator(struct wlr_scene_buffer *buffer, int sx, int sy, void *data)
+{
+    FrameDoneContext *ctx = data;
+    (void)sx;
+    (void)sy;
+
+    if (buffer->primary_output != ctx->mon->scene_output)
+        return;
+
+    struct wlr_scene_surface *scene_surface = wlr_scene_surface_try_from_buffer(buffer);
+    if (!scene_surface)
+        return;
+
+    struct wlr_surface *surface = scene_surface->surface;
+    if (wl_list_empty(&surface->current.frame_callback_list))
+        return;
+
+    SwlClient *client = client_from_node(&buffer->node);
+    // Everyone else gets their callbacks on the next vblank
+    if (ctx->withheld_only &&
+        (!client || !swl_renderer_frame_withheld(ctx->renderer, client, ctx->now_ns)))
+        return;
+
+    int64_t next_ns = 0;
+    if (client && !swl_renderer_should_send_frame(ctx->renderer, client, ctx->now_ns,
+                                                  ctx->refresh_ns, &next_ns)) {
+        if (ctx->next_ns == 0 || next_ns < ctx->next_ns)
+            ctx->next_ns = next_ns;
+        return;
+    }
+
+    wlr_surface_send_frame_done(surface, ctx->now);
+}
+
+// Like wlr_scene_output_send_frame_done(), but unfocused clients may be
+// throttled per [scenefx.throttle] and their render profile. withheld_only
+// limits the pass to callbacks a previous pass held back.
+static void send_frame_done(SwlMonitor *mon, const struct timespec *now, bool withheld_only)
+{
+    FrameDoneContext ctx = {
+        .mon = mon,
+        .renderer = swl_compositor_get_renderer(mon->mgr->comp),
+        .now = now,
+        .now_ns = timespec_to_ns(now),
+        .refresh_ns = refresh_period_ns(mon),
+        .withheld_only = withheld_only,
+    };
+    wlr_scene_output_for_each_buffer(mon->scene_output, frame_done_iterator, &ctx);
+
+    // Withheld callbacks go out from the timer when they are due, so an
+    // otherwise idle output doesn't have to keep committing frames
+    int delay_ms = 0;
+    if (ctx.next_ns > 0) {
+        int64_t wait = ctx.next_ns - ctx.now_ns;
+        delay_ms = wait > 0 ? (int)((wait + 999999) / 1000000) : 1;
+    }
+    wl_event_source_timer_update(mon->frame_done_timer, delay_ms);
+}
+
+static int handle_frame_done_timer(void *data)
+{
+    SwlMonitor *mon = data;
+    if (!mon->output->enabled)
+        return 0;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    send_frame_done(mon, &now, true);
+    return 0;
+}
+
+static void render_monitor(SwlMonitor *mon)
+{
+    if (!mon->output->enabled)
+        return;
+
+    // Windows dragged or resized since the last frame land in the scene now
+    swl_client_manager_flush_interactive(swl_compositor_get_clients(mon->mgr->comp));
+
+    // Only frames that actually render count towards the estimate
+    bool needs_frame = wlr_scene_output_needs_frame(mon->scene_output);
+
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    bool committed = wlr_scene_output_commit(mon->scene_output, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if (committed && needs_frame)
+        swl_compositor_note_first_frame(mon->mgr->comp);
+
+    if (needs_frame && mon->latency_pending_ns && !mon->latency_inflight_ns) {
+        mon->latency_inflight_ns = mon->latency_pending_ns;
+        mon->latency_pending_ns = 0;
+    }
+
+    if (needs_frame) {
+        int64_t duration = timespec_to_ns(&now) - timespec_to_ns(&start);
+        // Follow spikes immediately so we don't keep missing the deadline,
+        // decay slowly once frames get cheaper again
+        if (duration > mon->render_time_ns)
+            mon->render_time_ns = duration;
+        else
+            mon->render_time_ns += (duration - mon->render_time_ns) / 8;
+
+        SwlRenderer *renderer = swl_compositor_get_renderer(mon->mgr->comp);
+        swl_renderer_report_frame(renderer, mon, duration, refresh_period_ns(mon));
+    }
+
+    send_frame_done(mon, &now, false);
+}
+
+static int64_t render_budget_ns(const SwlMonitor *mon)
+{
+    int64_t budget = mon->render_time_ns + RENDER_TIME_SLACK_NS;
+
+    // A fixed budget is a lower bound, never plan less than rendering takes
+    if (mon->max_render_time > 0) {
+        int64_t fixed = (int64_t)mon->max_render_time * 1000000;
+        if (fixed > budget)
+            budget = fixed;
+    }
+
+    return budget;
+}
+
 static void handle_frame(struct wl_listener *listener, void *data)
 {
     SwlMonitor *mon = wl_container_of(listener, mon, frame);
@@ -267,11 +491,79 @@ static void handle_frame(struct wl_listener *listener, void *data)
     if (!mon->output->enabled)
         return;
 
-    wlr_scene_output_commit(mon->scene_output, NULL);
+    if (mon->max_render_time == 0 || !mon->render_timer) {
+        render_monitor(mon);
+        return;
+    }
 
-    struct timespec now;
-    clock_gettime(CLOCK_MONOTONIC, &now);
-    wlr_scene_output_send_frame_done(mon->scene_output, &now);
+    int64_t refresh = refresh_period_ns(mon);
+    if (refresh <= 0 || mon->last_present_ns == 0) {
+        render_monitor(mon);
+        return;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    int64_t now = timespec_to_ns(&ts);
+
+    // Predict the next vblank from the last presentation
+    int64_t next = mon->last_present_ns + refresh;
+    if (next <= now)
+        next += ((now - next) / refresh + 1) * refresh;
+
+    int64_t delay = next - now - render_budget_ns(mon);
+    if (delay < RENDER_TIME_MIN_DELAY_NS) {
+        render_monitor(mon);
+        return;
+    }
+
+    wl_event_source_timer_update(mon->render_timer, (int)(delay / 1000000));
+}
+
+static int handle_render_timer(void *data)
+{
+    SwlMonitor *mon = data;
+    render_monitor(mon);
+    return 0;
+}
+
+static void log_latency(SwlMonitor *mon)
+{
+    int64_t interval = mon->mgr->latency_log_interval_ns;
+    if (interval <= 0 || mon->last_present_ns - mon->latency_logged_ns < interval)
+        return;
+
+    mon->latency_logged_ns = mon->last_present_ns;
+    SwlLatencySummary sum = swl_latency_summary(&mon->latency);
+    fprintf(stderr, "swl: latency %s: p50 %.2fms p95 %.2fms p99 %.2fms (%zu samples)\n",
+            mon->output->name, sum.p50_ns / 1e6, sum.p95_ns / 1e6, sum.p99_ns / 1e6,
+            sum.samples);
+}
+
+static void handle_present(struct wl_listener *listener, void *data)
+{
+    SwlMonitor *mon = wl_container_of(listener, mon, present);
+    struct wlr_output_event_present *event = data;
+
+    if (!event->presented) {
+        // The input that frame carried is shown by the next one, and is
+        // older than anything queued since
+        if (mon->latency_inflight_ns) {
+            mon->latency_pending_ns = mon->latency_inflight_ns;
+            mon->latency_inflight_ns = 0;
+        }
+        return;
+    }
+
+    mon->last_present_ns = timespec_to_ns(&event->when);
+    if (event->refresh > 0)
+        mon->refresh_ns = event->refresh;
+
+    if (mon->latency_inflight_ns) {
+        swl_latency_add(&mon->latency, mon->last_present_ns - mon->latency_inflight_ns);
+        mon->latency_inflight_ns = 0;
+        log_latency(mon);
+    }
 }
 
 static void handle_destroy(struct wl_listener *listener, void *data)
@@ -289,12 +581,21 @@ static void handle_destroy(struct wl_listener *listener, void *data)
     // don't dereference a freed monitor pointer.
     SwlLayerManager *layers = swl_compositor_get_layer_manager(mon->mgr->comp);
     swl_layer_cleanup_monitor(layers, mon);
+    swl_renderer_forget_output(swl_compositor_get_renderer(mon->mgr->comp), mon);
 
     wl_list_remove(&mon->frame.link);
+    wl_list_remove(&mon->present.link);
     wl_list_remove(&mon->destroy.link);
     wl_list_remove(&mon->request_state.link);
     wl_list_remove(&mon->link);
 
+    if (mon->render_timer)
+        wl_event_source_remove(mon->render_timer);
+    if (mon->frame_done_timer)
+        wl_event_source_remove(mon->frame_done_timer);
+    if (mon->blur_cache)
+        wlr_scene_node_destroy(&mon->blur_cache->node);
+
     if (mon->mgr->focused == mon) {
         if (!wl_list_empty(&mon->mgr->monitors))
             mon->mgr->focused = wl_container_of(mon->mgr->monitors.next, mon->mgr->focused, link);
@@ -344,6 +645,8 @@ static void handle_layout_change(struct wl_listener *listener, void *data)
                     mon->output->name, mon->x, mon->y,
                     mon->scene_output->x, mon->scene_output->y);
         }
+
+        update_blur_cache(mon);
     }
 
     update_output_management(mgr);
@@ -543,6 +846,20 @@ static void apply_monitor_rules(SwlMonitor *mon)
         mon->scroller_ratio = swl_config_get_float(cfg, key, mon->scroller_ratio);
     }
 
+    // Late commit: an integer budget in ms, "auto" to use measured render
+    // times, or "off" (default) to render as soon as the frame event fires
+    snprintf(key, sizeof(key), "monitors.%s.max_render_time", name);
+    mon->max_render_time = 0;
+    if (swl_config_has_key(cfg, key)) {
+        const char *mode = swl_config_get_string(cfg, key, NULL);
+        if (mode && strcmp(mode, "auto") == 0)
+            mon->max_render_time = RENDER_TIME_AUTO;
+        else if (!mode) {
+            int ms = swl_config_get_int(cfg, key, 0);
+            mon->max_render_time = ms > 0 ? ms : 0;
+        }
+    }
+
     snprintf(key, sizeof(key), "monitors.%s.layout", name);
     if (swl_config_has_key(cfg, key)) {
         const char *layout_name = swl_config_get_string(cfg, key, NULL);
@@ -681,6 +998,8 @@ SwlMonitorInfo swl_monitor_get_info(const SwlMonitor *mon)
     info.scale = mon->output->scale;
     info.transform = mon->output->transform;
     info.enabled = mon->output->enabled;
+    info.max_render_time = mon->max_render_time;
+    info.render_time_us = (int)(mon->render_time_ns / 1000);
 
     return info;
 }
@@ -803,6 +1122,21 @@ static bool collect_tiled_client(SwlClient *c, void *data)
     return true;
 }
 
+static bool place_fullscreen_client(SwlClient *c, void *data)
+{
+    SwlMonitor *mon = data;
+    SwlClientInfo info = swl_client_get_info(c);
+
+    if (!info.fullscreen)
+        return true;
+
+    // Content covers the whole output, borders fall outside and get clipped
+    int bw = info.border_width;
+    swl_client_resize(c, mon->x - bw, mon->y - bw,
+        mon->width + 2 * bw, mon->height + 2 * bw);
+    return true;
+}
+
 void swl_monitor_arrange(SwlMonitor *mon)
 {
     if (!mon)
@@ -812,6 +1146,9 @@ void swl_monitor_arrange(SwlMonitor *mon)
     if (!clients)
         return;
 
+    swl_client_foreach_visible(clients, mon, place_fullscreen_client, mon);
+    swl_client_update_occlusion(clients, mon);
+
     ClientCollector col = {0};
     swl_client_foreach_visible(clients, mon, collect_tiled_client, &col);
 
@@ -935,10 +1272,33 @@ void swl_monitor_arrange_all(SwlOutputManager *mgr)
     }
 }
 
+static void update_blur_cache(SwlMonitor *mon)
+{
+    if (!mon->blur_cache)
+        return;
+
+    // Only worth keeping around if clients actually sample it
+    SwlRenderer *renderer = swl_compositor_get_renderer(mon->mgr->comp);
+    SwlRenderConfig cfg = swl_renderer_get_config(renderer);
+    wlr_scene_node_set_enabled(&mon->blur_cache->node,
+        cfg.blur_enabled && cfg.blur_optimize);
+
+    wlr_scene_node_set_position(&mon->blur_cache->node, mon->x, mon->y);
+    wlr_scene_optimized_blur_set_size(mon->blur_cache, mon->width, mon->height);
+    wlr_scene_optimized_blur_mark_dirty(mon->blur_cache);
+}
+
+void swl_monitor_invalidate_blur(SwlMonitor *mon)
+{
+    if (mon && mon->blur_cache)
+        wlr_scene_optimized_blur_mark_dirty(mon->blur_cache);
+}
+
 void swl_monitor_damage_whole(SwlMonitor *mon)
 {
     if (!mon || !mon->scene_output)
         return;
+    swl_monitor_invalidate_blur(mon);
     wlr_damage_ring_add_whole(&mon->scene_output->damage_ring);
     wlr_output_schedule_frame(mon->output);
 }
@@ -948,9 +1308,46 @@ void swl_monitor_reload_config(SwlOutputManager *mgr)
     if (!mgr)
         return;
 
+    load_latency_config(mgr);
+
     SwlMonitor *mon;
     wl_list_for_each(mon, &mgr->monitors, link) {
         apply_monitor_rules(mon);
+        update_blur_cache(mon);
         swl_monitor_arrange(mon);
     }
 }
+
+void swl_output_note_input(SwlOutputManager *mgr, uint32_t time_msec)
+{
+    if (!mgr)
+        return;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    int64_t now = timespec_to_ns(&ts);
+
+    // Keep the oldest unanswered input, unless nothing answered it in time
+    if (mgr->input_ns && now - mgr->input_ns < LATENCY_MAX_PENDING_NS)
+        return;
+
+    mgr->input_ns = swl_latency_event_ns(time_msec, now);
+}
+
+void swl_monitor_note_client_damage(SwlMonitor *mon)
+{
+    if (!mon || !mon->mgr->input_ns)
+        return;
+
+    if (!mon->latency_pending_ns)
+        mon->latency_pending_ns = mon->mgr->input_ns;
+    mon->mgr->input_ns = 0;
+}
+
+SwlLatencySummary swl_monitor_get_latency(const SwlMonitor *mon)
+{
+    if (!mon)
+        return (SwlLatencySummary){0};
+
+    return swl_latency_summary(&mon->latency);
+}
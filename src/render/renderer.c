@@ -3,18 +3,87 @@
 #include "config.h"
 #include "client.h"
 #include "monitor.h"
+#include "scene.h"
+#include "scene_internal.h"
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <scenefx/render/fx_renderer/fx_renderer.h>
 #include <scenefx/types/wlr_scene.h>
 #include <scenefx/types/fx/blur_data.h>
 
+#define MAX_GOVERNED_OUTPUTS 16
+#define GOVERNOR_OVER_FRAMES 3         // Consecutive slow frames before degrading
+#define GOVERNOR_HEADROOM_FRAMES 120   // Consecutive fast frames before restoring
+
+typedef struct {
+    SwlMonitor *mon;
+    int over;      // Consecutive frames over budget
+    int headroom;  // Consecutive frames well under budget
+} GovernedOutput;
+
 struct SwlRenderer {
     SwlCompositor *comp;
     struct fx_renderer *fx;
     SwlRenderConfig config;
+
+    // Effect-quality governor
+    bool governor_enabled;
+    float governor_budget;  // Fraction of the refresh interval a frame may take
+    int quality_level;
+    int max_quality_level;
+    GovernedOutput outputs[MAX_GOVERNED_OUTPUTS];
 };
 
+static void load_governor_config(SwlRenderer *r, SwlConfig *cfg)
+{
+    r->governor_enabled = swl_config_get_bool(cfg, "scenefx.governor.enabled", false);
+    r->governor_budget = swl_config_get_float(cfg, "scenefx.governor.budget", 0.5f);
+    if (r->governor_budget <= 0.0f || r->governor_budget > 1.0f)
+        r->governor_budget = 0.5f;
+    r->max_quality_level = swl_config_get_int(cfg, "scenefx.governor.max_level", 4);
+    if (r->max_quality_level < 0)
+        r->max_quality_level = 0;
+
+    if (!r->governor_enabled)
+        r->quality_level = 0;
+    else if (r->quality_level > r->max_quality_level)
+        r->quality_level = r->max_quality_level;
+}
+
+static int effective_blur_passes(const SwlRenderer *r)
+{
+    int passes = r->config.blur_passes;
+    if (passes <= 1)
+        return passes;
+
+    passes -= r->quality_level;
+    return passes < 1 ? 1 : passes;
+}
+
+static int effective_blur_radius(const SwlRenderer *r)
+{
+    int radius = r->config.blur_radius;
+    if (radius <= 1)
+        return radius;
+
+    int steps = r->max_quality_level + 1;
+    radius = radius * (steps - r->quality_level) / steps;
+    return radius < 1 ? 1 : radius;
+}
+
+static bool update_client_iterator(SwlClient *c, void *data);
+
+static void apply_blur(SwlRenderer *r)
+{
+    struct wlr_scene *scene = swl_compositor_get_scene(r->comp);
+    if (!scene)
+        return;
+
+    wlr_scene_set_blur_data(scene, effective_blur_passes(r), effective_blur_radius(r),
+        0.0f, 1.0f, 1.0f, 1.0f);  // noise, brightness, contrast, saturation
+}
+
 SwlRenderer *swl_renderer_create(SwlCompositor *comp)
 {
     SwlRenderer *r = calloc(1, sizeof(*r));
@@ -26,6 +95,7 @@ SwlRenderer *swl_renderer_create(SwlCompositor *comp)
     SwlConfig *cfg = swl_compositor_get_config(comp);
 
     // Blur settings
+    r->config.blur_enabled = swl_config_get_bool(cfg, "scenefx.blur.enabled", false);
     r->config.blur_radius = swl_config_get_int(cfg, "scenefx.blur.radius", 5);
     r->config.blur_passes = swl_config_get_int(cfg, "scenefx.blur.passes", 3);
     r->config.blur_optimize = swl_config_get_bool(cfg, "scenefx.blur.optimized", true);
@@ -50,6 +120,10 @@ SwlRenderer *swl_renderer_create(SwlCompositor *comp)
     r->config.opacity_active = swl_config_get_float(cfg, "scenefx.opacity.active", 1.0f);
     r->config.opacity_inactive = swl_config_get_float(cfg, "scenefx.opacity.inactive", 0.9f);
 
+    // Frame callback throttling for unfocused clients
+    r->config.throttle_divisor = swl_config_get_int(cfg, "scenefx.throttle.unfocused_divisor", 1);
+    r->config.throttle_hz = swl_config_get_int(cfg, "scenefx.throttle.unfocused_hz", 0);
+
     // Animation settings
     r->config.animations_enabled = true;
     r->config.animation_duration_ms = 200;
@@ -79,6 +153,9 @@ SwlRenderer *swl_renderer_create(SwlCompositor *comp)
         r->config.border_color_urgent[3] = 1.0f;
     }
 
+    load_governor_config(r, cfg);
+    apply_blur(r);
+
     return r;
 }
 
@@ -105,6 +182,7 @@ SwlError swl_renderer_reload_config(SwlRenderer *r)
     if (!cfg)
         return SWL_ERR_INVALID_ARG;
 
+    r->config.blur_enabled = swl_config_get_bool(cfg, "scenefx.blur.enabled", false);
     r->config.blur_radius = swl_config_get_int(cfg, "scenefx.blur.radius", 5);
     r->config.blur_passes = swl_config_get_int(cfg, "scenefx.blur.passes", 3);
     r->config.blur_optimize = swl_config_get_bool(cfg, "scenefx.blur.optimized", true);
@@ -124,6 +202,10 @@ SwlError swl_renderer_reload_config(SwlRenderer *r)
     r->config.opacity_active = swl_config_get_float(cfg, "scenefx.opacity.active", 1.0f);
     r->config.opacity_inactive = swl_config_get_float(cfg, "scenefx.opacity.inactive", 0.9f);
 
+    // Frame callback throttling for unfocused clients
+    r->config.throttle_divisor = swl_config_get_int(cfg, "scenefx.throttle.unfocused_divisor", 1);
+    r->config.throttle_hz = swl_config_get_int(cfg, "scenefx.throttle.unfocused_hz", 0);
+
     r->config.border_width = swl_config_get_int(cfg, "appearance.border_width", 2);
 
     if (swl_config_get_color(cfg, "appearance.colors.focus", r->config.border_color_focused) != SWL_OK) {
@@ -147,6 +229,13 @@ SwlError swl_renderer_reload_config(SwlRenderer *r)
         r->config.border_color_urgent[3] = 1.0f;
     }
 
+    load_governor_config(r, cfg);
+    apply_blur(r);
+
+    SwlClientManager *clients = swl_compositor_get_clients(r->comp);
+    if (clients)
+        swl_client_foreach(clients, update_client_iterator, r);
+
     return SWL_OK;
 }
 
@@ -159,13 +248,24 @@ SwlRenderConfig swl_renderer_get_config(const SwlRenderer *r)
     return r->config;
 }
 
+static ClientSceneData *client_data(const SwlClient *c)
+{
+    return swl_client_get_scene_data((SwlClient *)c);
+}
+
 SwlError swl_renderer_set_client_opacity(SwlRenderer *r, SwlClient *c, float opacity)
 {
     if (!r || !c)
         return SWL_ERR_INVALID_ARG;
 
-    (void)opacity;
-    // TODO: Set opacity via scenefx
+    ClientSceneData *data = client_data(c);
+    if (!data)
+        return SWL_ERR_NOT_FOUND;
+
+    data->profile.set |= SWL_PROFILE_OPACITY_ACTIVE | SWL_PROFILE_OPACITY_INACTIVE;
+    data->profile.opacity_active = opacity;
+    data->profile.opacity_inactive = opacity;
+    swl_renderer_update_client(r, c);
     return SWL_OK;
 }
 
@@ -174,8 +274,13 @@ SwlError swl_renderer_set_client_blur(SwlRenderer *r, SwlClient *c, bool blur)
     if (!r || !c)
         return SWL_ERR_INVALID_ARG;
 
-    (void)blur;
-    // TODO: Set blur via scenefx
+    ClientSceneData *data = client_data(c);
+    if (!data)
+        return SWL_ERR_NOT_FOUND;
+
+    data->profile.set |= SWL_PROFILE_BLUR;
+    data->profile.blur = blur;
+    swl_renderer_update_client(r, c);
     return SWL_OK;
 }
 
@@ -184,28 +289,126 @@ SwlError swl_renderer_set_client_shadow(SwlRenderer *r, SwlClient *c, bool shado
     if (!r || !c)
         return SWL_ERR_INVALID_ARG;
 
-    (void)shadow;
-    // TODO: Set shadow via scenefx
+    ClientSceneData *data = client_data(c);
+    if (!data)
+        return SWL_ERR_NOT_FOUND;
+
+    data->profile.set |= SWL_PROFILE_SHADOW;
+    data->profile.shadow = shadow;
+    swl_renderer_update_client(r, c);
     return SWL_OK;
 }
 
 SwlError swl_renderer_set_client_corner_radius(SwlRenderer *r, SwlClient *c, int radius)
 {
-    if (!r || !c)
+    if (!r || !c || radius < 0)
+        return SWL_ERR_INVALID_ARG;
+
+    ClientSceneData *data = client_data(c);
+    if (!data)
+        return SWL_ERR_NOT_FOUND;
+
+    data->profile.set |= SWL_PROFILE_CORNER_RADIUS;
+    data->profile.corner_radius = radius;
+    swl_renderer_update_client(r, c);
+    return SWL_OK;
+}
+
+SwlError swl_renderer_set_client_profile(SwlRenderer *r, SwlClient *c, const SwlRenderProfile *profile)
+{
+    if (!r || !c || !profile)
         return SWL_ERR_INVALID_ARG;
 
-    (void)radius;
-    // TODO: Set corner radius via scenefx
+    ClientSceneData *data = client_data(c);
+    if (!data)
+        return SWL_ERR_NOT_FOUND;
+
+    data->profile = *profile;
+    swl_renderer_update_client(r, c);
     return SWL_OK;
 }
 
+SwlRenderProfile swl_renderer_get_client_profile(const SwlRenderer *r, const SwlClient *c)
+{
+    SwlRenderProfile profile = {0};
+    if (!r || !c)
+        return profile;
+
+    ClientSceneData *data = client_data(c);
+    if (data)
+        profile = data->profile;
+    return profile;
+}
+
+bool swl_renderer_should_send_frame(SwlRenderer *r, SwlClient *c, int64_t now_ns,
+                                    int64_t refresh_ns, int64_t *next_ns)
+{
+    if (!r || !c)
+        return true;
+
+    ClientSceneData *data = client_data(c);
+    if (!data)
+        return true;
+
+    // Several buffers of one client share a frame, decide once
+    if (data->frame_ns == now_ns) {
+        if (!data->frame_sent && next_ns)
+            *next_ns = data->frame_next_ns;
+        return data->frame_sent;
+    }
+    data->frame_ns = now_ns;
+
+    const SwlRenderProfile *p = &data->profile;
+    int divisor = (p->set & SWL_PROFILE_THROTTLE) ? p->throttle_divisor : r->config.throttle_divisor;
+    int hz = (p->set & SWL_PROFILE_THROTTLE) ? p->throttle_hz : r->config.throttle_hz;
+
+    if (refresh_ns <= 0)
+        refresh_ns = 1000000000LL / 60;
+
+    // Both modes are an interval, so a timer can wake the client without
+    // driving output frames in between
+    int64_t interval = 0;
+    if (!swl_client_get_info(c).focused) {
+        if (hz > 0)
+            interval = 1000000000LL / hz;
+        else if (divisor > 1)
+            interval = divisor * refresh_ns;
+    }
+
+    // Frames land on vblanks, allow a little early so a client isn't held
+    // a whole extra refresh for jitter
+    int64_t next = data->frame_sent_ns + interval - (interval > 0 ? refresh_ns / 4 : 0);
+    bool send = interval == 0 || now_ns >= next;
+
+    data->frame_sent = send;
+    if (send) {
+        data->frame_sent_ns = now_ns;
+    } else {
+        data->frame_next_ns = next;
+        if (next_ns)
+            *next_ns = next;
+    }
+    return send;
+}
+
+bool swl_renderer_frame_withheld(const SwlRenderer *r, const SwlClient *c, int64_t now_ns)
+{
+    if (!r || !c)
+        return false;
+
+    ClientSceneData *data = client_data(c);
+    if (!data || data->frame_ns == 0)
+        return false;
+    return data->frame_ns == now_ns || !data->frame_sent;
+}
+
 float swl_renderer_get_client_opacity(const SwlRenderer *r, const SwlClient *c)
 {
     if (!r || !c)
         return 1.0f;
 
-    // TODO: Get from client data
-    return 1.0f;
+    ClientSceneData *data = client_data(c);
+    return data ? data->opacity : 1.0f;
 }
 
 bool swl_renderer_get_client_blur(const SwlRenderer *r, const SwlClient *c)
@@ -213,8 +416,8 @@ bool swl_renderer_get_client_blur(const SwlRenderer *r, const SwlClient *c)
     if (!r || !c)
         return false;
 
-    // TODO: Get from client data
-    return false;
+    ClientSceneData *data = client_data(c);
+    return data ? data->blur : false;
 }
 
 bool swl_renderer_get_client_shadow(const SwlRenderer *r, const SwlClient *c)
@@ -222,8 +425,8 @@ bool swl_renderer_get_client_shadow(const SwlRenderer *r, const SwlClient *c)
     if (!r || !c)
         return false;
 
-    // TODO: Get from client data
-    return false;
+    ClientSceneData *data = client_data(c);
+    return data ? data->shadow_enabled : false;
 }
 
 int swl_renderer_get_client_corner_radius(const SwlRenderer *r, const SwlClient *c)
@@ -231,8 +434,8 @@ int swl_renderer_get_client_corner_radius(const SwlRenderer *r, const SwlClient
     if (!r || !c)
         return 0;
 
-    // TODO: Get from client data
-    return 0;
+    ClientSceneData *data = client_data(c);
+    return data ? data->corner_radius : r->config.corner_radius;
 }
 
 static bool damage_whole_iterator(SwlMonitor *mon, void *data)
@@ -251,3 +454,148 @@ void swl_renderer_damage_whole(SwlRenderer *r)
     if (output)
         swl_monitor_foreach(output, damage_whole_iterator, NULL);
 }
+
+static bool update_client_iterator(SwlClient *c, void *data)
+{
+    swl_renderer_update_client(data, c);
+    return true;
+}
+
+void swl_renderer_update_client(SwlRenderer *r, SwlClient *c)
+{
+    if (!r || !c)
+        return;
+
+    ClientSceneData *data = client_data(c);
+    if (!data)
+        return;
+
+    const SwlRenderProfile *p = &data->profile;
+    SwlClientInfo info = swl_client_get_info(c);
+
+    float opacity;
+    if (info.focused)
+        opacity = (p->set & SWL_PROFILE_OPACITY_ACTIVE) ? p->opacity_active : r->config.opacity_active;
+    else
+        opacity = (p->set & SWL_PROFILE_OPACITY_INACTIVE) ? p->opacity_inactive : r->config.opacity_inactive;
+    swl_scene_client_set_opacity(c, opacity);
+
+    int radius = (p->set & SWL_PROFILE_CORNER_RADIUS) ? p->corner_radius : r->config.corner_radius;
+    if (radius != data->corner_radius)
+        swl_scene_client_set_corner_radius(c, radius);
+
+    // Degraded quality drops shadows on everything but the focused client
+    bool shadow = (p->set & SWL_PROFILE_SHADOW) ? p->shadow : r->config.shadow_enabled;
+    shadow = shadow && (info.focused || r->quality_level == 0);
+    if (shadow || data->shadow)
+        swl_scene_client_set_shadow(c, shadow, r->config.shadow_radius, r->config.shadow_color);
+
+    bool blur = (p->set & SWL_PROFILE_BLUR) ? p->blur : r->config.blur_enabled;
+    swl_scene_client_set_blur(c, blur, r->config.blur_optimize,
+        r->config.blur_ignore_transparent);
+}
+
+static void set_quality_level(SwlRenderer *r, int level)
+{
+    if (level == r->quality_level)
+        return;
+
+    fprintf(stderr, "Render quality level %d -> %d\n", r->quality_level, level);
+    r->quality_level = level;
+    apply_blur(r);
+
+    SwlClientManager *clients = swl_compositor_get_clients(r->comp);
+    if (clients)
+        swl_client_foreach(clients, update_client_iterator, r);
+
+    swl_renderer_damage_whole(r);
+}
+
+static GovernedOutput *governed_output(SwlRenderer *r, SwlMonitor *mon)
+{
+    GovernedOutput *free_slot = NULL;
+    for (size_t i = 0; i < MAX_GOVERNED_OUTPUTS; i++) {
+        if (r->outputs[i].mon == mon)
+            return &r->outputs[i];
+        if (!r->outputs[i].mon && !free_slot)
+            free_slot = &r->outputs[i];
+    }
+
+    if (free_slot) {
+        free_slot->mon = mon;
+        free_slot->over = 0;
+        free_slot->headroom = 0;
+    }
+    return free_slot;
+}
+
+void swl_renderer_report_frame(SwlRenderer *r, SwlMonitor *mon,
+                               int64_t render_ns, int64_t refresh_ns)
+{
+    if (!r || !mon || !r->governor_enabled || refresh_ns <= 0)
+        return;
+
+    GovernedOutput *o = governed_output(r, mon);
+    if (!o)
+        return;
+
+    // Two thresholds give hysteresis: slower than budget degrades, faster
+    // than half of it restores, anything in between keeps the level
+    int64_t budget = (int64_t)(refresh_ns * r->governor_budget);
+    if (render_ns > budget) {
+        o->over++;
+        o->headroom = 0;
+    } else if (render_ns < budget / 2) {
+        o->headroom++;
+        o->over = 0;
+    } else {
+        o->over = 0;
+        o->headroom = 0;
+    }
+
+    if (o->over >= GOVERNOR_OVER_FRAMES) {
+        o->over = 0;
+        if (r->quality_level < r->max_quality_level)
+            set_quality_level(r, r->quality_level + 1);
+        return;
+    }
+
+    if (o->headroom >= GOVERNOR_HEADROOM_FRAMES) {
+        o->headroom = 0;
+        if (r->quality_level == 0)
+            return;
+
+        // Quality is shared by all outputs, only restore if none is struggling
+        for (size_t i = 0; i < MAX_GOVERNED_OUTPUTS; i++) {
+            if (r->outputs[i].mon && r->outputs[i].over > 0)
+                return;
+        }
+        set_quality_level(r, r->quality_level - 1);
+    }
+}
+
+void swl_renderer_forget_output(SwlRenderer *r, SwlMonitor *mon)
+{
+    if (!r || !mon)
+        return;
+
+    for (size_t i = 0; i < MAX_GOVERNED_OUTPUTS; i++) {
+        if (r->outputs[i].mon == mon)
+            memset(&r->outputs[i], 0, sizeof(r->outputs[i]));
+    }
+}
+
+SwlRenderQuality swl_renderer_get_quality(const SwlRenderer *r)
+{
+    SwlRenderQuality q = {0};
+    if (!r)
+        return q;
+
+    q.governor_enabled = r->governor_enabled;
+    q.level = r->quality_level;
+    q.max_level = r->max_quality_level;
+    q.blur_passes = effective_blur_passes(r);
+    q.blur_radius = effective_blur_radius(r);
+    q.unfocused_shadows = r->config.shadow_enabled && r->quality_level == 0;
+    return q;
+}
@@ -1,4 +1,5 @@
 #include "scene.h"
+#include "scene_internal.h"
 #include "compositor.h"
 #include "client.h"
 #include "render.h"
@@ -53,18 +54,6 @@ struct wlr_scene_tree *swl_scene_get_layer(SwlSceneManager *mgr, SwlSceneLayer l
     return mgr->layers[layer];
 }
 
-typedef struct {
-    struct wlr_scene_tree *tree;
-    struct wlr_scene_tree *surface_tree;
-    struct wlr_scene_rect *border;  // Single rect with clipped interior for hollow border
-    struct wlr_scene_shadow *shadow;
-    int border_width;
-    int corner_radius;
-    float opacity;
-} ClientSceneData;
-
-extern ClientSceneData *swl_client_get_scene_data(SwlClient *client);
-extern void swl_client_set_scene_data(SwlClient *client, ClientSceneData *data);
 extern struct wlr_xdg_toplevel *swl_client_get_xdg_toplevel(SwlClient *client);
 #ifdef SWL_XWAYLAND
 extern struct wlr_xwayland_surface *swl_client_get_xwayland_surface(SwlClient *client);
@@ -72,6 +61,7 @@ extern struct wlr_xwayland_surface *swl_client_get_xwayland_surface(SwlClient *c
 
 static void set_corner_radius_recursive(struct wlr_scene_node *node, int radius,
                                          enum corner_location corners);
+static void set_blur_recursive(struct wlr_scene_node *node, const ClientSceneData *data);
 
 SwlError swl_scene_client_create(SwlSceneManager *mgr, SwlClient *client)
 {
@@ -122,6 +112,7 @@ SwlError swl_scene_client_create(SwlSceneManager *mgr, SwlClient *client)
             cfg.corner_radius, (float)cfg.shadow_radius, cfg.shadow_color);
         if (data->shadow) {
             wlr_scene_node_lower_to_bottom(&data->shadow->node);
+            data->shadow_enabled = true;
         }
     }
 
@@ -226,9 +217,15 @@ void swl_scene_client_set_size(SwlClient *client, int width, int height)
 
         // Update corner radius for properly clipped surface
         set_corner_radius_recursive(&data->surface_tree->node, inner_radius, CORNER_LOCATION_ALL);
+
+        // Subsurfaces may have brought new buffers along
+        set_blur_recursive(&data->surface_tree->node, data);
     }
 
-    if (toplevel && toplevel->base->initialized)
+    // Every set_size schedules a configure, skip it when this size was
+    // already requested; a client that hasn't acked it yet has it coming
+    if (toplevel && toplevel->base->initialized &&
+        (toplevel->scheduled.width != width || toplevel->scheduled.height != height))
         wlr_xdg_toplevel_set_size(toplevel, width, height);
 }
 
@@ -269,6 +266,7 @@ void swl_scene_update_client_size(SwlClient *client, int width, int height)
     // Update surface buffer corner radius
     if (data->surface_tree) {
         set_corner_radius_recursive(&data->surface_tree->node, inner_radius, CORNER_LOCATION_ALL);
+        set_blur_recursive(&data->surface_tree->node, data);
     }
 
     // Note: Does NOT send configure to client - used for client-initiated resizes
@@ -405,6 +403,7 @@ void swl_scene_client_set_clip(SwlClient *client, int clip_x, int clip_y, int cl
         corners &= ~CORNER_LOCATION_BOTTOM;
 
     // Hide shadow when clipping (shadow extends beyond window bounds)
+    data->clipped = true;
     if (data->shadow)
         wlr_scene_node_set_enabled(&data->shadow->node, false);
 
@@ -481,9 +480,10 @@ void swl_scene_client_clear_clip(SwlClient *client)
     // Restore surface buffer corner radius (uses inner radius)
     set_corner_radius_recursive(&data->surface_tree->node, inner_radius, CORNER_LOCATION_ALL);
 
-    // Re-enable shadow
+    // Re-enable shadow unless it was turned off
+    data->clipped = false;
     if (data->shadow)
-        wlr_scene_node_set_enabled(&data->shadow->node, true);
+        wlr_scene_node_set_enabled(&data->shadow->node, data->shadow_enabled);
 
     // Restore border to full size
     SwlClientInfo info = swl_client_get_info(client);
@@ -530,14 +530,27 @@ void swl_scene_client_set_shadow(SwlClient *client, bool enabled, int blur_sigma
     if (!data)
         return;
 
+    data->shadow_enabled = enabled;
+
     if (!enabled) {
         if (data->shadow)
             wlr_scene_node_set_enabled(&data->shadow->node, false);
         return;
     }
 
+    // A rule can turn shadows on for a client created while they were off
+    if (!data->shadow && data->tree) {
+        SwlClientInfo info = swl_client_get_info(client);
+        int bw = data->border_width;
+        data->shadow = wlr_scene_shadow_create(data->tree,
+            info.geometry.width + 2 * bw, info.geometry.height + 2 * bw,
+            data->corner_radius, (float)blur_sigma, color);
+        if (data->shadow)
+            wlr_scene_node_lower_to_bottom(&data->shadow->node);
+    }
+
     if (data->shadow) {
-        wlr_scene_node_set_enabled(&data->shadow->node, true);
+        wlr_scene_node_set_enabled(&data->shadow->node, !data->clipped);
         wlr_scene_shadow_set_blur_sigma(data->shadow, (float)blur_sigma);
         wlr_scene_shadow_set_color(data->shadow, color);
     }
@@ -562,6 +575,43 @@ static void set_corner_radius_recursive(struct wlr_scene_node *node, int radius,
     }
 }
 
+// Recursively set backdrop blur on all buffer nodes in a tree
+static void set_blur_recursive(struct wlr_scene_node *node, const ClientSceneData *data)
+{
+    if (!node)
+        return;
+
+    if (node->type == WLR_SCENE_NODE_BUFFER) {
+        struct wlr_scene_buffer *buf = wlr_scene_buffer_from_node(node);
+        wlr_scene_buffer_set_backdrop_blur(buf, data->blur);
+        wlr_scene_buffer_set_backdrop_blur_optimized(buf, data->blur_optimized);
+        wlr_scene_buffer_set_backdrop_blur_ignore_transparent(buf, data->blur_ignore_transparent);
+    } else if (node->type == WLR_SCENE_NODE_TREE) {
+        struct wlr_scene_tree *tree = wlr_scene_tree_from_node(node);
+        struct wlr_scene_node *child;
+        wl_list_for_each(child, &tree->children, link) {
+            set_blur_recursive(child, data);
+        }
+    }
+}
+
+void swl_scene_client_set_blur(SwlClient *client, bool enabled, bool optimized, bool ignore_transparent)
+{
+    if (!client)
+        return;
+
+    ClientSceneData *data = swl_client_get_scene_data(client);
+    if (!data)
+        return;
+
+    data->blur = enabled;
+    data->blur_optimized = enabled && optimized;
+    data->blur_ignore_transparent = ignore_transparent;
+
+    if (data->surface_tree)
+        set_blur_recursive(&data->surface_tree->node, data);
+}
+
 void swl_scene_client_set_corner_radius(SwlClient *client, int radius)
 {
     if (!client)
@@ -625,3 +675,15 @@ void swl_scene_client_set_opacity(SwlClient *client, float opacity)
         }
     }
 }
+
+float swl_scene_client_get_opacity(SwlClient *client)
+{
+    if (!client)
+        return 1.0f;
+
+    ClientSceneData *data = swl_client_get_scene_data(client);
+    if (!data)
+        return 1.0f;
+
+    return data->opacity;
+}
@@ -0,0 +1,38 @@
+#ifndef SWL_SCENE_INTERNAL_H
+#define SWL_SCENE_INTERNAL_H
+
+#include "render.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+struct wlr_scene_tree;
+struct wlr_scene_rect;
+struct wlr_scene_shadow;
+
+typedef struct {
+    struct wlr_scene_tree *tree;
+    struct wlr_scene_tree *surface_tree;
+    struct wlr_scene_rect *border;  // Single rect with clipped interior for hollow border
+    struct wlr_scene_shadow *shadow;
+    bool shadow_enabled;  // Wanted by config/governor
+    bool clipped;         // Shadow hidden while clipped at a monitor edge
+    bool blur;
+    bool blur_optimized;  // Sample the per-output cache instead of the live scene
+    bool blur_ignore_transparent;
+    int border_width;
+    int corner_radius;
+    float opacity;
+    SwlRenderProfile profile;  // Overrides from window rules or IPC
+
+    // Frame callback throttling state, see swl_renderer_should_send_frame()
+    int64_t frame_ns;       // Frame the last decision was made for
+    bool frame_sent;
+    int64_t frame_sent_ns;
+    int64_t frame_next_ns;  // Earliest time a held callback may go out
+} ClientSceneData;
+
+/* Provided by client.c */
+ClientSceneData *swl_client_get_scene_data(SwlClient *client);
+void swl_client_set_scene_data(SwlClient *client, ClientSceneData *data);
+
+#endif /* SWL_SCENE_INTERNAL_H */
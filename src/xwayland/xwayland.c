@@ -4,6 +4,7 @@
 
 #include "compositor.h"
 #include "client.h"
+#include "config.h"
 #include "events.h"
 #include "monitor.h"
 #include "scene.h"
@@ -20,10 +21,12 @@
 struct SwlXWayland {
     SwlCompositor *comp;
     struct wlr_xwayland *xwayland;
+    bool lazy;
     bool ready;
 
     struct wl_listener xwl_ready;
     struct wl_listener new_surface;
+    struct wl_listener server_start;
 };
 
 // Forward declaration of X11 client creation
@@ -31,6 +34,7 @@ extern SwlClient *swl_client_create_x11(SwlClientManager *mgr, struct wlr_xwayla
 
 static void handle_ready(struct wl_listener *listener, void *data);
 static void handle_new_surface(struct wl_listener *listener, void *data);
+static void handle_server_start(struct wl_listener *listener, void *data);
 
 SwlXWayland *swl_xwayland_create(SwlCompositor *comp)
 {
@@ -43,7 +47,12 @@ SwlXWayland *swl_xwayland_create(SwlCompositor *comp)
     struct wl_display *display = swl_compositor_get_wl_display(comp);
     struct wlr_compositor *wlr_comp = swl_compositor_get_wlr_compositor(comp);
 
-    xwl->xwayland = wlr_xwayland_create(display, wlr_comp, true);
+    // Lazy: only the X display socket is reserved now, the Xwayland server
+    // is started when the first X client connects
+    SwlConfig *cfg = swl_compositor_get_config(comp);
+    xwl->lazy = swl_config_get_bool(cfg, "xwayland.lazy", true);
+
+    xwl->xwayland = wlr_xwayland_create(display, wlr_comp, xwl->lazy);
     if (!xwl->xwayland) {
         fprintf(stderr, "Failed to create XWayland\n");
         free(xwl);
@@ -56,7 +65,11 @@ SwlXWayland *swl_xwayland_create(SwlCompositor *comp)
     xwl->new_surface.notify = handle_new_surface;
     wl_signal_add(&xwl->xwayland->events.new_surface, &xwl->new_surface);
 
-    fprintf(stderr, "XWayland initialized, display: %s\n", xwl->xwayland->display_name);
+    xwl->server_start.notify = handle_server_start;
+    wl_signal_add(&xwl->xwayland->server->events.start, &xwl->server_start);
+
+    fprintf(stderr, "XWayland initialized, display: %s%s\n", xwl->xwayland->display_name,
+            xwl->lazy ? " (starts on first X client)" : "");
 
     return xwl;
 }
@@ -68,6 +81,7 @@ void swl_xwayland_destroy(SwlXWayland *xwl)
 
     wl_list_remove(&xwl->xwl_ready.link);
     wl_list_remove(&xwl->new_surface.link);
+    wl_list_remove(&xwl->server_start.link);
 
     if (xwl->xwayland)
         wlr_xwayland_destroy(xwl->xwayland);
@@ -89,6 +103,19 @@ static void handle_ready(struct wl_listener *listener, void *data)
     fprintf(stderr, "XWayland ready\n");
 }
 
+static void handle_server_start(struct wl_listener *listener, void *data)
+{
+    SwlXWayland *xwl = wl_container_of(listener, xwl, server_start);
+    (void)data;
+
+    // A lazy server that exited after its last client went away can be
+    // started again; it is not ready until the window manager reconnects
+    xwl->ready = false;
+
+    if (xwl->lazy)
+        fprintf(stderr, "XWayland: X client connected, starting server\n");
+}
+
 static void handle_new_surface(struct wl_listener *listener, void *data)
 {
     SwlXWayland *xwl = wl_container_of(listener, xwl, new_surface);
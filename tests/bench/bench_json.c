@@ -0,0 +1,171 @@
+// Serializes a get-windows reply for a large synthetic window list, the way
+// cmd_get_windows used to (sprintf into one buffer, no escaping, sized here
+// so it cannot overflow) and with the JSON writer, fresh per call and reused
+// across calls like the IPC reply writer. The reused writer is also timed in
+// CBOR mode, as binary IPC clients get it.
+//
+// Usage: bench_json [windows] [iterations]
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "json.h"
+
+#define DEFAULT_WINDOWS 5000
+#define DEFAULT_ITERATIONS 200
+
+typedef struct {
+    uint32_t id;
+    char app_id[64];
+    char title[160];
+    int x, y, width, height;
+    bool floating, fullscreen, focused;
+} Window;
+
+typedef struct {
+    int64_t best_ns;
+    size_t bytes;
+} Result;
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void make_windows(Window *wins, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        Window *w = &wins[i];
+        w->id = (uint32_t)i + 1;
+        snprintf(w->app_id, sizeof(w->app_id), "org.example.App%zu", i % 37);
+        // Long titles with characters that need escaping
+        snprintf(w->title, sizeof(w->title),
+                 "\"Project %zu\" - ~/src/swl/src/ipc/commands.c \\ build\tlog - "
+                 "Editor (\xc3\xa9\xe2\x80\x94 unsaved changes)", i);
+        w->x = (int)(i * 13 % 3840);
+        w->y = (int)(i * 7 % 2160);
+        w->width = 800 + (int)(i % 400);
+        w->height = 600 + (int)(i % 300);
+        w->floating = i % 5 == 0;
+        w->fullscreen = false;
+        w->focused = i == 0;
+    }
+}
+
+static size_t serialize_sprintf(const Window *wins, size_t count, char *json)
+{
+    int offset = 0;
+    offset += sprintf(json + offset, "[");
+    for (size_t i = 0; i < count; i++) {
+        const Window *w = &wins[i];
+        if (i > 0) offset += sprintf(json + offset, ",");
+        offset += sprintf(json + offset,
+            "{\"id\":%u,\"app_id\":\"%s\",\"title\":\"%s\","
+            "\"x\":%d,\"y\":%d,\"width\":%d,\"height\":%d,"
+            "\"floating\":%s,\"fullscreen\":%s,\"focused\":%s}",
+            w->id, w->app_id, w->title, w->x, w->y, w->width, w->height,
+            w->floating ? "true" : "false",
+            w->fullscreen ? "true" : "false",
+            w->focused ? "true" : "false");
+    }
+    offset += sprintf(json + offset, "]");
+    return (size_t)offset;
+}
+
+static void serialize_writer(const Window *wins, size_t count, SwlJsonWriter *jw)
+{
+    swl_json_begin_array(jw);
+    for (size_t i = 0; i < count; i++) {
+        const Window *w = &wins[i];
+        swl_json_begin_object(jw);
+        swl_json_field_uint(jw, "id", w->id);
+        swl_json_field_string(jw, "app_id", w->app_id);
+        swl_json_field_string(jw, "title", w->title);
+        swl_json_field_int(jw, "x", w->x);
+        swl_json_field_int(jw, "y", w->y);
+        swl_json_field_int(jw, "width", w->width);
+        swl_json_field_int(jw, "height", w->height);
+        swl_json_field_bool(jw, "floating", w->floating);
+        swl_json_field_bool(jw, "fullscreen", w->fullscreen);
+        swl_json_field_bool(jw, "focused", w->focused);
+        swl_json_end_object(jw);
+    }
+    swl_json_end_array(jw);
+}
+
+static void print_result(const char *name, const Result *r, size_t count)
+{
+    printf("%-16s %10.1f us/reply %8.1f ns/window %9zu bytes\n", name,
+           (double)r->best_ns / 1000.0, (double)r->best_ns / (double)count, r->bytes);
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_WINDOWS;
+    int iterations = argc > 2 ? atoi(argv[2]) : DEFAULT_ITERATIONS;
+    if (count == 0)
+        count = DEFAULT_WINDOWS;
+    if (iterations <= 0)
+        iterations = DEFAULT_ITERATIONS;
+
+    Window *wins = calloc(count, sizeof(*wins));
+    char *fixed = malloc(count * 512 + 16);
+    if (!wins || !fixed) {
+        fprintf(stderr, "bench_json: out of memory\n");
+        return 1;
+    }
+    make_windows(wins, count);
+
+    Result base = {.best_ns = INT64_MAX}, fresh = base, reused = base, cbor = base;
+    SwlJsonWriter shared, binary;
+    swl_json_init(&shared);
+    swl_json_init(&binary);
+    swl_json_set_encoding(&binary, SWL_JSON_CBOR);
+
+    for (int it = 0; it < iterations; it++) {
+        int64_t t0 = now_ns();
+        base.bytes = serialize_sprintf(wins, count, fixed);
+        int64_t t1 = now_ns();
+
+        SwlJsonWriter jw;
+        swl_json_init(&jw);
+        serialize_writer(wins, count, &jw);
+        fresh.bytes = jw.len;
+        swl_json_finish(&jw);
+        int64_t t2 = now_ns();
+
+        swl_json_reset(&shared);
+        serialize_writer(wins, count, &shared);
+        reused.bytes = shared.len;
+        int64_t t3 = now_ns();
+
+        swl_json_reset(&binary);
+        serialize_writer(wins, count, &binary);
+        cbor.bytes = binary.len;
+        int64_t t4 = now_ns();
+
+        if (t1 - t0 < base.best_ns) base.best_ns = t1 - t0;
+        if (t2 - t1 < fresh.best_ns) fresh.best_ns = t2 - t1;
+        if (t3 - t2 < reused.best_ns) reused.best_ns = t3 - t2;
+        if (t4 - t3 < cbor.best_ns) cbor.best_ns = t4 - t3;
+    }
+
+    printf("%zu windows, best of %d\n", count, iterations);
+    print_result("sprintf", &base, count);
+    print_result("writer (fresh)", &fresh, count);
+    print_result("writer (reused)", &reused, count);
+    print_result("writer (cbor)", &cbor, count);
+
+    swl_json_finish(&shared);
+    swl_json_finish(&binary);
+    free(fixed);
+    free(wins);
+    return 0;
+}
@@ -0,0 +1,292 @@
+// Replays a pointer motion trace through the hit-testing path, once the way
+// every event used to be handled and once with coalescing, the cached hit
+// box and rate-limited idle notifications.
+//
+// Usage: bench_motion [trace]
+//
+// A trace has one "time_usec dx dy" line per motion event, with an empty
+// line wherever the event loop woke up (events between two empty lines
+// arrive in one dispatch). Without a trace a synthetic 1000 Hz sweep
+// across the scene is used.
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "motion.h"
+
+#define SCREEN_W 3840
+#define SCREEN_H 2160
+#define MAX_NODES 256
+#define IDLE_INTERVAL_NS (100 * 1000000LL)
+
+typedef struct {
+    uint32_t time_usec;
+    double dx, dy;
+    bool dispatch_end;  // Last event of a dispatch
+} TraceEvent;
+
+typedef struct {
+    TraceEvent *events;
+    size_t count, cap;
+} Trace;
+
+// Flattened scene, bottom to top, like the order wlr_scene renders in
+typedef struct {
+    SwlMotionBox nodes[MAX_NODES];
+    size_t count;
+    SwlMotionBox monitors[2];
+} Scene;
+
+typedef struct {
+    size_t dispatches;
+    size_t processed;   // Motions that reached hit-testing
+    size_t queries;     // Full scene walks
+    size_t idle_notifies;
+    int64_t elapsed_ns;
+    uintptr_t checksum;
+} Result;
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static bool trace_push(Trace *t, TraceEvent ev)
+{
+    if (t->count == t->cap) {
+        size_t cap = t->cap ? t->cap * 2 : 4096;
+        TraceEvent *events = realloc(t->events, cap * sizeof(*events));
+        if (!events)
+            return false;
+        t->events = events;
+        t->cap = cap;
+    }
+    t->events[t->count++] = ev;
+    return true;
+}
+
+static bool trace_load(Trace *t, const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+        TraceEvent ev = {0};
+        if (line[0] == '\n' || line[0] == '\0') {
+            if (t->count > 0)
+                t->events[t->count - 1].dispatch_end = true;
+            continue;
+        }
+        if (sscanf(line, "%u %lf %lf", &ev.time_usec, &ev.dx, &ev.dy) != 3)
+            continue;
+        if (!trace_push(t, ev)) {
+            fclose(f);
+            return false;
+        }
+    }
+    fclose(f);
+
+    if (t->count > 0)
+        t->events[t->count - 1].dispatch_end = true;
+    return t->count > 0;
+}
+
+// Ten seconds of a 1000 Hz mouse sweeping back and forth across the
+// screen, with 1-4 events waiting per wakeup
+static bool trace_synthesize(Trace *t)
+{
+    uint32_t seed = 1;
+    size_t left = 0;
+    for (uint32_t i = 0; i < 10000; i++) {
+        double phase = (double)(i % 4000) / 4000.0;
+        TraceEvent ev = {
+            .time_usec = i * 1000,
+            .dx = phase < 0.5 ? 3.0 : -3.0,
+            .dy = (i % 50) < 25 ? 1.0 : -1.0,
+        };
+        if (left == 0) {
+            seed = seed * 1103515245 + 12345;
+            left = 1 + (seed >> 16) % 4;
+        }
+        ev.dispatch_end = --left == 0;
+        if (!trace_push(t, ev))
+            return false;
+    }
+    t->events[t->count - 1].dispatch_end = true;
+    return true;
+}
+
+// Two monitors of tiled windows, each with a shadow, border and surface,
+// plus a few popups stacked on top
+static void scene_build(Scene *s)
+{
+    s->monitors[0] = (SwlMotionBox){ 0, 0, SCREEN_W / 2, SCREEN_H };
+    s->monitors[1] = (SwlMotionBox){ SCREEN_W / 2, 0, SCREEN_W / 2, SCREEN_H };
+
+    s->count = 0;
+    int cols = 8, rows = 4;
+    int w = SCREEN_W / cols, h = SCREEN_H / rows;
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            int x = c * w, y = r * h;
+            s->nodes[s->count++] = (SwlMotionBox){ x - 8, y - 8, w + 16, h + 16 };
+            s->nodes[s->count++] = (SwlMotionBox){ x, y, w, h };
+            s->nodes[s->count++] = (SwlMotionBox){ x + 2, y + 2, w - 4, h - 4 };
+        }
+    }
+    for (int i = 0; i < 6; i++)
+        s->nodes[s->count++] = (SwlMotionBox){ 300 + i * 550, 500 + i * 200, 240, 320 };
+}
+
+// Top-down search, what wlr_scene_node_at() does
+static int scene_node_at(const Scene *s, double x, double y)
+{
+    for (size_t i = s->count; i-- > 0;) {
+        if (swl_motion_box_contains(&s->nodes[i], x, y))
+            return (int)i;
+    }
+    return -1;
+}
+
+static int monitor_at(const Scene *s, double x, double y)
+{
+    for (int i = 0; i < 2; i++) {
+        if (swl_motion_box_contains(&s->monitors[i], x, y))
+            return i;
+    }
+    return -1;
+}
+
+static void clamp_cursor(double *x, double *y)
+{
+    if (*x < 0) *x = 0;
+    if (*y < 0) *y = 0;
+    if (*x > SCREEN_W - 1) *x = SCREEN_W - 1;
+    if (*y > SCREEN_H - 1) *y = SCREEN_H - 1;
+}
+
+static Result run_baseline(const Scene *s, const Trace *t)
+{
+    Result res = {0};
+    double x = SCREEN_W / 2.0, y = SCREEN_H / 2.0;
+    int64_t start = now_ns();
+
+    for (size_t i = 0; i < t->count; i++) {
+        const TraceEvent *ev = &t->events[i];
+        x += ev->dx;
+        y += ev->dy;
+        clamp_cursor(&x, &y);
+
+        res.idle_notifies++;
+        res.checksum += (uintptr_t)monitor_at(s, x, y);
+        res.checksum += (uintptr_t)scene_node_at(s, x, y);
+        res.queries++;
+        res.processed++;
+        if (ev->dispatch_end)
+            res.dispatches++;
+    }
+
+    res.elapsed_ns = now_ns() - start;
+    return res;
+}
+
+static Result run_optimized(const Scene *s, const Trace *t)
+{
+    Result res = {0};
+    SwlMotionState m;
+    swl_motion_init(&m, IDLE_INTERVAL_NS);
+
+    double x = SCREEN_W / 2.0, y = SCREEN_H / 2.0;
+    int hit = -1, mon = -1;
+    int64_t start = now_ns();
+
+    for (size_t i = 0; i < t->count; i++) {
+        const TraceEvent *ev = &t->events[i];
+        x += ev->dx;
+        y += ev->dy;
+        clamp_cursor(&x, &y);
+
+        if (swl_motion_should_notify_idle(&m, (int64_t)ev->time_usec * 1000))
+            res.idle_notifies++;
+        swl_motion_push(&m, ev->time_usec / 1000);
+
+        if (!ev->dispatch_end)
+            continue;
+        res.dispatches++;
+
+        if (!swl_motion_take(&m, NULL))
+            continue;
+        res.processed++;
+
+        if (mon < 0 || !swl_motion_box_contains(&s->monitors[mon], x, y))
+            mon = monitor_at(s, x, y);
+
+        if (!swl_motion_hit_cached(&m, x, y)) {
+            res.queries++;
+            hit = scene_node_at(s, x, y);
+            swl_motion_invalidate(&m);
+            if (hit >= 0) {
+                SwlMotionBox box = s->nodes[hit];
+                bool ok = true;
+                for (size_t n = (size_t)hit + 1; ok && n < s->count; n++)
+                    ok = swl_motion_box_exclude(&box, &s->nodes[n], x, y);
+                if (ok)
+                    swl_motion_set_hit(&m, &box);
+            }
+        }
+        res.checksum += (uintptr_t)mon + (uintptr_t)hit;
+    }
+
+    res.elapsed_ns = now_ns() - start;
+    return res;
+}
+
+static void print_result(const char *name, const Result *r, size_t events)
+{
+    printf("%-10s %8zu events %8zu dispatches %8zu processed %8zu scene queries "
+           "%8zu idle notifies %8.1f ns/event\n",
+           name, events, r->dispatches, r->processed, r->queries, r->idle_notifies,
+           events ? (double)r->elapsed_ns / (double)events : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+    Trace trace = {0};
+    bool ok = argc > 1 ? trace_load(&trace, argv[1]) : trace_synthesize(&trace);
+    if (!ok) {
+        fprintf(stderr, "bench_motion: no trace events\n");
+        free(trace.events);
+        return 1;
+    }
+
+    Scene scene;
+    scene_build(&scene);
+
+    // Warm up, then keep the best of a few runs
+    Result base = run_baseline(&scene, &trace);
+    Result opt = run_optimized(&scene, &trace);
+    for (int i = 0; i < 5; i++) {
+        Result b = run_baseline(&scene, &trace);
+        Result o = run_optimized(&scene, &trace);
+        if (b.elapsed_ns < base.elapsed_ns)
+            base = b;
+        if (o.elapsed_ns < opt.elapsed_ns)
+            opt = o;
+    }
+
+    print_result("baseline", &base, trace.count);
+    print_result("optimized", &opt, trace.count);
+
+    free(trace.events);
+    return 0;
+}
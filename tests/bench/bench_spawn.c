@@ -0,0 +1,131 @@
+// Measures the cost of the spawn action: how long the compositor is blocked
+// in the call, and how long until the child has exec'd. Runs the fork() +
+// exec path spawn sites used to have against swl_process_spawn_shell, with
+// a large touched heap standing in for the compositor's GPU, DRM and scene
+// mappings (fork has to copy their page tables).
+//
+// Usage: bench_spawn [resident_mb] [iterations]
+
+#define _DEFAULT_SOURCE  // MADV_NOHUGEPAGE
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "latency.h"
+#include "process.h"
+
+#define DEFAULT_RESIDENT_MB 256
+#define DEFAULT_ITERATIONS 100
+#define COMMAND "true"
+
+typedef pid_t (*SpawnFunc)(const char *command);
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// What action_spawn did before the spawn subsystem
+static pid_t spawn_fork(const char *command)
+{
+    pid_t pid = fork();
+    if (pid == 0) {
+        setsid();
+        execl("/bin/sh", "/bin/sh", "-c", command, NULL);
+        _exit(1);
+    }
+    return pid;
+}
+
+static pid_t spawn_posix(const char *command)
+{
+    return swl_process_spawn_shell(NULL, command);
+}
+
+// Close-on-exec pipe: the read end sees EOF once the child has exec'd
+static bool exec_pipe(int fds[2])
+{
+    if (pipe(fds) < 0)
+        return false;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return true;
+}
+
+static void run(const char *name, SpawnFunc spawn, int iterations)
+{
+    SwlLatencyStats blocked, exec;
+    swl_latency_reset(&blocked);
+    swl_latency_reset(&exec);
+
+    for (int i = 0; i < iterations; i++) {
+        int fds[2];
+        if (!exec_pipe(fds))
+            break;
+
+        int64_t start = now_ns();
+        pid_t pid = spawn(COMMAND);
+        int64_t returned = now_ns();
+        close(fds[1]);
+
+        char c;
+        while (read(fds[0], &c, 1) > 0)
+            ;
+        int64_t execd = now_ns();
+        close(fds[0]);
+
+        if (pid <= 0) {
+            fprintf(stderr, "bench_spawn: %s failed\n", name);
+            return;
+        }
+        waitpid(pid, NULL, 0);
+
+        swl_latency_add(&blocked, returned - start);
+        swl_latency_add(&exec, execd - start);
+    }
+
+    SwlLatencySummary b = swl_latency_summary(&blocked);
+    SwlLatencySummary e = swl_latency_summary(&exec);
+    printf("%-12s blocked p50 %8.1f us p99 %8.1f us   exec p50 %8.1f us p99 %8.1f us\n",
+           name, b.p50_ns / 1000.0, b.p99_ns / 1000.0,
+           e.p50_ns / 1000.0, e.p99_ns / 1000.0);
+}
+
+int main(int argc, char **argv)
+{
+    size_t resident_mb = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_RESIDENT_MB;
+    int iterations = argc > 2 ? atoi(argv[2]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0 || iterations > SWL_LATENCY_WINDOW)
+        iterations = DEFAULT_ITERATIONS;
+
+    // Small pages, so the page table is as large as for scattered real
+    // mappings rather than a few transparent huge pages
+    size_t size = resident_mb * 1024 * 1024;
+    char *heap = NULL;
+    if (size) {
+        heap = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (heap == MAP_FAILED) {
+            fprintf(stderr, "bench_spawn: cannot map %zu MB\n", resident_mb);
+            return 1;
+        }
+        madvise(heap, size, MADV_NOHUGEPAGE);
+        memset(heap, 1, size);
+    }
+
+    printf("%zu MB resident, %d iterations\n", resident_mb, iterations);
+    run("fork", spawn_fork, iterations);
+    run("posix_spawn", spawn_posix, iterations);
+
+    if (heap)
+        munmap(heap, size);
+    return 0;
+}
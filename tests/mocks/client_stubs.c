@@ -3,6 +3,7 @@
  */
 
 #include "client.h"
+#include "render.h"
 
 SwlClientInfo swl_client_get_info(const SwlClient *client)
 {
@@ -27,3 +28,15 @@ SwlError swl_client_set_floating(SwlClient *client, bool floating)
     (void)floating;
     return SWL_OK;
 }
+
+/* Last profile handed over by swl_rule_engine_apply, for assertions */
+int mock_render_profile_calls;
+SwlRenderProfile mock_render_profile;
+
+SwlError swl_client_set_render_profile(SwlClient *client, const struct SwlRenderProfile *profile)
+{
+    (void)client;
+    mock_render_profile_calls++;
+    mock_render_profile = *profile;
+    return SWL_OK;
+}
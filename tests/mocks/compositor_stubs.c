@@ -0,0 +1,49 @@
+/* Mock stubs for the compositor and input accessors used by keybindings.c
+ * Tests point the mock_* objects at whatever they want handed out
+ */
+
+#include "compositor.h"
+#include "input.h"
+#include "keybindings.h"
+
+SwlEventBus *mock_event_bus;
+struct SwlConfig *mock_config;
+struct SwlLayoutRegistry *mock_layouts;
+SwlKeybindingManager *mock_keybindings;
+
+SwlCompositor *swl_input_get_compositor(SwlInput *input)
+{
+    (void)input;
+    return NULL;
+}
+
+struct SwlKeybindingManager *swl_input_get_keybindings(SwlInput *input)
+{
+    (void)input;
+    return mock_keybindings;
+}
+
+SwlEventBus *swl_compositor_get_event_bus(SwlCompositor *comp)
+{
+    (void)comp;
+    return mock_event_bus;
+}
+
+struct SwlInput *swl_compositor_get_input(SwlCompositor *comp)
+{
+    (void)comp;
+    /* Never dereferenced, only checked and passed back to swl_input_get_keybindings() */
+    return (struct SwlInput *)&mock_keybindings;
+}
+
+struct SwlConfig *swl_compositor_get_config(SwlCompositor *comp)
+{
+    (void)comp;
+    return mock_config;
+}
+
+struct SwlLayoutRegistry *swl_compositor_get_layouts(SwlCompositor *comp)
+{
+    (void)comp;
+    return mock_layouts;
+}
@@ -0,0 +1,270 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "json.h"
+
+static void test_json_empty(void **state)
+{
+    (void)state;
+    SwlJsonWriter w;
+    swl_json_init(&w);
+
+    assert_string_equal(swl_json_cstr(&w), "");
+    swl_json_begin_array(&w);
+    swl_json_end_array(&w);
+    assert_string_equal(swl_json_cstr(&w), "[]");
+
+    swl_json_finish(&w);
+}
+
+static void test_json_object_commas(void **state)
+{
+    (void)state;
+    SwlJsonWriter w;
+    swl_json_init(&w);
+
+    swl_json_begin_object(&w);
+    swl_json_field_uint(&w, "id", 7);
+    swl_json_field_int(&w, "x", -3);
+    swl_json_field_bool(&w, "focused", true);
+    swl_json_key(&w, "tags");
+    swl_json_begin_array(&w);
+    swl_json_int(&w, 1);
+    swl_json_int(&w, 2);
+    swl_json_begin_object(&w);
+    swl_json_end_object(&w);
+    swl_json_end_array(&w);
+    swl_json_key(&w, "none");
+    swl_json_null(&w);
+    swl_json_field_double(&w, "scale", 1.5, 2);
+    swl_json_end_object(&w);
+
+    assert_string_equal(swl_json_cstr(&w),
+        "{\"id\":7,\"x\":-3,\"focused\":true,\"tags\":[1,2,{}],\"none\":null,\"scale\":1.50}");
+    swl_json_finish(&w);
+}
+
+static void test_json_escaping(void **state)
+{
+    (void)state;
+    SwlJsonWriter w;
+    swl_json_init(&w);
+
+    swl_json_string(&w, "a \"quoted\" \\path\\\n\t\x01 \xc3\xa9");
+    assert_string_equal(swl_json_cstr(&w),
+        "\"a \\\"quoted\\\" \\\\path\\\\\\n\\t\\u0001 \xc3\xa9\"");
+
+    swl_json_reset(&w);
+    swl_json_string(&w, NULL);
+    assert_string_equal(swl_json_cstr(&w), "\"\"");
+
+    swl_json_finish(&w);
+}
+
+static void test_json_non_finite(void **state)
+{
+    (void)state;
+    SwlJsonWriter w;
+    swl_json_init(&w);
+
+    swl_json_begin_array(&w);
+    swl_json_double(&w, NAN, 2);
+    swl_json_double(&w, INFINITY, 2);
+    swl_json_end_array(&w);
+    assert_string_equal(swl_json_cstr(&w), "[null,null]");
+
+    swl_json_finish(&w);
+}
+
+static void test_json_grows_and_reuses(void **state)
+{
+    (void)state;
+    SwlJsonWriter w;
+    swl_json_init(&w);
+
+    // Well past the 8 KB the fixed buffers used to have
+    char title[201];
+    memset(title, 'x', sizeof(title) - 1);
+    title[sizeof(title) - 1] = '\0';
+
+    swl_json_begin_array(&w);
+    for (int i = 0; i < 500; i++)
+        swl_json_string(&w, title);
+    swl_json_end_array(&w);
+
+    assert_false(w.failed);
+    assert_int_equal(w.len, 2 + 500 * 202 + 499);
+    assert_int_equal(strlen(swl_json_cstr(&w)), w.len);
+
+    char *buf = w.buf;
+    size_t cap = w.cap;
+    swl_json_reset(&w);
+    swl_json_begin_object(&w);
+    swl_json_end_object(&w);
+    assert_ptr_equal(w.buf, buf);
+    assert_int_equal(w.cap, cap);
+    assert_string_equal(swl_json_cstr(&w), "{}");
+
+    swl_json_finish(&w);
+}
+
+static void test_json_too_deep(void **state)
+{
+    (void)state;
+    SwlJsonWriter w;
+    swl_json_init(&w);
+
+    for (int i = 0; i < SWL_JSON_MAX_DEPTH + 1; i++)
+        swl_json_begin_array(&w);
+    assert_true(w.failed);
+
+    swl_json_reset(&w);
+    assert_false(w.failed);
+    swl_json_finish(&w);
+}
+
+static void test_json_raw_newline(void **state)
+{
+    (void)state;
+    SwlJsonWriter w;
+    swl_json_init(&w);
+
+    swl_json_begin_object(&w);
+    swl_json_field_string(&w, "event", "lid_open");
+    swl_json_end_object(&w);
+    swl_json_raw(&w, "\n", 1);
+    assert_string_equal(swl_json_cstr(&w), "{\"event\":\"lid_open\"}\n");
+
+    swl_json_finish(&w);
+}
+
+static void expect_bytes(const SwlJsonWriter *w, const char *hex)
+{
+    size_t n = strlen(hex) / 2;
+    assert_int_equal(swl_json_len(w), n);
+    for (size_t i = 0; i < n; i++) {
+        unsigned int byte;
+        sscanf(hex + i * 2, "%2x", &byte);
+        assert_int_equal((unsigned char)swl_json_cstr(w)[i], byte);
+    }
+}
+
+static void test_json_cbor_numbers(void **state)
+{
+    (void)state;
+    SwlJsonWriter w;
+    swl_json_init(&w);
+    swl_json_set_encoding(&w, SWL_JSON_CBOR);
+
+    // Vectors from RFC 8949 appendix A
+    static const struct { int64_t v; const char *hex; } ints[] = {
+        {0, "00"}, {23, "17"}, {24, "1818"}, {100, "1864"}, {1000, "1903e8"},
+        {1000000, "1a000f4240"}, {1000000000000, "1b000000e8d4a51000"},
+        {-1, "20"}, {-100, "3863"}, {-1000, "3903e7"},
+    };
+    for (size_t i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+        swl_json_reset(&w);
+        swl_json_int(&w, ints[i].v);
+        expect_bytes(&w, ints[i].hex);
+    }
+
+    swl_json_reset(&w);
+    swl_json_uint(&w, UINT64_MAX);
+    expect_bytes(&w, "1bffffffffffffffff");
+
+    swl_json_reset(&w);
+    swl_json_double(&w, 100000.0, 2);
+    expect_bytes(&w, "fa47c35000");
+
+    swl_json_reset(&w);
+    swl_json_double(&w, 1.1, 2);
+    expect_bytes(&w, "fb3ff199999999999a");
+
+    swl_json_reset(&w);
+    swl_json_double(&w, NAN, 2);
+    expect_bytes(&w, "f6");
+
+    swl_json_finish(&w);
+}
+
+static void test_json_cbor_containers(void **state)
+{
+    (void)state;
+    SwlJsonWriter w;
+    swl_json_init(&w);
+    swl_json_set_encoding(&w, SWL_JSON_CBOR);
+
+    swl_json_begin_object(&w);
+    swl_json_field_string(&w, "a", "b");
+    swl_json_key(&w, "c");
+    swl_json_begin_array(&w);
+    swl_json_bool(&w, true);
+    swl_json_bool(&w, false);
+    swl_json_null(&w);
+    swl_json_end_array(&w);
+    swl_json_end_object(&w);
+    expect_bytes(&w, "bf616161626163" "9ff5f4f6ff" "ff");
+
+    // Reset keeps the encoding
+    swl_json_reset(&w);
+    swl_json_string(&w, "");
+    expect_bytes(&w, "60");
+
+    swl_json_set_encoding(&w, SWL_JSON_TEXT);
+    swl_json_string(&w, "");
+    assert_string_equal(swl_json_cstr(&w), "\"\"");
+
+    swl_json_finish(&w);
+}
+
+// Stray bytes, an overlong '/', a surrogate and a cut-off sequence each turn
+// into U+FFFD per byte; the 4-byte emoji is kept
+#define INVALID_UTF8 "\xff" "a" "\xc0\xaf" "\xed\xa0\x80" "\xf0\x9f\x98\x80" "\xc3"
+#define FFFD "\xef\xbf\xbd"
+
+static void test_json_invalid_utf8(void **state)
+{
+    (void)state;
+    SwlJsonWriter w;
+    swl_json_init(&w);
+
+    swl_json_string(&w, INVALID_UTF8);
+    assert_string_equal(swl_json_cstr(&w),
+        "\"" FFFD "a" FFFD FFFD FFFD FFFD FFFD "\xf0\x9f\x98\x80" FFFD "\"");
+
+    swl_json_reset(&w);
+    swl_json_set_encoding(&w, SWL_JSON_CBOR);
+    swl_json_string(&w, INVALID_UTF8);
+    expect_bytes(&w, "781a" "efbfbd" "61" "efbfbdefbfbd" "efbfbdefbfbdefbfbd"
+                     "f09f9880" "efbfbd");
+
+    swl_json_reset(&w);
+    swl_json_string(&w, "\xc3\xa9");
+    expect_bytes(&w, "62c3a9");
+
+    swl_json_finish(&w);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_json_empty),
+        cmocka_unit_test(test_json_object_commas),
+        cmocka_unit_test(test_json_escaping),
+        cmocka_unit_test(test_json_non_finite),
+        cmocka_unit_test(test_json_grows_and_reuses),
+        cmocka_unit_test(test_json_too_deep),
+        cmocka_unit_test(test_json_raw_newline),
+        cmocka_unit_test(test_json_cbor_numbers),
+        cmocka_unit_test(test_json_cbor_containers),
+        cmocka_unit_test(test_json_invalid_utf8),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,423 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "events.h"
+#include "keybindings.h"
+#include "layout.h"
+
+/* Provided by tests/mocks/compositor_stubs.c */
+extern SwlEventBus *mock_event_bus;
+extern struct SwlConfig *mock_config;
+extern struct SwlLayoutRegistry *mock_layouts;
+extern SwlKeybindingManager *mock_keybindings;
+
+#define MOD_SHIFT (1u << 0)
+#define MOD_ALT (1u << 3)
+
+/* What the last "record" action was called with */
+static int record_calls;
+static char record_arg[64];
+
+static void action_record(SwlCompositor *comp, const SwlActionArg *arg)
+{
+    (void)comp;
+    record_calls++;
+    snprintf(record_arg, sizeof(record_arg), "%s", arg->str ? arg->str : "");
+}
+
+static int mode_events;
+static char mode_name[32];
+
+static void on_mode_change(void *ctx, const SwlEvent *event)
+{
+    (void)ctx;
+    mode_events++;
+    snprintf(mode_name, sizeof(mode_name), "%s", (const char *)event->data);
+}
+
+static SwlKeybindingManager *create_manager(void)
+{
+    record_calls = 0;
+    record_arg[0] = '\0';
+    mode_events = 0;
+    mode_name[0] = '\0';
+
+    mock_event_bus = swl_event_bus_create();
+    swl_event_bus_subscribe(mock_event_bus, SWL_EVENT_MODE_CHANGE, on_mode_change, NULL);
+
+    SwlKeybindingManager *mgr = swl_keybinding_create(NULL);
+    assert_non_null(mgr);
+    mock_keybindings = mgr;
+    assert_int_equal(swl_action_register(mgr, "record", action_record, NULL), SWL_OK);
+    return mgr;
+}
+
+static void destroy_manager(SwlKeybindingManager *mgr)
+{
+    swl_keybinding_destroy(mgr);
+    swl_event_bus_destroy(mock_event_bus);
+    mock_event_bus = NULL;
+    mock_keybindings = NULL;
+}
+
+static void add_key(SwlKeybindingManager *mgr, uint32_t mods, xkb_keysym_t sym,
+                    const char *action, const char *arg, const char *mode)
+{
+    SwlKeybinding binding = {
+        .modifiers = mods,
+        .keysym = sym,
+        .action = action,
+        .argument = arg,
+        .mode = mode,
+    };
+    assert_int_equal(swl_keybinding_add(mgr, &binding), SWL_OK);
+}
+
+/* Dispatch table */
+static void test_lookup_many_bindings(void **state)
+{
+    (void)state;
+
+    SwlKeybindingManager *mgr = create_manager();
+
+    /* Enough bindings that the open-addressed table has to probe */
+    char arg[16];
+    for (int i = 0; i < 400; i++) {
+        snprintf(arg, sizeof(arg), "%d", i);
+        add_key(mgr, (uint32_t)(i % 4), 0x1000u + (uint32_t)i, "record", arg, NULL);
+    }
+    assert_int_equal(swl_keybinding_count(mgr), 400);
+
+    for (int i = 0; i < 400; i++) {
+        assert_true(swl_keybinding_handle(mgr, (uint32_t)(i % 4), 0x1000u + (uint32_t)i));
+        snprintf(arg, sizeof(arg), "%d", i);
+        assert_string_equal(record_arg, arg);
+    }
+    assert_int_equal(record_calls, 400);
+
+    /* Same keysym, other modifiers */
+    assert_false(swl_keybinding_handle(mgr, 3, 0x1000u));
+    assert_false(swl_keybinding_handle(mgr, 0, 0x2000u));
+    assert_int_equal(record_calls, 400);
+
+    destroy_manager(mgr);
+}
+
+static void test_first_binding_wins(void **state)
+{
+    (void)state;
+
+    SwlKeybindingManager *mgr = create_manager();
+    add_key(mgr, MOD_ALT, XKB_KEY_a, "record", "first", NULL);
+    add_key(mgr, MOD_ALT, XKB_KEY_a, "record", "second", NULL);
+
+    assert_true(swl_keybinding_handle(mgr, MOD_ALT, XKB_KEY_a));
+    assert_string_equal(record_arg, "first");
+
+    destroy_manager(mgr);
+}
+
+static void test_keysym_case_folded(void **state)
+{
+    (void)state;
+
+    SwlKeybindingManager *mgr = create_manager();
+    add_key(mgr, MOD_ALT | MOD_SHIFT, XKB_KEY_q, "record", "quit", NULL);
+
+    /* Shift+q arrives as Q */
+    assert_true(swl_keybinding_handle(mgr, MOD_ALT | MOD_SHIFT, XKB_KEY_Q));
+    assert_string_equal(record_arg, "quit");
+
+    destroy_manager(mgr);
+}
+
+static void test_remove_recompiles(void **state)
+{
+    (void)state;
+
+    SwlKeybindingManager *mgr = create_manager();
+    add_key(mgr, MOD_ALT, XKB_KEY_a, "record", "a", NULL);
+    add_key(mgr, MOD_ALT, XKB_KEY_b, "record", "b", NULL);
+    assert_true(swl_keybinding_handle(mgr, MOD_ALT, XKB_KEY_a));
+
+    assert_int_equal(swl_keybinding_remove(mgr, MOD_ALT, XKB_KEY_a), SWL_OK);
+    assert_false(swl_keybinding_handle(mgr, MOD_ALT, XKB_KEY_a));
+    assert_true(swl_keybinding_handle(mgr, MOD_ALT, XKB_KEY_b));
+    assert_string_equal(record_arg, "b");
+
+    assert_int_equal(swl_keybinding_remove(mgr, MOD_ALT, XKB_KEY_a), SWL_ERR_NOT_FOUND);
+
+    destroy_manager(mgr);
+}
+
+static void test_button_bindings(void **state)
+{
+    (void)state;
+
+    SwlKeybindingManager *mgr = create_manager();
+    SwlButtonBinding binding = { MOD_ALT, 0x110, "record", "left" };
+    assert_int_equal(swl_button_binding_add(mgr, &binding), SWL_OK);
+
+    assert_true(swl_button_binding_handle(mgr, MOD_ALT, 0x110));
+    assert_string_equal(record_arg, "left");
+    assert_false(swl_button_binding_handle(mgr, 0, 0x110));
+    assert_false(swl_button_binding_handle(mgr, MOD_ALT, 0x111));
+
+    destroy_manager(mgr);
+}
+
+static void test_invalid_argument_rejected(void **state)
+{
+    (void)state;
+
+    SwlKeybindingManager *mgr = create_manager();
+    assert_int_equal(swl_action_register(mgr, "focusdir", action_record,
+                                         swl_action_parse_direction), SWL_OK);
+
+    SwlKeybinding binding = { MOD_ALT, XKB_KEY_a, "focusdir", "sideways", NULL };
+    assert_int_equal(swl_keybinding_add(mgr, &binding), SWL_ERR_INVALID_ARG);
+    assert_int_equal(swl_action_dispatch(mgr, "focusdir", "sideways"), SWL_ERR_INVALID_ARG);
+    assert_int_equal(swl_action_dispatch(mgr, "nope", NULL), SWL_ERR_NOT_FOUND);
+
+    assert_int_equal(swl_action_dispatch(mgr, "focusdir", "left"), SWL_OK);
+    assert_int_equal(record_calls, 1);
+
+    destroy_manager(mgr);
+}
+
+static void test_late_action_invalid_argument_dropped(void **state)
+{
+    (void)state;
+
+    SwlKeybindingManager *mgr = create_manager();
+
+    /* Not registered yet, so the argument can't be checked until compiled */
+    add_key(mgr, MOD_ALT, XKB_KEY_a, "chvt", "13", NULL);
+    add_key(mgr, MOD_ALT, XKB_KEY_b, "chvt", "2", NULL);
+    assert_int_equal(swl_action_register(mgr, "chvt", action_record, swl_action_parse_vt),
+                     SWL_OK);
+
+    assert_false(swl_keybinding_handle(mgr, MOD_ALT, XKB_KEY_a));
+    assert_true(swl_keybinding_handle(mgr, MOD_ALT, XKB_KEY_b));
+    assert_string_equal(record_arg, "2");
+
+    destroy_manager(mgr);
+}
+
+/* Argument parsers */
+static void test_parse_direction(void **state)
+{
+    (void)state;
+
+    SwlActionArg arg = {0};
+    assert_int_equal(swl_action_parse_direction(NULL, "up", &arg), SWL_OK);
+    assert_int_equal(arg.i, 0);
+    assert_int_equal(swl_action_parse_direction(NULL, "right", &arg), SWL_OK);
+    assert_int_equal(arg.i, 3);
+    assert_int_equal(swl_action_parse_direction(NULL, "2", &arg), SWL_OK);
+    assert_int_equal(arg.i, 2);
+
+    assert_int_equal(swl_action_parse_direction(NULL, "4", &arg), SWL_ERR_INVALID_ARG);
+    assert_int_equal(swl_action_parse_direction(NULL, "2x", &arg), SWL_ERR_INVALID_ARG);
+    assert_int_equal(swl_action_parse_direction(NULL, NULL, &arg), SWL_ERR_INVALID_ARG);
+
+    assert_int_equal(swl_action_parse_monitor_direction(NULL, "-1", &arg), SWL_OK);
+    assert_int_equal(arg.i, 2);
+    assert_int_equal(swl_action_parse_monitor_direction(NULL, "1", &arg), SWL_OK);
+    assert_int_equal(arg.i, 3);
+    assert_int_equal(swl_action_parse_monitor_direction(NULL, "up", &arg), SWL_OK);
+    assert_int_equal(arg.i, 0);
+}
+
+static void test_parse_integers(void **state)
+{
+    (void)state;
+
+    SwlActionArg arg = {0};
+    assert_int_equal(swl_action_parse_vt(NULL, "1", &arg), SWL_OK);
+    assert_int_equal(arg.i, 1);
+    assert_int_equal(swl_action_parse_vt(NULL, "12", &arg), SWL_OK);
+    assert_int_equal(arg.i, 12);
+    assert_int_equal(swl_action_parse_vt(NULL, "0", &arg), SWL_ERR_INVALID_ARG);
+    assert_int_equal(swl_action_parse_vt(NULL, "13", &arg), SWL_ERR_INVALID_ARG);
+    assert_int_equal(swl_action_parse_vt(NULL, NULL, &arg), SWL_ERR_INVALID_ARG);
+
+    assert_int_equal(swl_action_parse_int_default_one(NULL, NULL, &arg), SWL_OK);
+    assert_int_equal(arg.i, 1);
+    assert_int_equal(swl_action_parse_int_default_one(NULL, "-3", &arg), SWL_OK);
+    assert_int_equal(arg.i, -3);
+    assert_int_equal(swl_action_parse_int_default_one(NULL, "x", &arg), SWL_ERR_INVALID_ARG);
+}
+
+static void test_parse_words(void **state)
+{
+    (void)state;
+
+    SwlActionArg arg = {0};
+    assert_int_equal(swl_action_parse_required(NULL, "foot", &arg), SWL_OK);
+    assert_int_equal(swl_action_parse_required(NULL, "", &arg), SWL_ERR_INVALID_ARG);
+    assert_int_equal(swl_action_parse_required(NULL, NULL, &arg), SWL_ERR_INVALID_ARG);
+
+    assert_int_equal(swl_action_parse_moveresize(NULL, "move", &arg), SWL_OK);
+    assert_int_equal(arg.i, SWL_MOVERESIZE_MOVE);
+    assert_int_equal(swl_action_parse_moveresize(NULL, "resize", &arg), SWL_OK);
+    assert_int_equal(arg.i, SWL_MOVERESIZE_RESIZE);
+    assert_int_equal(swl_action_parse_moveresize(NULL, "drag", &arg), SWL_ERR_INVALID_ARG);
+}
+
+static void test_parse_ratios(void **state)
+{
+    (void)state;
+
+    SwlActionArg arg = {0};
+    assert_int_equal(swl_action_parse_ratios(NULL, "0.5, 2.0,0.75", &arg), SWL_OK);
+    assert_int_equal(arg.float_count, 2);
+    assert_float_equal(arg.floats[0], 0.5f, 0.001f);
+    assert_float_equal(arg.floats[1], 0.75f, 0.001f);
+
+    memset(&arg, 0, sizeof(arg));
+    assert_int_equal(swl_action_parse_ratios(NULL, "0,2", &arg), SWL_ERR_INVALID_ARG);
+
+    /* No argument falls back to appearance.scroller_ratios */
+    mock_config = swl_config_create();
+    assert_non_null(mock_config);
+    swl_config_set_string(mock_config, "appearance.scroller_ratios", "0.3,0.7");
+    memset(&arg, 0, sizeof(arg));
+    assert_int_equal(swl_action_parse_ratios(NULL, NULL, &arg), SWL_OK);
+    assert_int_equal(arg.float_count, 2);
+    assert_float_equal(arg.floats[0], 0.3f, 0.001f);
+    swl_config_destroy(mock_config);
+    mock_config = NULL;
+}
+
+static void test_parse_layout(void **state)
+{
+    (void)state;
+
+    mock_layouts = swl_layout_registry_create();
+    assert_non_null(mock_layouts);
+    swl_layout_register_builtins(mock_layouts);
+
+    SwlActionArg arg = {0};
+    assert_int_equal(swl_action_parse_layout(NULL, "scroller", &arg), SWL_OK);
+    assert_ptr_equal(arg.layout, swl_layout_get(mock_layouts, "scroller"));
+    assert_int_equal(swl_action_parse_layout(NULL, "spiral", &arg), SWL_ERR_NOT_FOUND);
+    assert_int_equal(swl_action_parse_layout(NULL, NULL, &arg), SWL_ERR_INVALID_ARG);
+
+    swl_layout_registry_destroy(mock_layouts);
+    mock_layouts = NULL;
+}
+
+/* Modes */
+static void test_mode_switching(void **state)
+{
+    (void)state;
+
+    SwlKeybindingManager *mgr = create_manager();
+    add_key(mgr, MOD_ALT, XKB_KEY_r, "mode", "resize", NULL);
+    add_key(mgr, 0, XKB_KEY_h, "record", "shrink", "resize");
+    add_key(mgr, 0, XKB_KEY_Return, "mode", "default", "resize");
+
+    assert_string_equal(swl_keybinding_get_mode(mgr), "default");
+    assert_false(swl_keybinding_handle(mgr, 0, XKB_KEY_h));
+
+    assert_true(swl_keybinding_handle(mgr, MOD_ALT, XKB_KEY_r));
+    assert_string_equal(swl_keybinding_get_mode(mgr), "resize");
+    assert_int_equal(mode_events, 1);
+    assert_string_equal(mode_name, "resize");
+
+    /* Only the mode's own bindings apply */
+    assert_true(swl_keybinding_handle(mgr, 0, XKB_KEY_h));
+    assert_string_equal(record_arg, "shrink");
+    assert_false(swl_keybinding_handle(mgr, MOD_ALT, XKB_KEY_r));
+
+    assert_true(swl_keybinding_handle(mgr, 0, XKB_KEY_Return));
+    assert_string_equal(swl_keybinding_get_mode(mgr), "default");
+    assert_int_equal(mode_events, 2);
+    assert_string_equal(mode_name, "default");
+
+    assert_int_equal(swl_keybinding_set_mode(mgr, "missing"), SWL_ERR_NOT_FOUND);
+
+    destroy_manager(mgr);
+}
+
+static void test_escape_leaves_mode(void **state)
+{
+    (void)state;
+
+    SwlKeybindingManager *mgr = create_manager();
+    add_key(mgr, 0, XKB_KEY_h, "record", "shrink", "resize");
+
+    assert_int_equal(swl_keybinding_set_mode(mgr, "resize"), SWL_OK);
+    assert_true(swl_keybinding_handle(mgr, 0, XKB_KEY_Escape));
+    assert_string_equal(swl_keybinding_get_mode(mgr), "default");
+    assert_int_equal(mode_events, 2);
+
+    /* Escape isn't taken in the default mode */
+    assert_false(swl_keybinding_handle(mgr, 0, XKB_KEY_Escape));
+
+    destroy_manager(mgr);
+}
+
+static void test_mode_kept_across_reload(void **state)
+{
+    (void)state;
+
+    SwlKeybindingManager *mgr = create_manager();
+    add_key(mgr, 0, XKB_KEY_h, "record", "shrink", "resize");
+    assert_int_equal(swl_keybinding_set_mode(mgr, "resize"), SWL_OK);
+    assert_int_equal(mode_events, 1);
+
+    /* What swl_keybinding_reload() does, with the mode still configured */
+    swl_keybinding_clear(mgr);
+    add_key(mgr, 0, XKB_KEY_l, "record", "grow", "resize");
+    swl_keybinding_compile(mgr);
+
+    assert_string_equal(swl_keybinding_get_mode(mgr), "resize");
+    assert_int_equal(mode_events, 1);
+    assert_true(swl_keybinding_handle(mgr, 0, XKB_KEY_l));
+    assert_string_equal(record_arg, "grow");
+
+    /* And with the mode gone */
+    swl_keybinding_clear(mgr);
+    add_key(mgr, 0, XKB_KEY_l, "record", "grow", NULL);
+    swl_keybinding_compile(mgr);
+
+    assert_string_equal(swl_keybinding_get_mode(mgr), "default");
+    assert_int_equal(mode_events, 2);
+    assert_string_equal(mode_name, "default");
+
+    destroy_manager(mgr);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_lookup_many_bindings),
+        cmocka_unit_test(test_first_binding_wins),
+        cmocka_unit_test(test_keysym_case_folded),
+        cmocka_unit_test(test_remove_recompiles),
+        cmocka_unit_test(test_button_bindings),
+        cmocka_unit_test(test_invalid_argument_rejected),
+        cmocka_unit_test(test_late_action_invalid_argument_dropped),
+        cmocka_unit_test(test_parse_direction),
+        cmocka_unit_test(test_parse_integers),
+        cmocka_unit_test(test_parse_words),
+        cmocka_unit_test(test_parse_ratios),
+        cmocka_unit_test(test_parse_layout),
+        cmocka_unit_test(test_mode_switching),
+        cmocka_unit_test(test_escape_leaves_mode),
+        cmocka_unit_test(test_mode_kept_across_reload),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,104 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "latency.h"
+
+static void test_latency_empty(void **state)
+{
+    (void)state;
+    SwlLatencyStats stats;
+    swl_latency_reset(&stats);
+
+    SwlLatencySummary sum = swl_latency_summary(&stats);
+    assert_int_equal(sum.samples, 0);
+    assert_int_equal(sum.p50_ns, 0);
+    assert_int_equal(sum.p99_ns, 0);
+}
+
+static void test_latency_percentiles(void **state)
+{
+    (void)state;
+    SwlLatencyStats stats;
+    swl_latency_reset(&stats);
+
+    // 1..100 ms, added out of order
+    for (int i = 100; i >= 1; i--)
+        swl_latency_add(&stats, (int64_t)i * 1000000);
+
+    SwlLatencySummary sum = swl_latency_summary(&stats);
+    assert_int_equal(sum.samples, 100);
+    assert_int_equal(sum.p50_ns, 50 * 1000000);
+    assert_int_equal(sum.p95_ns, 95 * 1000000);
+    assert_int_equal(sum.p99_ns, 99 * 1000000);
+}
+
+static void test_latency_single_sample(void **state)
+{
+    (void)state;
+    SwlLatencyStats stats;
+    swl_latency_reset(&stats);
+    swl_latency_add(&stats, 7);
+    swl_latency_add(&stats, -1);  // Ignored
+
+    SwlLatencySummary sum = swl_latency_summary(&stats);
+    assert_int_equal(sum.samples, 1);
+    assert_int_equal(sum.p50_ns, 7);
+    assert_int_equal(sum.p99_ns, 7);
+}
+
+static void test_latency_window_wraps(void **state)
+{
+    (void)state;
+    SwlLatencyStats stats;
+    swl_latency_reset(&stats);
+
+    // Old slow samples are pushed out by a full window of fast ones
+    for (int i = 0; i < SWL_LATENCY_WINDOW; i++)
+        swl_latency_add(&stats, 1000);
+    for (int i = 0; i < SWL_LATENCY_WINDOW; i++)
+        swl_latency_add(&stats, 10);
+
+    SwlLatencySummary sum = swl_latency_summary(&stats);
+    assert_int_equal(sum.samples, SWL_LATENCY_WINDOW);
+    assert_int_equal(sum.total, 2 * SWL_LATENCY_WINDOW);
+    assert_int_equal(sum.p99_ns, 10);
+}
+
+static void test_latency_event_ns(void **state)
+{
+    (void)state;
+    int64_t now = 5000LL * 1000000 + 400000;  // 5000.4 ms
+
+    assert_int_equal(swl_latency_event_ns(4990, now), now - 10 * 1000000);
+    assert_int_equal(swl_latency_event_ns(5000, now), now);
+
+    // From the future or far in the past: no usable timestamp
+    assert_int_equal(swl_latency_event_ns(6000, now), now);
+    assert_int_equal(swl_latency_event_ns(1000, now), now);
+}
+
+static void test_latency_event_ns_wrap(void **state)
+{
+    (void)state;
+    // Millisecond counter wrapped between the event and now
+    int64_t now = ((int64_t)UINT32_MAX + 1 + 5) * 1000000;
+
+    assert_int_equal(swl_latency_event_ns(UINT32_MAX - 4, now), now - 10 * 1000000);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_latency_empty),
+        cmocka_unit_test(test_latency_percentiles),
+        cmocka_unit_test(test_latency_single_sample),
+        cmocka_unit_test(test_latency_window_wraps),
+        cmocka_unit_test(test_latency_event_ns),
+        cmocka_unit_test(test_latency_event_ns_wrap),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,137 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "motion.h"
+
+static void test_motion_coalesce(void **state)
+{
+    (void)state;
+    SwlMotionState m;
+    swl_motion_init(&m, 0);
+
+    uint32_t time = 0;
+    assert_false(swl_motion_take(&m, &time));
+
+    assert_true(swl_motion_push(&m, 10));
+    assert_false(swl_motion_push(&m, 11));
+    assert_false(swl_motion_push(&m, 12));
+    assert_int_equal(m.coalesced, 2);
+
+    assert_true(swl_motion_take(&m, &time));
+    assert_int_equal(time, 12);
+    assert_false(swl_motion_take(&m, &time));
+
+    assert_true(swl_motion_push(&m, 13));
+}
+
+static void test_motion_idle_rate_limit(void **state)
+{
+    (void)state;
+    SwlMotionState m;
+    swl_motion_init(&m, 100);
+
+    assert_true(swl_motion_should_notify_idle(&m, 1000));
+    assert_false(swl_motion_should_notify_idle(&m, 1050));
+    assert_false(swl_motion_should_notify_idle(&m, 1099));
+    assert_true(swl_motion_should_notify_idle(&m, 1100));
+    assert_true(swl_motion_should_notify_idle(&m, 5000));
+}
+
+static void test_motion_box_contains(void **state)
+{
+    (void)state;
+    SwlMotionBox box = { 10, 20, 100, 50 };
+
+    assert_true(swl_motion_box_contains(&box, 10, 20));
+    assert_true(swl_motion_box_contains(&box, 109.5, 69.5));
+    assert_false(swl_motion_box_contains(&box, 110, 40));
+    assert_false(swl_motion_box_contains(&box, 50, 70));
+    assert_false(swl_motion_box_contains(&box, 9.9, 40));
+
+    SwlMotionBox empty = { 0, 0, 0, 10 };
+    assert_false(swl_motion_box_contains(&empty, 0, 0));
+    assert_false(swl_motion_box_contains(NULL, 0, 0));
+}
+
+static void test_motion_box_exclude_no_overlap(void **state)
+{
+    (void)state;
+    SwlMotionBox box = { 0, 0, 100, 100 };
+    SwlMotionBox above = { 200, 0, 50, 50 };
+
+    assert_true(swl_motion_box_exclude(&box, &above, 10, 10));
+    assert_int_equal(box.x, 0);
+    assert_int_equal(box.width, 100);
+    assert_int_equal(box.height, 100);
+}
+
+static void test_motion_box_exclude_keeps_point(void **state)
+{
+    (void)state;
+    // Popup in the middle of a window, pointer left of it
+    SwlMotionBox box = { 0, 0, 100, 100 };
+    SwlMotionBox above = { 40, 40, 20, 20 };
+
+    assert_true(swl_motion_box_exclude(&box, &above, 10, 50));
+    assert_true(swl_motion_box_contains(&box, 10, 50));
+    assert_false(swl_motion_box_contains(&box, 45, 45));
+    assert_int_equal(box.x, 0);
+    assert_int_equal(box.width, 40);
+    assert_int_equal(box.height, 100);
+
+    // Pointer below it, bottom strip is the only one containing it
+    box = (SwlMotionBox){ 0, 0, 100, 100 };
+    assert_true(swl_motion_box_exclude(&box, &above, 50, 80));
+    assert_int_equal(box.y, 60);
+    assert_int_equal(box.height, 40);
+    assert_int_equal(box.width, 100);
+}
+
+static void test_motion_box_exclude_covered(void **state)
+{
+    (void)state;
+    SwlMotionBox box = { 0, 0, 100, 100 };
+    SwlMotionBox above = { 40, 40, 20, 20 };
+
+    assert_false(swl_motion_box_exclude(&box, &above, 50, 50));
+    assert_false(swl_motion_box_contains(&box, 50, 50));
+}
+
+static void test_motion_hit_cache(void **state)
+{
+    (void)state;
+    SwlMotionState m;
+    swl_motion_init(&m, 0);
+
+    assert_false(swl_motion_hit_cached(&m, 5, 5));
+
+    SwlMotionBox box = { 0, 0, 10, 10 };
+    swl_motion_set_hit(&m, &box);
+    assert_true(swl_motion_hit_cached(&m, 5, 5));
+    assert_false(swl_motion_hit_cached(&m, 15, 5));
+
+    swl_motion_invalidate(&m);
+    assert_false(swl_motion_hit_cached(&m, 5, 5));
+
+    SwlMotionBox empty = { 0, 0, 0, 0 };
+    swl_motion_set_hit(&m, &empty);
+    assert_false(swl_motion_hit_cached(&m, 0, 0));
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_motion_coalesce),
+        cmocka_unit_test(test_motion_idle_rate_limit),
+        cmocka_unit_test(test_motion_box_contains),
+        cmocka_unit_test(test_motion_box_exclude_no_overlap),
+        cmocka_unit_test(test_motion_box_exclude_keeps_point),
+        cmocka_unit_test(test_motion_box_exclude_covered),
+        cmocka_unit_test(test_motion_hit_cache),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,335 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "outqueue.h"
+
+// Non-blocking socketpair with a small send buffer so writes back up quickly
+static void make_pair(int fds[2])
+{
+    assert_int_equal(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    int sndbuf = 4096;
+    setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+}
+
+static size_t drain(int fd, char *buf, size_t cap)
+{
+    size_t total = 0;
+    ssize_t n;
+    while (total < cap && (n = read(fd, buf + total, cap - total)) > 0)
+        total += (size_t)n;
+    return total;
+}
+
+static void push_keyed(SwlOutQueue *q, uint32_t type, uint64_t key, const char *s, bool expect)
+{
+    SwlOutMsg *msg = swl_outmsg_create(type, s, strlen(s));
+    assert_non_null(msg);
+    msg->key = key;
+    assert_int_equal(swl_outqueue_push(q, msg), expect);
+    swl_outmsg_unref(msg);
+}
+
+static void push_str(SwlOutQueue *q, uint32_t type, const char *s, bool expect)
+{
+    push_keyed(q, type, 0, s, expect);
+}
+
+static void test_outqueue_flush_in_order(void **state)
+{
+    (void)state;
+    int fds[2];
+    make_pair(fds);
+
+    SwlOutQueue q;
+    swl_outqueue_init(&q, 1 << 20, SWL_OVERFLOW_DROP_OLDEST);
+    push_str(&q, 0, "{\"a\":1}\n", true);
+    push_str(&q, 1, "{\"b\":2}\n", true);
+    assert_int_equal(q.bytes, 16);
+
+    assert_int_equal(swl_outqueue_flush(&q, fds[0]), 1);
+    assert_true(swl_outqueue_empty(&q));
+    assert_int_equal(q.bytes, 0);
+
+    char buf[64] = {0};
+    assert_int_equal(drain(fds[1], buf, sizeof(buf) - 1), 16);
+    assert_string_equal(buf, "{\"a\":1}\n{\"b\":2}\n");
+
+    swl_outqueue_finish(&q);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+static void test_outqueue_partial_write_keeps_framing(void **state)
+{
+    (void)state;
+    int fds[2];
+    make_pair(fds);
+
+    // Big enough that the socket can't take it in one go
+    static char line[64 * 1024];
+    memset(line, 'x', sizeof(line) - 2);
+    line[sizeof(line) - 2] = '\n';
+    line[sizeof(line) - 1] = '\0';
+
+    SwlOutQueue q;
+    swl_outqueue_init(&q, 1 << 20, SWL_OVERFLOW_DROP_OLDEST);
+    push_str(&q, 0, line, true);
+    push_str(&q, 1, "tail\n", true);
+
+    size_t expected = strlen(line) + 5;
+    static char out[80 * 1024];
+    size_t got = 0;
+
+    int ret;
+    while ((ret = swl_outqueue_flush(&q, fds[0])) == 0) {
+        assert_true(q.offset > 0 || q.count == 1);
+        got += drain(fds[1], out + got, sizeof(out) - got);
+    }
+    assert_int_equal(ret, 1);
+    got += drain(fds[1], out + got, sizeof(out) - got);
+
+    assert_int_equal(got, expected);
+    assert_memory_equal(out, line, strlen(line));
+    assert_memory_equal(out + strlen(line), "tail\n", 5);
+
+    swl_outqueue_finish(&q);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+static void test_outqueue_drop_oldest_gap(void **state)
+{
+    (void)state;
+    SwlOutQueue q;
+    swl_outqueue_init(&q, 20, SWL_OVERFLOW_DROP_OLDEST);
+
+    push_str(&q, 0, "event-one\n", true);
+    push_str(&q, 0, "event-two\n", true);
+    push_str(&q, 0, "event-3\n", true);
+    push_str(&q, 0, "event-4\n", true);
+    assert_int_equal(q.dropped_total, 2);
+
+    int fds[2];
+    make_pair(fds);
+    assert_int_equal(swl_outqueue_flush(&q, fds[0]), 1);
+
+    char buf[256] = {0};
+    drain(fds[1], buf, sizeof(buf) - 1);
+
+    // A single marker in place of what was dropped, then the newest events
+    assert_string_equal(buf,
+        "{\"event\":\"gap\",\"data\":{\"dropped\":2}}\n"
+        "event-3\n"
+        "event-4\n");
+    assert_int_equal(q.dropped, 0);
+
+    swl_outqueue_finish(&q);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+static void test_outqueue_binary_gap(void **state)
+{
+    (void)state;
+    SwlOutQueue q;
+    swl_outqueue_init(&q, 12, SWL_OVERFLOW_DROP_OLDEST);
+    q.encoding = SWL_JSON_CBOR;
+
+    // Two length-prefixed frames standing in for events
+    static const char one[] = {0, 0, 0, 4, 'a', 'b', 'c', 'd'};
+    static const char two[] = {0, 0, 0, 4, 'e', 'f', 'g', 'h'};
+    SwlOutMsg *msg = swl_outmsg_create(1, one, sizeof(one));
+    assert_true(swl_outqueue_push(&q, msg));
+    swl_outmsg_unref(msg);
+    msg = swl_outmsg_create(1, two, sizeof(two));
+    assert_true(swl_outqueue_push(&q, msg));
+    swl_outmsg_unref(msg);
+    assert_int_equal(q.dropped_total, 1);
+
+    int fds[2];
+    make_pair(fds);
+    assert_int_equal(swl_outqueue_flush(&q, fds[0]), 1);
+
+    // The marker is a framed CBOR {"event":"gap","data":{"dropped":1}}
+    static const unsigned char expected[] = {
+        0, 0, 0, 28,
+        0xbf, 0x65, 'e', 'v', 'e', 'n', 't', 0x63, 'g', 'a', 'p',
+        0x64, 'd', 'a', 't', 'a',
+        0xbf, 0x67, 'd', 'r', 'o', 'p', 'p', 'e', 'd', 0x01, 0xff,
+        0xff,
+        0, 0, 0, 4, 'e', 'f', 'g', 'h',
+    };
+    char buf[64] = {0};
+    assert_int_equal(drain(fds[1], buf, sizeof(buf)), sizeof(expected));
+    assert_memory_equal(buf, expected, sizeof(expected));
+
+    swl_outqueue_finish(&q);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+static void test_outqueue_coalesce(void **state)
+{
+    (void)state;
+    SwlOutQueue q;
+    swl_outqueue_init(&q, 16, SWL_OVERFLOW_COALESCE);
+
+    push_str(&q, 1, "focus-a\n", true);
+    push_str(&q, 2, "title-a\n", true);
+    push_str(&q, 1, "focus-b\n", true);
+
+    int fds[2];
+    make_pair(fds);
+    assert_int_equal(swl_outqueue_flush(&q, fds[0]), 1);
+
+    char buf[64] = {0};
+    drain(fds[1], buf, sizeof(buf) - 1);
+    assert_string_equal(buf, "title-a\nfocus-b\n");
+    assert_int_equal(q.dropped_total, 1);
+
+    swl_outqueue_finish(&q);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+static void test_outqueue_coalesce_per_object(void **state)
+{
+    (void)state;
+    SwlOutQueue q;
+    swl_outqueue_init(&q, 16, SWL_OVERFLOW_COALESCE);
+
+    // Resizes of two windows, then another one of the first
+    push_keyed(&q, 1, 10, "size-a1\n", true);
+    push_keyed(&q, 1, 20, "size-b1\n", true);
+    push_keyed(&q, 1, 10, "size-a2\n", true);
+
+    int fds[2];
+    make_pair(fds);
+    assert_int_equal(swl_outqueue_flush(&q, fds[0]), 1);
+
+    char buf[64] = {0};
+    drain(fds[1], buf, sizeof(buf) - 1);
+    assert_string_equal(buf, "size-b1\nsize-a2\n");
+
+    swl_outqueue_finish(&q);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+static void test_outqueue_keeps_replies(void **state)
+{
+    (void)state;
+    SwlOutQueue q;
+    swl_outqueue_init(&q, 20, SWL_OVERFLOW_DROP_OLDEST);
+
+    push_str(&q, SWL_OUTMSG_REPLY, "reply-1\n", true);
+    push_str(&q, 1, "event-1\n", true);
+    push_str(&q, SWL_OUTMSG_REPLY, "reply-2\n", true);
+    push_str(&q, 1, "event-2\n", true);
+    assert_int_equal(q.dropped_total, 1);
+
+    int fds[2];
+    make_pair(fds);
+    assert_int_equal(swl_outqueue_flush(&q, fds[0]), 1);
+
+    char buf[256] = {0};
+    drain(fds[1], buf, sizeof(buf) - 1);
+    assert_string_equal(buf,
+        "{\"event\":\"gap\",\"data\":{\"dropped\":1}}\n"
+        "reply-1\n"
+        "reply-2\n"
+        "event-2\n");
+
+    swl_outqueue_finish(&q);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+static void test_outqueue_coalesce_skips_replies(void **state)
+{
+    (void)state;
+    SwlOutQueue q;
+    swl_outqueue_init(&q, 16, SWL_OVERFLOW_COALESCE);
+
+    push_str(&q, SWL_OUTMSG_REPLY, "reply-1\n", true);
+    push_str(&q, SWL_OUTMSG_REPLY, "reply-2\n", true);
+    push_str(&q, SWL_OUTMSG_REPLY, "reply-3\n", true);
+    assert_int_equal(q.count, 3);
+    assert_int_equal(q.dropped_total, 0);
+
+    swl_outqueue_finish(&q);
+}
+
+static void test_outqueue_disconnect(void **state)
+{
+    (void)state;
+    SwlOutQueue q;
+    swl_outqueue_init(&q, 16, SWL_OVERFLOW_DISCONNECT);
+
+    push_str(&q, 0, "0123456789\n", true);
+    push_str(&q, 0, "0123456789\n", false);
+    assert_int_equal(q.count, 1);
+
+    swl_outqueue_finish(&q);
+}
+
+static void test_outqueue_shared_message(void **state)
+{
+    (void)state;
+    SwlOutQueue a, b;
+    swl_outqueue_init(&a, 1024, SWL_OVERFLOW_DROP_OLDEST);
+    swl_outqueue_init(&b, 1024, SWL_OVERFLOW_DROP_OLDEST);
+
+    SwlOutMsg *msg = swl_outmsg_create(0, "shared\n", 7);
+    assert_true(swl_outqueue_push(&a, msg));
+    assert_true(swl_outqueue_push(&b, msg));
+    assert_int_equal(msg->refs, 3);
+    swl_outmsg_unref(msg);
+
+    swl_outqueue_finish(&a);
+    assert_int_equal(msg->refs, 1);
+    swl_outqueue_finish(&b);
+}
+
+static void test_outqueue_policy_names(void **state)
+{
+    (void)state;
+    SwlOverflowPolicy p;
+
+    assert_true(swl_overflow_policy_from_string("coalesce", &p));
+    assert_int_equal(p, SWL_OVERFLOW_COALESCE);
+    assert_true(swl_overflow_policy_from_string("disconnect", &p));
+    assert_int_equal(p, SWL_OVERFLOW_DISCONNECT);
+    assert_true(swl_overflow_policy_from_string("drop_oldest", &p));
+    assert_int_equal(p, SWL_OVERFLOW_DROP_OLDEST);
+    assert_false(swl_overflow_policy_from_string("block", &p));
+    assert_false(swl_overflow_policy_from_string(NULL, &p));
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_outqueue_flush_in_order),
+        cmocka_unit_test(test_outqueue_partial_write_keeps_framing),
+        cmocka_unit_test(test_outqueue_drop_oldest_gap),
+        cmocka_unit_test(test_outqueue_binary_gap),
+        cmocka_unit_test(test_outqueue_coalesce),
+        cmocka_unit_test(test_outqueue_coalesce_per_object),
+        cmocka_unit_test(test_outqueue_keeps_replies),
+        cmocka_unit_test(test_outqueue_coalesce_skips_replies),
+        cmocka_unit_test(test_outqueue_disconnect),
+        cmocka_unit_test(test_outqueue_shared_message),
+        cmocka_unit_test(test_outqueue_policy_names),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,156 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/wait.h>
+
+#include "process.h"
+
+typedef struct {
+    int count;
+    SwlProcessExit last;
+    char command[SWL_PROCESS_CMD_MAX];
+} ExitRecord;
+
+static void record_exit(void *ctx, const SwlEvent *event)
+{
+    ExitRecord *rec = ctx;
+    const SwlProcessExit *info = event->data;
+    rec->count++;
+    rec->last = *info;
+    strcpy(rec->command, info->command);
+}
+
+// Block until pid has exited but leave it for swl_process_reap to collect
+static void wait_exited(pid_t pid)
+{
+    siginfo_t info;
+    waitid(P_PID, (id_t)pid, &info, WEXITED | WNOWAIT);
+}
+
+static void test_process_track(void **state)
+{
+    (void)state;
+    SwlProcessTable *table = swl_process_table_create(NULL);
+    assert_non_null(table);
+
+    assert_int_equal(swl_process_track(table, 100, "foot"), SWL_OK);
+    assert_int_equal(swl_process_track(table, 100, "foot"), SWL_ERR_ALREADY_EXISTS);
+    assert_int_equal(swl_process_track(table, 0, "bad"), SWL_ERR_INVALID_ARG);
+    assert_true(swl_process_is_tracked(table, 100));
+    assert_false(swl_process_is_tracked(table, 101));
+    assert_string_equal(swl_process_get_command(table, 100), "foot");
+    assert_int_equal(swl_process_count(table), 1);
+
+    swl_process_table_destroy(table);
+}
+
+static void test_process_table_full(void **state)
+{
+    (void)state;
+    SwlProcessTable *table = swl_process_table_create(NULL);
+
+    for (int i = 0; i < SWL_MAX_PROCESSES; i++)
+        assert_int_equal(swl_process_track(table, 1000 + i, "x"), SWL_OK);
+    assert_int_equal(swl_process_track(table, 5000, "x"), SWL_ERR_NOMEM);
+
+    swl_process_table_destroy(table);
+}
+
+static void test_process_reap_exit_code(void **state)
+{
+    (void)state;
+    SwlEventBus *bus = swl_event_bus_create();
+    SwlProcessTable *table = swl_process_table_create(bus);
+    ExitRecord rec = {0};
+    swl_event_bus_subscribe(bus, SWL_EVENT_PROCESS_EXIT, record_exit, &rec);
+
+    pid_t pid = swl_process_spawn_shell(table, "exit 3");
+    assert_true(pid > 0);
+    assert_true(swl_process_is_tracked(table, pid));
+
+    wait_exited(pid);
+    assert_int_equal(swl_process_reap(table), 1);
+
+    assert_int_equal(rec.count, 1);
+    assert_int_equal(rec.last.pid, pid);
+    assert_int_equal(rec.last.exit_code, 3);
+    assert_int_equal(rec.last.signal, 0);
+    assert_string_equal(rec.command, "exit 3");
+    assert_false(swl_process_is_tracked(table, pid));
+
+    swl_process_table_destroy(table);
+    swl_event_bus_destroy(bus);
+}
+
+static void test_process_reap_signal(void **state)
+{
+    (void)state;
+    SwlEventBus *bus = swl_event_bus_create();
+    SwlProcessTable *table = swl_process_table_create(bus);
+    ExitRecord rec = {0};
+    swl_event_bus_subscribe(bus, SWL_EVENT_PROCESS_EXIT, record_exit, &rec);
+
+    pid_t pid = swl_process_spawn_shell(table, "kill -TERM $$");
+    assert_true(pid > 0);
+
+    wait_exited(pid);
+    swl_process_reap(table);
+
+    assert_int_equal(rec.count, 1);
+    assert_int_equal(rec.last.exit_code, -1);
+    assert_int_equal(rec.last.signal, SIGTERM);
+
+    swl_process_table_destroy(table);
+    swl_event_bus_destroy(bus);
+}
+
+static void test_process_reap_untracked(void **state)
+{
+    (void)state;
+    SwlEventBus *bus = swl_event_bus_create();
+    SwlProcessTable *table = swl_process_table_create(bus);
+    ExitRecord rec = {0};
+    swl_event_bus_subscribe(bus, SWL_EVENT_PROCESS_EXIT, record_exit, &rec);
+
+    // Reaped so it doesn't linger as a zombie, but not reported
+    char *argv[] = { "true", NULL };
+    pid_t pid = swl_process_spawn(NULL, argv, false);
+    assert_true(pid > 0);
+
+    wait_exited(pid);
+    assert_int_equal(swl_process_reap(table), 1);
+    assert_int_equal(rec.count, 0);
+
+    swl_process_table_destroy(table);
+    swl_event_bus_destroy(bus);
+}
+
+static void test_process_spawn_invalid(void **state)
+{
+    (void)state;
+    assert_int_equal(swl_process_spawn_shell(NULL, ""), -1);
+    assert_int_equal(swl_process_spawn_shell(NULL, NULL), -1);
+    assert_int_equal(swl_process_spawn(NULL, NULL, false), -1);
+
+    char *argv[] = { "swl-test-no-such-program", NULL };
+    assert_int_equal(swl_process_spawn(NULL, argv, false), -1);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_process_track),
+        cmocka_unit_test(test_process_table_full),
+        cmocka_unit_test(test_process_reap_exit_code),
+        cmocka_unit_test(test_process_reap_signal),
+        cmocka_unit_test(test_process_reap_untracked),
+        cmocka_unit_test(test_process_spawn_invalid),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
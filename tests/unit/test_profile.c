@@ -0,0 +1,88 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <string.h>
+
+#include "profile.h"
+
+#define MS 1000000LL
+
+static void test_profile_phases(void **state)
+{
+    (void)state;
+    SwlStartupProfile p;
+    swl_profile_begin(&p, 1000 * MS);
+    swl_profile_mark(&p, "backend", 1010 * MS);
+    swl_profile_mark(&p, "renderer", 1035 * MS);
+
+    assert_int_equal(p.count, 2);
+    assert_string_equal(p.phases[0].name, "backend");
+    assert_int_equal(p.phases[0].start_ns, 0);
+    assert_int_equal(p.phases[0].duration_ns, 10 * MS);
+    assert_string_equal(p.phases[1].name, "renderer");
+    assert_int_equal(p.phases[1].start_ns, 10 * MS);
+    assert_int_equal(p.phases[1].duration_ns, 25 * MS);
+    assert_int_equal(swl_profile_total(&p), 35 * MS);
+}
+
+static void test_profile_first_frame_once(void **state)
+{
+    (void)state;
+    SwlStartupProfile p;
+    swl_profile_begin(&p, 500 * MS);
+
+    assert_int_equal(p.first_frame_ns, 0);
+    assert_true(swl_profile_first_frame(&p, 620 * MS));
+    assert_false(swl_profile_first_frame(&p, 700 * MS));
+    assert_int_equal(p.first_frame_ns, 120 * MS);
+}
+
+static void test_profile_full_keeps_timeline(void **state)
+{
+    (void)state;
+    SwlStartupProfile p;
+    swl_profile_begin(&p, 0);
+
+    for (int i = 1; i <= SWL_PROFILE_MAX_PHASES + 4; i++)
+        swl_profile_mark(&p, "phase", i * MS);
+
+    assert_int_equal(p.count, SWL_PROFILE_MAX_PHASES);
+    assert_int_equal(swl_profile_total(&p), (SWL_PROFILE_MAX_PHASES + 4) * MS);
+}
+
+static void test_profile_format(void **state)
+{
+    (void)state;
+    SwlStartupProfile p;
+    char buf[512];
+    swl_profile_begin(&p, 0);
+    swl_profile_mark(&p, "config", 2 * MS);
+
+    swl_profile_format(&p, buf, sizeof(buf));
+    assert_non_null(strstr(buf, "config"));
+    assert_non_null(strstr(buf, "2.00 ms"));
+    assert_non_null(strstr(buf, "pending"));
+
+    swl_profile_first_frame(&p, 16 * MS);
+    swl_profile_format(&p, buf, sizeof(buf));
+    assert_non_null(strstr(buf, "16.00 ms"));
+
+    // Truncates without overrunning
+    char small[8];
+    swl_profile_format(&p, small, sizeof(small));
+    assert_int_equal(strlen(small), sizeof(small) - 1);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_profile_phases),
+        cmocka_unit_test(test_profile_first_frame_once),
+        cmocka_unit_test(test_profile_full_keeps_timeline),
+        cmocka_unit_test(test_profile_format),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
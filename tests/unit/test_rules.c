@@ -11,6 +11,13 @@
 
 #include "rules.h"
 
+/* Provided by tests/mocks/client_stubs.c */
+extern int mock_render_profile_calls;
+extern SwlRenderProfile mock_render_profile;
+
+/* Opaque handle for apply(); the mocks never dereference it */
+static int fake_client;
+
 /* Tests */
 static void test_rule_engine_create(void **state)
 {
@@ -374,6 +381,67 @@ static void test_rule_remove_last(void **state)
     swl_rule_engine_destroy(engine);
 }
 
+static void test_rule_profile_stored(void **state)
+{
+    (void)state;
+
+    SwlRuleEngine *engine = swl_rule_engine_create();
+    assert_non_null(engine);
+
+    SwlRule rule = {
+        .app_id_pattern = "mpv",
+        .profile = {
+            .set = SWL_PROFILE_BLUR | SWL_PROFILE_OPACITY_INACTIVE,
+            .blur = false,
+            .opacity_inactive = 1.0f,
+        },
+    };
+
+    assert_int_equal(swl_rule_engine_add(engine, &rule), SWL_OK);
+
+    const SwlRule *got = swl_rule_engine_get(engine, 0);
+    assert_non_null(got);
+    assert_int_equal(got->profile.set, SWL_PROFILE_BLUR | SWL_PROFILE_OPACITY_INACTIVE);
+    assert_false(got->profile.blur);
+    assert_true(got->profile.opacity_inactive == 1.0f);
+
+    swl_rule_engine_destroy(engine);
+}
+
+static void test_rule_apply_profile(void **state)
+{
+    (void)state;
+
+    SwlRuleEngine *engine = swl_rule_engine_create();
+    assert_non_null(engine);
+
+    /* No patterns: matches every client */
+    SwlRule rule = {
+        .profile = {
+            .set = SWL_PROFILE_SUSPEND,
+            .suspend = false,
+        },
+    };
+    swl_rule_engine_add(engine, &rule);
+
+    mock_render_profile_calls = 0;
+    swl_rule_engine_apply(engine, (SwlClient *)&fake_client);
+    assert_int_equal(mock_render_profile_calls, 1);
+    assert_int_equal(mock_render_profile.set, SWL_PROFILE_SUSPEND);
+    assert_false(mock_render_profile.suspend);
+
+    /* Rules without overrides leave the profile alone */
+    swl_rule_engine_clear(engine);
+    SwlRule plain = { .floating = true };
+    swl_rule_engine_add(engine, &plain);
+
+    mock_render_profile_calls = 0;
+    swl_rule_engine_apply(engine, (SwlClient *)&fake_client);
+    assert_int_equal(mock_render_profile_calls, 0);
+
+    swl_rule_engine_destroy(engine);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -395,6 +463,8 @@ int main(void)
         cmocka_unit_test(test_rule_pattern_ownership),
         cmocka_unit_test(test_rule_remove_first),
         cmocka_unit_test(test_rule_remove_last),
+        cmocka_unit_test(test_rule_profile_stored),
+        cmocka_unit_test(test_rule_apply_profile),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
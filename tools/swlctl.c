@@ -1,3 +1,7 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -8,14 +12,20 @@
 #define SOCKET_PATH_ENV "SWL_SOCKET"
 #define DEFAULT_SOCKET_PATH "/tmp/swl.sock"
 #define BUFFER_SIZE 8192
+#define SESSION_HELLO "SWL 1\n"
 
 static void usage(const char *name)
 {
     fprintf(stderr, "Usage: %s <command> [args...]\n", name);
+    fprintf(stderr, "       %s --batch < commands\n", name);
     fprintf(stderr, "\nCommands:\n");
     fprintf(stderr, "  get-windows       List all windows as JSON\n");
     fprintf(stderr, "  get-monitors      List all monitors as JSON\n");
     fprintf(stderr, "  get-layouts       List available layouts as JSON\n");
+    fprintf(stderr, "  get-render-quality  Show effect-quality governor state\n");
+    fprintf(stderr, "  get-mode          Show the active keybinding mode\n");
+    fprintf(stderr, "  get-latency       Show input-to-present latency per monitor\n");
+    fprintf(stderr, "  get-startup-profile  Show startup phase timings and time to first frame\n");
     fprintf(stderr, "  focus <id>        Focus window by ID\n");
     fprintf(stderr, "  close <id>        Close window by ID\n");
     fprintf(stderr, "  layout <name>     Set layout\n");
@@ -24,6 +34,11 @@ static void usage(const char *name)
     fprintf(stderr, "  subscribe [event-types...]  Stream events as NDJSON\n");
     fprintf(stderr, "  dispatch <action> [arg]    Invoke a keybinding action\n");
     fprintf(stderr, "  quit              Quit compositor\n");
+    fprintf(stderr, "\nBatch mode:\n");
+    fprintf(stderr, "  --batch           Run commands from stdin, one per line, over one\n");
+    fprintf(stderr, "                    connection. A line may start with a numeric request\n");
+    fprintf(stderr, "                    id; replies are JSON lines {\"id\",\"ok\",\"data\"|\"error\"}.\n");
+    fprintf(stderr, "                    Blank lines and lines starting with # are skipped.\n");
     fprintf(stderr, "\nEnvironment:\n");
     fprintf(stderr, "  SWL_SOCKET        Socket path (default: %s)\n", DEFAULT_SOCKET_PATH);
 }
@@ -92,41 +107,193 @@ static int subscribe_events(const char *socket_path, const char *cmd)
     return 0;
 }
 
-static int send_command(const char *socket_path, const char *cmd, char *response, size_t response_size)
+static int write_all(int fd, const char *buf, size_t len)
 {
-    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (sock < 0) {
-        perror("socket");
-        return -1;
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        buf += n;
+        len -= (size_t)n;
     }
+    return 0;
+}
 
-    struct sockaddr_un addr = {
-        .sun_family = AF_UNIX,
-    };
-    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+/* One command per connection; the reply runs until the compositor closes it */
+static char *send_command(const char *socket_path, const char *cmd)
+{
+    int sock = connect_socket(socket_path);
+    if (sock < 0)
+        return NULL;
 
-    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-        perror("connect");
+    if (write_all(sock, cmd, strlen(cmd)) < 0) {
+        perror("write");
         close(sock);
-        return -1;
+        return NULL;
     }
 
-    if (write(sock, cmd, strlen(cmd)) < 0) {
-        perror("write");
-        close(sock);
-        return -1;
+    size_t len = 0, cap = BUFFER_SIZE;
+    char *response = malloc(cap);
+    while (response) {
+        if (cap - len < BUFFER_SIZE) {
+            char *grown = realloc(response, cap * 2);
+            if (!grown) {
+                free(response);
+                response = NULL;
+                break;
+            }
+            response = grown;
+            cap *= 2;
+        }
+
+        ssize_t n = read(sock, response + len, cap - len - 1);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0) {
+            perror("read");
+            free(response);
+            response = NULL;
+            break;
+        }
+        if (n == 0) {
+            response[len] = '\0';
+            break;
+        }
+        len += (size_t)n;
     }
 
-    ssize_t n = read(sock, response, response_size - 1);
-    if (n < 0) {
-        perror("read");
-        close(sock);
-        return -1;
+    close(sock);
+    return response;
+}
+
+/*
+ * Pipeline stdin lines over one session. The socket is non-blocking and
+ * requests are only written when it is writable, so a compositor that
+ * stops reading until we take its replies can't stall us. stdin is left
+ * alone until the requests read so far are out.
+ */
+static int run_batch(const char *socket_path)
+{
+    int sock = connect_socket(socket_path);
+    if (sock < 0) {
+        fprintf(stderr, "Failed to connect to swl\n");
+        return 1;
+    }
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) | O_NONBLOCK);
+
+    char in[BUFFER_SIZE], out[BUFFER_SIZE];
+    char send_buf[BUFFER_SIZE];
+    size_t in_len = 0;
+    size_t pending = 0;  /* Requests sent without a reply yet */
+    size_t greeted = 0;  /* Bytes of the echoed hello seen */
+    bool eof = false, failed = false;
+
+    /* Without the hello the compositor would take this for a one-shot command */
+    size_t send_len = strlen(SESSION_HELLO);
+    memcpy(send_buf, SESSION_HELLO, send_len);
+
+    while (!eof || pending > 0 || send_len > 0) {
+        struct pollfd fds[2] = {
+            {.fd = sock, .events = POLLIN | (send_len > 0 ? POLLOUT : 0)},
+            {.fd = eof || send_len > 0 ? -1 : STDIN_FILENO, .events = POLLIN},
+        };
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("poll");
+            failed = true;
+            break;
+        }
+
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t n = read(sock, out, sizeof(out));
+            if (n < 0 && (errno == EAGAIN || errno == EINTR))
+                continue;
+            if (n <= 0) {
+                if (pending > 0)
+                    fprintf(stderr, "Connection closed with %zu replies outstanding\n", pending);
+                failed = pending > 0;
+                break;
+            }
+
+            /* The echoed hello isn't a reply */
+            size_t start = 0;
+            while (greeted < strlen(SESSION_HELLO) && start < (size_t)n) {
+                if (out[start] != SESSION_HELLO[greeted])
+                    break;
+                greeted++;
+                start++;
+            }
+            if (greeted < strlen(SESSION_HELLO) && start < (size_t)n) {
+                fprintf(stderr, "swl does not support sessions\n");
+                failed = true;
+                break;
+            }
+
+            for (ssize_t i = (ssize_t)start; i < n; i++) {
+                if (out[i] == '\n' && pending > 0)
+                    pending--;
+            }
+            fwrite(out + start, 1, (size_t)n - start, stdout);
+            fflush(stdout);
+        }
+
+        if (fds[0].revents & POLLOUT) {
+            ssize_t n = write(sock, send_buf, send_len);
+            if (n < 0 && errno != EAGAIN && errno != EINTR) {
+                perror("write");
+                failed = true;
+                break;
+            }
+            if (n > 0) {
+                memmove(send_buf, send_buf + n, send_len - (size_t)n);
+                send_len -= (size_t)n;
+            }
+        }
+
+        if (fds[1].revents & (POLLIN | POLLHUP)) {
+            ssize_t n = read(STDIN_FILENO, in + in_len, sizeof(in) - in_len - 1);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0) {
+                eof = true;
+                if (in_len > 0)
+                    in[in_len++] = '\n';  /* Last line without a newline */
+            } else {
+                in_len += (size_t)n;
+            }
+
+            /* send_buf is empty here and at least as big as in */
+            size_t pos = 0;
+            char *nl;
+            while ((nl = memchr(in + pos, '\n', in_len - pos))) {
+                char *line = in + pos;
+                size_t len = (size_t)(nl - line) + 1;
+                pos += len;
+
+                size_t skip = strspn(line, " \t\r");
+                if (line[skip] == '\n' || line[skip] == '#')
+                    continue;
+                memcpy(send_buf + send_len, line, len);
+                send_len += len;
+                pending++;
+            }
+
+            memmove(in, in + pos, in_len - pos);
+            in_len -= pos;
+            if (in_len == sizeof(in) - 1) {
+                fprintf(stderr, "Command too long\n");
+                failed = true;
+                break;
+            }
+        }
     }
-    response[n] = '\0';
 
     close(sock);
-    return 0;
+    return failed ? 1 : 0;
 }
 
 int main(int argc, char *argv[])
@@ -145,6 +312,9 @@ int main(int argc, char *argv[])
     if (!socket_path)
         socket_path = DEFAULT_SOCKET_PATH;
 
+    if (strcmp(argv[1], "--batch") == 0)
+        return run_batch(socket_path);
+
     char cmd[BUFFER_SIZE] = {0};
     int offset = 0;
 
@@ -162,12 +332,13 @@ int main(int argc, char *argv[])
     if (strcmp(argv[1], "subscribe") == 0)
         return subscribe_events(socket_path, cmd);
 
-    char response[BUFFER_SIZE];
-    if (send_command(socket_path, cmd, response, sizeof(response)) < 0) {
+    char *response = send_command(socket_path, cmd);
+    if (!response) {
         fprintf(stderr, "Failed to communicate with swl\n");
         return 1;
     }
 
     printf("%s\n", response);
+    free(response);
     return 0;
 }